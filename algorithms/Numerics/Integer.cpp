@@ -20,6 +20,43 @@ namespace Numerics {}
 
 namespace Numerics {
 
+bool
+BigInteger::readSmallValue(const char* text, size_t length, const FormatParameters& params,
+      uint64_t& result) {
+   AssumeCondition(params.isDecimal() || params.isHexaDecimal())
+   result = 0;
+   if (length == 0)
+      return false;
+   const char* end = text + length;
+   if (params.isHexaDecimal()) {
+      for (; text != end; ++text) {
+         unsigned digit;
+         if ((*text >= '0') && (*text <= '9'))
+            digit = *text - '0';
+         else if ((*text >= 'a') && (*text <= 'f'))
+            digit = *text - 'a' + 10;
+         else if ((*text >= 'A') && (*text <= 'F'))
+            digit = *text - 'A' + 10;
+         else
+            return false;
+         if (result >> 60)
+            return false;
+         result = (result << 4) | digit;
+      };
+   }
+   else {
+      for (; text != end; ++text) {
+         if ((*text < '0') || (*text > '9'))
+            return false;
+         unsigned digit = *text - '0';
+         if (result > (~(uint64_t) 0 - digit)/10)
+            return false;
+         result = result*10 + digit;
+      };
+   };
+   return true;
+}
+
 void
 BigInteger::_read(ISBase& in, const IOObject::FormatParameters& aparams) {
    const FormatParameters& params = (const FormatParameters&) aparams;
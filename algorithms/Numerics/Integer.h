@@ -19,6 +19,7 @@
 #include "Pointer/Pointer.hpp"
 
 #include "ForwardNumerics/BaseInteger.h"
+#include <cstdint>
 
 namespace Numerics {
 
@@ -227,6 +228,10 @@ class BigInteger : public STG::IOObject, public DInteger::BigIntegerImplementati
    void read(std::istream& in) { ISStream instream(in); _read(instream, FormatParameters()); }
    void write(std::ostream& out, const STG::IOObject::FormatParameters& params) const { OSStream outstream(out); _write(outstream, params); }
    void write(std::ostream& out) const { OSStream outstream(out); _write(outstream, FormatParameters()); }
+   // reads a decimal or hexadecimal literal without building any cell array;
+   // returns false if the text has other characters or if it exceeds 64 bits
+   static bool readSmallValue(const char* text, size_t length, const FormatParameters& params,
+         uint64_t& result);
 
    void add(const thisType& source)
       {  Implementation::Carry carry = inheritedImplementation::add(source);
@@ -0,0 +1,521 @@
+#include "Collection/Collection.hpp"
+#include "Collection/Collection.template"
+#include "Pointer/SharedPointer.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Micro-benchmarks of the utils collections that sit under MemoryState and
+ * ContractGraph (TSortedAVL, TSortedArray, TList, TSharedPointer) compared to
+ * their std equivalents. The sizes mimic the checker: 16 elements for the
+ * registers, 256 and 4096 elements for the memory and the contract graphs.
+ */
+
+namespace {
+
+class AVLInteger : public COL::GenericAVL::Node {
+  private:
+   int uValue;
+
+  public:
+   AVLInteger(int value) : uValue(value) {}
+   AVLInteger(const AVLInteger& source) = default;
+   DefineCopy(AVLInteger)
+
+   const int& getValue() const { return uValue; }
+   class Key {
+     public:
+      Key(const COL::VirtualCollection&) {}
+      typedef const int& KeyType;
+      typedef int ControlKeyType;
+      static KeyType key(const AVLInteger& element) { return element.getValue(); }
+      static ComparisonResult compare(KeyType fst, KeyType snd) { return fcompare(fst, snd); }
+   };
+};
+
+class ArrayInteger : public EnhancedObject {
+  private:
+   int uValue;
+
+  public:
+   ArrayInteger(int value) : uValue(value) {}
+   ArrayInteger(const ArrayInteger& source) = default;
+   DefineCopy(ArrayInteger)
+
+   const int& getValue() const { return uValue; }
+   class Key {
+     public:
+      Key(const COL::VirtualCollection&) {}
+      typedef const int& KeyType;
+      typedef int ControlKeyType;
+      static KeyType key(const ArrayInteger& element) { return element.getValue(); }
+      static ComparisonResult compare(KeyType fst, KeyType snd) { return fcompare(fst, snd); }
+   };
+};
+
+class ListInteger : public COL::List::Node {
+  private:
+   int uValue;
+
+  public:
+   ListInteger(int value) : uValue(value) {}
+   ListInteger(const ListInteger& source) = default;
+   DefineCopy(ListInteger)
+
+   const int& getValue() const { return uValue; }
+};
+
+class SharedInteger : public PNT::SharedElement {
+  private:
+   int uValue;
+
+  public:
+   SharedInteger(int value) : uValue(value) {}
+   SharedInteger(const SharedInteger& source) = default;
+   DefineCopy(SharedInteger)
+
+   const int& getValue() const { return uValue; }
+};
+
+typedef COL::TCopyCollection<COL::TSortedAVL<AVLInteger, AVLInteger::Key> > AVLCollection;
+typedef COL::TCopyCollection<COL::TSortedArray<ArrayInteger, ArrayInteger::Key> > ArrayCollection;
+typedef COL::TCopyCollection<COL::TList<ListInteger> > ListCollection;
+
+// keys in a pseudo-random order, the same for every container
+std::vector<int>
+shuffledKeys(int size, int step, int offset) {
+   std::vector<int> result;
+   result.reserve(size);
+   for (int index = 0; index < size; ++index)
+      result.push_back(index*step + offset);
+   uint64_t state = 0x9e3779b97f4a7c15ULL ^ (uint64_t) size;
+   for (int index = size-1; index > 0; --index) {
+      state ^= state >> 12; state ^= state << 25; state ^= state >> 27;
+      int other = (int) ((state * 0x2545f4914f6cdd1dULL) % (uint64_t) (index+1));
+      std::swap(result[index], result[other]);
+   }
+   return result;
+}
+
+volatile int64_t sink = 0;
+
+}
+
+class ProcessArgument {
+  private:
+   const char* szOutput = nullptr;
+   int uRepeat = 5;
+   bool fHasEchoedMessage = false;
+
+  public:
+   ProcessArgument() = default;
+   ProcessArgument(int argc, char** argv)
+      {  int arg = argc-2;
+         while (arg >= 0)
+            fHasEchoedMessage = !process(argv + (argc - arg - 1), arg) && fHasEchoedMessage;
+      }
+
+   bool process(char** argument, int& currentArgument);
+   void printUsage(std::ostream& out) const
+      {  if (fHasEchoedMessage)
+            return;
+         out << "usage of bench_collections:\n"
+             << "\tbench_collections [options]\n"
+             << "\n"
+             << "where option can be:\n"
+             << "\t-repeat n \t\tnumber of measured runs, the best one is kept (default 5)\n"
+             << "\t-o report.json \tto write the report elsewhere than on stdout\n";
+         out.flush();
+      }
+
+   bool isValid() const { return !fHasEchoedMessage; }
+   bool hasOutput() const { return szOutput; }
+   const char* getOutput() const { return szOutput; }
+   int getRepeat() const { return uRepeat; }
+};
+
+bool
+ProcessArgument::process(char** argument, int& currentArgument) {
+   if (argument[0][0] == '-' && currentArgument > 0) {
+      const char* option = &argument[0][1];
+      if (strcmp(option, "o") == 0 && !szOutput) {
+         szOutput = argument[1];
+         currentArgument -= 2;
+         return true;
+      }
+      if (strcmp(option, "repeat") == 0) {
+         char* end = nullptr;
+         long value = std::strtol(argument[1], &end, 10);
+         if (end && *end == '\0' && value > 0 && value <= 1000) {
+            uRepeat = (int) value;
+            currentArgument -= 2;
+            return true;
+         }
+      }
+   }
+   printUsage(std::cout);
+   --currentArgument;
+   return false;
+}
+
+/* Time of the best run of an operation, in nanoseconds per element. */
+class Measures {
+  private:
+   struct Measure {
+      std::string container;
+      std::string operation;
+      int size;
+      double nanosecondsPerElement;
+   };
+   std::vector<Measure> vmMeasures;
+   int uRepeat;
+
+  public:
+   Measures(int repeat) : uRepeat(repeat) {}
+
+   template <class Prepare, class Operation>
+   void measure(const char* container, const char* operation, int size,
+         Prepare prepare, Operation run)
+      {  // repeat the operation on small sizes to stay above the clock resolution
+         int iterations = std::max(1, 65536/size);
+         double best = 0;
+         for (int repeat = 0; repeat < uRepeat; ++repeat) {
+            auto state = prepare();
+            auto start = std::chrono::steady_clock::now();
+            for (int iteration = 0; iteration < iterations; ++iteration)
+               run(state);
+            double duration = std::chrono::duration<double, std::nano>(
+                  std::chrono::steady_clock::now() - start).count();
+            if (repeat == 0 || duration < best)
+               best = duration;
+         }
+         vmMeasures.push_back(Measure{ container, operation, size, best/((double) iterations*size) });
+      }
+   void writeJSon(std::ostream& out) const;
+};
+
+void
+Measures::writeJSon(std::ostream& out) const {
+   out << "{\n  \"repeat\": " << uRepeat << ",\n  \"unit\": \"ns/element\",\n  \"results\": [";
+   bool isFirst = true;
+   for (const auto& measure : vmMeasures) {
+      out << (isFirst ? "\n" : ",\n")
+          << "    { \"container\": \"" << measure.container << "\", \"operation\": \""
+          << measure.operation << "\", \"size\": " << measure.size
+          << ", \"time\": " << measure.nanosecondsPerElement << " }";
+      isFirst = false;
+   }
+   out << "\n  ]\n}\n";
+}
+
+namespace {
+
+void
+fillAVL(AVLCollection& collection, const std::vector<int>& keys) {
+   for (int key : keys) {
+      AVLCollection::Cursor cursor(collection);
+      auto locationResult = collection.locateKey(key, cursor);
+      if (!locationResult)
+         collection.add(new AVLInteger(key), locationResult.queryInsertionParameters().setFreeOnError(), &cursor);
+   }
+}
+
+void
+fillArray(ArrayCollection& collection, const std::vector<int>& keys) {
+   for (int key : keys) {
+      ArrayCollection::Cursor cursor(collection);
+      auto locationResult = collection.locateKey(key, cursor);
+      if (!locationResult)
+         collection.add(new ArrayInteger(key), locationResult.queryInsertionParameters().setFreeOnError(), &cursor);
+   }
+}
+
+void
+benchSorted(Measures& measures, int size) {
+   std::vector<int> keys = shuffledKeys(size, 2, 0);
+   std::vector<int> otherKeys = shuffledKeys(size, 3, 0);
+
+   // insert: the pattern of MemoryState::set_register_value
+   measures.measure("TSortedAVL", "insert", size,
+      [] { return std::make_shared<std::vector<AVLCollection> >(); },
+      [&keys](std::shared_ptr<std::vector<AVLCollection> >& state)
+         {  state->emplace_back();
+            fillAVL(state->back(), keys);
+         });
+   measures.measure("TSortedArray", "insert", size,
+      [] { return std::make_shared<std::vector<ArrayCollection> >(); },
+      [&keys](std::shared_ptr<std::vector<ArrayCollection> >& state)
+         {  state->emplace_back();
+            fillArray(state->back(), keys);
+         });
+   measures.measure("std::map", "insert", size,
+      [] { return std::make_shared<std::vector<std::map<int, int> > >(); },
+      [&keys](std::shared_ptr<std::vector<std::map<int, int> > >& state)
+         {  state->emplace_back();
+            for (int key : keys)
+               state->back().emplace(key, key);
+         });
+   measures.measure("std::vector(sorted)", "insert", size,
+      [] { return std::make_shared<std::vector<std::vector<int> > >(); },
+      [&keys](std::shared_ptr<std::vector<std::vector<int> > >& state)
+         {  state->emplace_back();
+            auto& vector = state->back();
+            for (int key : keys) {
+               auto position = std::lower_bound(vector.begin(), vector.end(), key);
+               if (position == vector.end() || *position != key)
+                  vector.insert(position, key);
+            }
+         });
+
+   // locate: one registered cursor for all the searches
+   auto avl = std::make_shared<AVLCollection>();
+   fillAVL(*avl, keys);
+   auto array = std::make_shared<ArrayCollection>();
+   fillArray(*array, keys);
+   auto map = std::make_shared<std::map<int, int> >();
+   for (int key : keys)
+      map->emplace(key, key);
+   auto vector = std::make_shared<std::vector<int> >(keys);
+   std::sort(vector->begin(), vector->end());
+
+   measures.measure("TSortedAVL", "locate", size, [&avl] { return avl; },
+      [&otherKeys](std::shared_ptr<AVLCollection>& state)
+         {  AVLCollection::Cursor cursor(*state);
+            for (int key : otherKeys)
+               sink += (bool) state->locateKey(key, cursor, COL::VirtualCollection::RPExact);
+         });
+   measures.measure("TSortedArray", "locate", size, [&array] { return array; },
+      [&otherKeys](std::shared_ptr<ArrayCollection>& state)
+         {  ArrayCollection::Cursor cursor(*state);
+            for (int key : otherKeys)
+               sink += (bool) state->locateKey(key, cursor, COL::VirtualCollection::RPExact);
+         });
+   measures.measure("std::map", "locate", size, [&map] { return map; },
+      [&otherKeys](std::shared_ptr<std::map<int, int> >& state)
+         {  for (int key : otherKeys)
+               sink += state->find(key) != state->end();
+         });
+   measures.measure("std::vector(sorted)", "locate", size, [&vector] { return vector; },
+      [&otherKeys](std::shared_ptr<std::vector<int> >& state)
+         {  for (int key : otherKeys)
+               sink += std::binary_search(state->begin(), state->end(), key);
+         });
+
+   // cursor registration: a new cursor for each search, as the C callbacks do
+   measures.measure("TSortedAVL", "locate+cursor", size, [&avl] { return avl; },
+      [&otherKeys](std::shared_ptr<AVLCollection>& state)
+         {  for (int key : otherKeys) {
+               AVLCollection::Cursor cursor(*state);
+               sink += (bool) state->locateKey(key, cursor, COL::VirtualCollection::RPExact);
+            }
+         });
+   measures.measure("TSortedArray", "locate+cursor", size, [&array] { return array; },
+      [&otherKeys](std::shared_ptr<ArrayCollection>& state)
+         {  for (int key : otherKeys) {
+               ArrayCollection::Cursor cursor(*state);
+               sink += (bool) state->locateKey(key, cursor, COL::VirtualCollection::RPExact);
+            }
+         });
+
+   // iterate
+   measures.measure("TSortedAVL", "iterate", size, [&avl] { return avl; },
+      [](std::shared_ptr<AVLCollection>& state)
+         {  AVLCollection::Cursor cursor(*state);
+            while (cursor.setToNext())
+               sink += cursor.elementAt().getValue();
+         });
+   measures.measure("TSortedArray", "iterate", size, [&array] { return array; },
+      [](std::shared_ptr<ArrayCollection>& state)
+         {  ArrayCollection::Cursor cursor(*state);
+            while (cursor.setToNext())
+               sink += cursor.elementAt().getValue();
+         });
+   measures.measure("std::map", "iterate", size, [&map] { return map; },
+      [](std::shared_ptr<std::map<int, int> >& state)
+         {  for (const auto& element : *state)
+               sink += element.second;
+         });
+   measures.measure("std::vector(sorted)", "iterate", size, [&vector] { return vector; },
+      [](std::shared_ptr<std::vector<int> >& state)
+         {  for (int element : *state)
+               sink += element;
+         });
+
+   // copy: the copy of a MemoryState at each branch
+   measures.measure("TSortedAVL", "copy", size, [&avl] { return avl; },
+      [](std::shared_ptr<AVLCollection>& state)
+         {  AVLCollection copy(*state);
+            sink += copy.count();
+         });
+   measures.measure("TSortedArray", "copy", size, [&array] { return array; },
+      [](std::shared_ptr<ArrayCollection>& state)
+         {  ArrayCollection copy(*state);
+            sink += copy.count();
+         });
+   measures.measure("std::map", "copy", size, [&map] { return map; },
+      [](std::shared_ptr<std::map<int, int> >& state)
+         {  std::map<int, int> copy(*state);
+            sink += copy.size();
+         });
+   measures.measure("std::vector(sorted)", "copy", size, [&vector] { return vector; },
+      [](std::shared_ptr<std::vector<int> >& state)
+         {  std::vector<int> copy(*state);
+            sink += copy.size();
+         });
+
+   // merge: keep the common keys, the pattern of MemoryState::mergeWith
+   auto otherAVL = std::make_shared<AVLCollection>();
+   fillAVL(*otherAVL, otherKeys);
+   auto otherMap = std::make_shared<std::map<int, int> >();
+   for (int key : otherKeys)
+      otherMap->emplace(key, key);
+   measures.measure("TSortedAVL", "merge", size, [&avl] { return avl; },
+      [&otherAVL](std::shared_ptr<AVLCollection>& state)
+         {  AVLCollection copy(*state);
+            AVLCollection::Cursor thisCursor(copy), sourceCursor(*otherAVL);
+            sourceCursor.setToFirst();
+            while (thisCursor.setToNext()) {
+               while (sourceCursor.isValid() && sourceCursor.elementAt().getValue() < thisCursor.elementAt().getValue())
+                  sourceCursor.setToNext();
+               if (!sourceCursor.isValid() || sourceCursor.elementAt().getValue() != thisCursor.elementAt().getValue()) {
+                  auto copyCursor = thisCursor;
+                  thisCursor.setToPrevious();
+                  copy.freeAt(copyCursor);
+               }
+            }
+            sink += copy.count();
+         });
+   measures.measure("std::map", "merge", size, [&map] { return map; },
+      [&otherMap](std::shared_ptr<std::map<int, int> >& state)
+         {  std::map<int, int> copy(*state);
+            auto sourceIter = otherMap->begin();
+            for (auto iter = copy.begin(); iter != copy.end(); ) {
+               while (sourceIter != otherMap->end() && sourceIter->first < iter->first)
+                  ++sourceIter;
+               if (sourceIter == otherMap->end() || sourceIter->first != iter->first)
+                  iter = copy.erase(iter);
+               else
+                  ++iter;
+            }
+            sink += copy.size();
+         });
+}
+
+void
+benchList(Measures& measures, int size) {
+   measures.measure("TList", "insert", size,
+      [] { return std::make_shared<std::vector<ListCollection> >(); },
+      [size](std::shared_ptr<std::vector<ListCollection> >& state)
+         {  state->emplace_back();
+            for (int index = 0; index < size; ++index)
+               state->back().insertNewAtEnd(new ListInteger(index));
+         });
+   measures.measure("std::list", "insert", size,
+      [] { return std::make_shared<std::vector<std::list<int> > >(); },
+      [size](std::shared_ptr<std::vector<std::list<int> > >& state)
+         {  state->emplace_back();
+            for (int index = 0; index < size; ++index)
+               state->back().push_back(index);
+         });
+
+   auto list = std::make_shared<ListCollection>();
+   auto stdList = std::make_shared<std::list<int> >();
+   for (int index = 0; index < size; ++index) {
+      list->insertNewAtEnd(new ListInteger(index));
+      stdList->push_back(index);
+   }
+   measures.measure("TList", "iterate", size, [&list] { return list; },
+      [](std::shared_ptr<ListCollection>& state)
+         {  ListCollection::Cursor cursor(*state);
+            while (cursor.setToNext())
+               sink += cursor.elementAt().getValue();
+         });
+   measures.measure("std::list", "iterate", size, [&stdList] { return stdList; },
+      [](std::shared_ptr<std::list<int> >& state)
+         {  for (int element : *state)
+               sink += element;
+         });
+   measures.measure("TList", "copy", size, [&list] { return list; },
+      [](std::shared_ptr<ListCollection>& state)
+         {  ListCollection copy(*state);
+            sink += copy.count();
+         });
+   measures.measure("std::list", "copy", size, [&stdList] { return stdList; },
+      [](std::shared_ptr<std::list<int> >& state)
+         {  std::list<int> copy(*state);
+            sink += copy.size();
+         });
+}
+
+void
+benchSharedPointer(Measures& measures, int size) {
+   measures.measure("TSharedPointer", "create", size,
+      [] { return 0; },
+      [size](int&)
+         {  for (int index = 0; index < size; ++index) {
+               PNT::TSharedPointer<SharedInteger> pointer(new SharedInteger(index), PNT::Pointer::Init());
+               sink += pointer->getValue();
+            }
+         });
+   measures.measure("std::shared_ptr", "create", size,
+      [] { return 0; },
+      [size](int&)
+         {  for (int index = 0; index < size; ++index) {
+               std::shared_ptr<int> pointer = std::make_shared<int>(index);
+               sink += *pointer;
+            }
+         });
+   // copy: the sharing of the zones and of the contracts
+   measures.measure("TSharedPointer", "copy", size,
+      [] { return PNT::TSharedPointer<SharedInteger>(new SharedInteger(1), PNT::Pointer::Init()); },
+      [size](PNT::TSharedPointer<SharedInteger>& state)
+         {  for (int index = 0; index < size; ++index) {
+               PNT::TSharedPointer<SharedInteger> copy(state);
+               sink += copy->getValue();
+            }
+         });
+   measures.measure("std::shared_ptr", "copy", size,
+      [] { return std::make_shared<int>(1); },
+      [size](std::shared_ptr<int>& state)
+         {  for (int index = 0; index < size; ++index) {
+               std::shared_ptr<int> copy(state);
+               sink += *copy;
+            }
+         });
+}
+
+}
+
+int main(int argc, char** argv) {
+   ProcessArgument processArgument(argc, argv);
+   if (!processArgument.isValid())
+      return 1;
+
+   Measures measures(processArgument.getRepeat());
+   for (int size : { 16, 256, 4096 }) {
+      benchSorted(measures, size);
+      benchList(measures, size);
+      benchSharedPointer(measures, size);
+   }
+
+   if (processArgument.hasOutput()) {
+      std::ofstream out(processArgument.getOutput());
+      if (!out) {
+         std::cerr << "unable to write the report in " << processArgument.getOutput() << std::endl;
+         return 1;
+      }
+      measures.writeJSon(out);
+   }
+   else
+      measures.writeJSon(std::cout);
+   return 0;
+}
+
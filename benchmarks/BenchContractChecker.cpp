@@ -0,0 +1,566 @@
+#include "contract_checker.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#ifndef DEFAULT_ARCHITECTURE_LIBRARY
+#define DEFAULT_ARCHITECTURE_LIBRARY "armsec_decoder.so"
+#endif
+#ifndef DEFAULT_DOMAIN_LIBRARY
+#define DEFAULT_DOMAIN_LIBRARY "libScalarInterface.so"
+#endif
+
+/* Allocation counting: every operator new of the process (including the ones
+ * of the contract_checker library) goes through these replacements.
+ */
+namespace {
+
+std::atomic<uint64_t> allocationsCount(0);
+std::atomic<uint64_t> allocatedBytes(0);
+
+void* countedAllocate(size_t size) {
+   allocationsCount.fetch_add(1, std::memory_order_relaxed);
+   allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+   void* result = std::malloc(size ? size : 1);
+   if (!result)
+      throw std::bad_alloc();
+   return result;
+}
+
+}
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+class ProcessArgument {
+  private:
+   const char* szInputFile = nullptr;
+   const char* szMemoryFile = nullptr;
+   const char* szArch = nullptr;
+   const char* szDomain = nullptr;
+   const char* szOutput = nullptr;
+   const char* szTrace = nullptr;
+   const char* szVerificationCache = nullptr;
+   int uWarmup = 1;
+   int uRepeat = 5;
+   int uWideningDelay = -1;
+   int uBranchThreads = -1;
+   bool fUseBlockPartition = false;
+   bool fUseEarlyExit = false;
+   bool fHasEchoedMessage = false;
+
+   bool readCount(char** argument, int& currentArgument, int& result);
+
+  public:
+   ProcessArgument() = default;
+   ProcessArgument(int argc, char** argv)
+      {  int arg = argc-2;
+         while (arg >= 0)
+            fHasEchoedMessage = !process(argv + (argc - arg - 1), arg) && fHasEchoedMessage;
+      }
+
+   bool process(char** argument, int& currentArgument);
+   void printUsage(std::ostream& out) const
+      {  if (fHasEchoedMessage)
+            return;
+         out << "usage of bench_contract_checker:\n"
+             << "\tbench_contract_checker [options] binary_file contracts.json\n"
+             << "\n"
+             << "where option can be:\n"
+             << "\t-arch armsec.so \tto provide the instruction set\n"
+             << "\t-dom domsec.so \tto provide the domain library\n"
+             << "\t-warmup n \t\tnumber of unmeasured runs (default 1)\n"
+             << "\t-repeat n \t\tnumber of measured runs (default 5)\n"
+             << "\t-o report.json \tto write the report elsewhere than on stdout\n"
+             << "\t-trace trace.json \tto write a Chrome trace of the measured runs\n"
+             << "\t-block-partition \tto retrieve the targets from a partition in linear blocks\n"
+             << "\t-fixpoint n \t\tto check the blocks with a fixpoint, widening after n joins\n"
+             << "\t-parallel-branches n \tto explore the branches of the blocks on n threads\n"
+             << "\t-early-exit \t\tto stop the check of a block on the first certain violation\n"
+             << "\t-verification-cache cache.bin \tto reuse the verdicts of the unchanged blocks\n";
+         out.flush();
+      }
+
+   bool isValid() const { return szInputFile && szMemoryFile; }
+   bool hasEchoedMessage() const { return fHasEchoedMessage; }
+
+   const char* getInputFile() const { return szInputFile; }
+   const char* getMemoryFile() const { return szMemoryFile; }
+   const char* getArch() const { return szArch ? szArch : DEFAULT_ARCHITECTURE_LIBRARY; }
+   const char* getDomain() const { return szDomain ? szDomain : DEFAULT_DOMAIN_LIBRARY; }
+   bool hasOutput() const { return szOutput; }
+   const char* getOutput() const { return szOutput; }
+   const char* getTrace() const { return szTrace; }
+   const char* getVerificationCache() const { return szVerificationCache; }
+   int getWarmup() const { return uWarmup; }
+   int getRepeat() const { return uRepeat; }
+   bool useBlockPartition() const { return fUseBlockPartition; }
+   bool useFixpoint() const { return uWideningDelay >= 0; }
+   int getWideningDelay() const { return uWideningDelay; }
+   bool useParallelBranches() const { return uBranchThreads >= 0; }
+   int getBranchThreads() const { return uBranchThreads; }
+   bool useEarlyExit() const { return fUseEarlyExit; }
+};
+
+bool
+ProcessArgument::readCount(char** argument, int& currentArgument, int& result) {
+   if (currentArgument == 0) {
+      printUsage(std::cout);
+      return false;
+   }
+   char* end = nullptr;
+   long value = std::strtol(argument[1], &end, 10);
+   if (!end || *end != '\0' || value < 0 || value > 1000000) {
+      printUsage(std::cout);
+      return false;
+   }
+   currentArgument -= 2;
+   result = (int) value;
+   return true;
+}
+
+bool
+ProcessArgument::process(char** argument, int& currentArgument) {
+   if (argument[0][0] == '-') {
+      const char* option = &argument[0][1];
+      const char** target = nullptr;
+      if (strcmp(option, "arch") == 0)
+         target = &szArch;
+      else if (strcmp(option, "dom") == 0)
+         target = &szDomain;
+      else if (strcmp(option, "o") == 0)
+         target = &szOutput;
+      else if (strcmp(option, "trace") == 0)
+         target = &szTrace;
+      else if (strcmp(option, "verification-cache") == 0)
+         target = &szVerificationCache;
+      else if (strcmp(option, "warmup") == 0)
+         return readCount(argument, currentArgument, uWarmup);
+      else if (strcmp(option, "repeat") == 0)
+         return readCount(argument, currentArgument, uRepeat);
+      else if (strcmp(option, "fixpoint") == 0)
+         return readCount(argument, currentArgument, uWideningDelay);
+      else if (strcmp(option, "parallel-branches") == 0)
+         return readCount(argument, currentArgument, uBranchThreads);
+      else if (strcmp(option, "block-partition") == 0) {
+         fUseBlockPartition = true;
+         --currentArgument;
+         return true;
+      }
+      else if (strcmp(option, "early-exit") == 0) {
+         fUseEarlyExit = true;
+         --currentArgument;
+         return true;
+      }
+      else {
+         printUsage(std::cout);
+         --currentArgument;
+         return false;
+      }
+      if (currentArgument == 0 || *target) {
+         printUsage(std::cout);
+         return false;
+      };
+      currentArgument -= 2;
+      *target = argument[1];
+   }
+   else {
+      if (szInputFile) {
+         if (szMemoryFile) {
+            printUsage(std::cout);
+            --currentArgument;
+            return false;
+         }
+         szMemoryFile = argument[0];
+         --currentArgument;
+      }
+      else {
+         szInputFile = argument[0];
+         --currentArgument;
+      }
+   }
+   return true;
+}
+
+/* Measure of one phase over all the measured runs. */
+class PhaseMeasure {
+  private:
+   std::vector<double> vdDurations; // in seconds
+   std::vector<uint64_t> vuAllocations;
+   std::vector<uint64_t> vuAllocatedBytes;
+
+   std::chrono::steady_clock::time_point tpStart;
+   uint64_t uStartAllocations = 0;
+   uint64_t uStartBytes = 0;
+
+  public:
+   void start()
+      {  uStartAllocations = allocationsCount.load(std::memory_order_relaxed);
+         uStartBytes = allocatedBytes.load(std::memory_order_relaxed);
+         tpStart = std::chrono::steady_clock::now();
+      }
+   void stop(bool isMeasured)
+      {  auto end = std::chrono::steady_clock::now();
+         if (!isMeasured)
+            return;
+         vdDurations.push_back(std::chrono::duration<double>(end - tpStart).count());
+         vuAllocations.push_back(allocationsCount.load(std::memory_order_relaxed) - uStartAllocations);
+         vuAllocatedBytes.push_back(allocatedBytes.load(std::memory_order_relaxed) - uStartBytes);
+      }
+
+   double getTotalDuration() const
+      {  double result = 0;
+         for (double duration : vdDurations)
+            result += duration;
+         return result;
+      }
+   void writeJSon(std::ostream& out, const char* name) const;
+};
+
+void
+PhaseMeasure::writeJSon(std::ostream& out, const char* name) const {
+   std::vector<double> durations(vdDurations);
+   std::sort(durations.begin(), durations.end());
+   double mean = durations.empty() ? 0 : getTotalDuration()/durations.size();
+   double median = durations.empty() ? 0 : ((durations.size() % 2)
+         ? durations[durations.size()/2]
+         : (durations[durations.size()/2-1] + durations[durations.size()/2])/2);
+   uint64_t allocations = 0, bytes = 0;
+   for (uint64_t count : vuAllocations)
+      allocations += count;
+   for (uint64_t count : vuAllocatedBytes)
+      bytes += count;
+   if (!vuAllocations.empty()) {
+      allocations /= vuAllocations.size();
+      bytes /= vuAllocatedBytes.size();
+   }
+   out << "    \"" << name << "\": {\n"
+       << "      \"wall_ms\": { \"min\": " << (durations.empty() ? 0 : durations.front()*1000.0)
+       << ", \"median\": " << median*1000.0
+       << ", \"mean\": " << mean*1000.0
+       << ", \"max\": " << (durations.empty() ? 0 : durations.back()*1000.0) << " },\n"
+       << "      \"allocations\": " << allocations << ",\n"
+       << "      \"allocated_bytes\": " << bytes << "\n"
+       << "    }";
+}
+
+namespace {
+
+uint64_t*
+reallocAddresses(uint64_t* old_addresses, int old_size, int* new_size, void* address_container) {
+   auto* container = reinterpret_cast<std::vector<uint64_t>*>(address_container);
+   assert(container->size() == (size_t) old_size && old_addresses == &(*container)[0]);
+   if (old_size < 6)
+      *new_size = 6;
+   else
+      *new_size = old_size*3/2;
+   container->insert(container->end(), (*new_size-old_size), 0);
+   return &(*container)[0];
+}
+
+void
+printWarnings(struct _WarningsContent* warnings) {
+   struct _WarningCursorContent* cursor = warning_create_cursor(warnings);
+   while (warning_set_to_next(cursor)) {
+      struct _Warning error{};
+      warning_retrieve_message(cursor, &error);
+      std::cerr << error.filepos << ':' << error.linepos << " error at column "
+         << error.columnpos << ", " << error.message << '\n';
+   };
+   warning_free_cursor(cursor);
+   std::cerr.flush();
+}
+
+}
+
+/* Result of the target discovery for a contract: the blocks to check start
+ * at the contract address and end at each of the targets.
+ */
+struct BlockSource {
+   struct _ContractCursorContent* cursor = nullptr;
+   struct _PDecisionVector* decisions = nullptr;
+   uint64_t address = 0;
+   std::vector<uint64_t> targets;
+};
+
+struct RunResult {
+   uint64_t blocks = 0;
+   uint64_t failedBlocks = 0;
+   uint64_t instructions = 0;
+   uint64_t partitionBlocks = 0;
+};
+
+class Benchmark {
+  private:
+   const ProcessArgument& paArguments;
+   PhaseMeasure pmLoad, pmTargets, pmCheck;
+   RunResult rrResult;
+   struct _CheckerStats csStats{};
+   int uRuns = 0;
+
+   void addStats(const struct _CheckerStats& stats);
+   void writeStatsJSon(std::ostream& out) const;
+
+  public:
+   Benchmark(const ProcessArgument& arguments) : paArguments(arguments) {}
+
+   bool run(bool isMeasured);
+   void writeJSon(std::ostream& out) const;
+};
+
+bool
+Benchmark::run(bool isMeasured) {
+   pmLoad.start();
+   struct _PProcessor* processor = create_processor(paArguments.getArch(), paArguments.getDomain());
+   if (!processor)
+      return false;
+   processor_reset_stats(processor);
+   struct _WarningsContent* warnings = create_warnings();
+   struct _ContractGraphContent* contracts = load_contracts(paArguments.getMemoryFile(), processor, warnings);
+   if (!contracts) {
+      std::cerr << "unable to load contracts from file " << paArguments.getMemoryFile() << std::endl;
+      printWarnings(warnings);
+      free_warnings(warnings);
+      free_processor(processor);
+      return false;
+   }
+   free_warnings(warnings);
+   if (!processor_load_code(processor, paArguments.getInputFile())) {
+      std::cerr << "unable to load code from file " << paArguments.getInputFile() << std::endl;
+      free_contracts(contracts);
+      free_processor(processor);
+      return false;
+   }
+   if (contracts_has_alloc_shift(contracts))
+      processor_set_loader_alloc_shift(processor, contracts_get_alloc_shift(contracts));
+   if (paArguments.useBlockPartition())
+      processor_use_block_partition(processor);
+   if (paArguments.useFixpoint())
+      processor_use_fixpoint(processor, paArguments.getWideningDelay());
+   if (paArguments.useParallelBranches())
+      processor_use_parallel_branches(processor, paArguments.getBranchThreads());
+   if (paArguments.useEarlyExit())
+      processor_use_early_exit(processor);
+   if (paArguments.getVerificationCache()
+         && !processor_set_verification_cache(processor, paArguments.getVerificationCache())) {
+      std::cerr << "unable to read the verification cache " << paArguments.getVerificationCache() << std::endl;
+      free_contracts(contracts);
+      free_processor(processor);
+      return false;
+   }
+   pmLoad.stop(isMeasured);
+
+   pmTargets.start();
+   std::vector<BlockSource> blockSources;
+   struct _ContractCursorContent* cursor = contract_cursor_new(contracts);
+   while (contract_cursor_set_to_next(cursor)) {
+      if (contract_cursor_is_final(cursor))
+         continue;
+      blockSources.emplace_back();
+      BlockSource& source = blockSources.back();
+      source.cursor = contract_cursor_clone(cursor);
+      source.address = contract_cursor_get_address(cursor);
+      source.decisions = processor_create_decision_vector(processor);
+      struct _ContractContent* contract = contract_cursor_get_contract(cursor);
+      source.targets.push_back(0);
+      source.targets.push_back(0);
+      TargetAddresses argument;
+      argument.addresses = &source.targets[0];
+      argument.addresses_array_size = 2;
+      argument.addresses_length = 0;
+      argument.realloc_addresses = &reallocAddresses;
+      argument.address_container = &source.targets;
+      contract_fill_stop_addresses(contract, &argument);
+      if (!processor_get_targets(processor, source.address, contract, source.decisions, &argument))
+         argument.addresses_length = 0;
+      source.targets.resize(argument.addresses_length);
+   }
+   contract_cursor_free(cursor);
+   pmTargets.stop(isMeasured);
+
+   pmCheck.start();
+   RunResult result;
+   uint64_t startInstructions = processor_get_interpreted_instructions(processor);
+   struct _ContractCoverageContent* coverage = create_empty_coverage(contracts);
+   for (const auto& source : blockSources) {
+      for (uint64_t target : source.targets) {
+         struct _ContractCursorContent* lastCursor = contract_cursor_clone(source.cursor);
+         contract_cursor_set_address(lastCursor, target, CCLPostCondition);
+         struct _PDecisionVector* decisions = processor_clone_decision_vector(source.decisions);
+         struct _WarningsContent* blockWarnings = create_warnings();
+         ++result.blocks;
+         if (!processor_check_block(processor, source.address, target,
+                  contract_cursor_get_contract(source.cursor),
+                  contract_cursor_get_contract(lastCursor), decisions, coverage, blockWarnings))
+            ++result.failedBlocks;
+         free_warnings(blockWarnings);
+         processor_free_decision_vector(decisions);
+         contract_cursor_free(lastCursor);
+      }
+   }
+   free_coverage(coverage);
+   result.instructions = processor_get_interpreted_instructions(processor) - startInstructions;
+   result.partitionBlocks = processor_get_partition_blocks(processor);
+   pmCheck.stop(isMeasured);
+
+   for (auto& source : blockSources) {
+      processor_free_decision_vector(source.decisions);
+      contract_cursor_free(source.cursor);
+   }
+   if (paArguments.getVerificationCache() && !processor_save_verification_cache(processor))
+      std::cerr << "unable to save the verification cache " << paArguments.getVerificationCache() << std::endl;
+   struct _CheckerStats stats{};
+   processor_get_stats(processor, &stats);
+   free_contracts(contracts);
+   free_processor(processor);
+   if (isMeasured) {
+      addStats(stats);
+      rrResult.blocks += result.blocks;
+      rrResult.failedBlocks += result.failedBlocks;
+      rrResult.instructions += result.instructions;
+      rrResult.partitionBlocks += result.partitionBlocks;
+      ++uRuns;
+   }
+   return true;
+}
+
+void
+Benchmark::addStats(const struct _CheckerStats& stats) {
+   csStats.contract_application_calls += stats.contract_application_calls;
+   csStats.contract_application_ns += stats.contract_application_ns;
+   csStats.expression_evaluation_calls += stats.expression_evaluation_calls;
+   csStats.expression_evaluation_ns += stats.expression_evaluation_ns;
+   csStats.next_targets_calls += stats.next_targets_calls;
+   csStats.next_targets_ns += stats.next_targets_ns;
+   csStats.interpret_calls += stats.interpret_calls;
+   csStats.interpret_ns += stats.interpret_ns;
+   csStats.contain_calls += stats.contain_calls;
+   csStats.contain_ns += stats.contain_ns;
+   csStats.domain_clone_calls += stats.domain_clone_calls;
+   csStats.domain_clone_ns += stats.domain_clone_ns;
+   csStats.domain_free_calls += stats.domain_free_calls;
+   csStats.domain_free_ns += stats.domain_free_ns;
+   csStats.domain_merge_calls += stats.domain_merge_calls;
+   csStats.domain_merge_ns += stats.domain_merge_ns;
+   csStats.file_reads += stats.file_reads;
+   csStats.file_read_bytes += stats.file_read_bytes;
+   csStats.decoded_bytes += stats.decoded_bytes;
+   csStats.verification_cache_hits += stats.verification_cache_hits;
+   csStats.verification_cache_misses += stats.verification_cache_misses;
+   csStats.function_summary_hits += stats.function_summary_hits;
+   csStats.function_summary_misses += stats.function_summary_misses;
+   csStats.domain_compare_calls += stats.domain_compare_calls;
+   csStats.domain_compare_ns += stats.domain_compare_ns;
+   csStats.proven_post_state_hits += stats.proven_post_state_hits;
+   csStats.proven_post_state_misses += stats.proven_post_state_misses;
+   csStats.inline_contain_calls += stats.inline_contain_calls;
+}
+
+/* The counters of processor_get_stats, averaged over the measured runs. */
+void
+Benchmark::writeStatsJSon(std::ostream& out) const {
+   uint64_t runs = uRuns ? uRuns : 1;
+   auto writeTimed = [&out, runs](const char* name, uint64_t calls, uint64_t nanoseconds)
+      {  out << "    \"" << name << "\": { \"calls\": " << calls/runs
+             << ", \"ms\": " << (nanoseconds/(double) runs)/1e6 << " },\n";
+      };
+   out << "  \"counters\": {\n";
+   writeTimed("contract_application", csStats.contract_application_calls, csStats.contract_application_ns);
+   writeTimed("expression_evaluation", csStats.expression_evaluation_calls, csStats.expression_evaluation_ns);
+   writeTimed("next_targets", csStats.next_targets_calls, csStats.next_targets_ns);
+   writeTimed("interpret", csStats.interpret_calls, csStats.interpret_ns);
+   writeTimed("contain", csStats.contain_calls, csStats.contain_ns);
+   writeTimed("domain_clone", csStats.domain_clone_calls, csStats.domain_clone_ns);
+   writeTimed("domain_free", csStats.domain_free_calls, csStats.domain_free_ns);
+   writeTimed("domain_merge", csStats.domain_merge_calls, csStats.domain_merge_ns);
+   writeTimed("domain_compare", csStats.domain_compare_calls, csStats.domain_compare_ns);
+   out << "    \"file_reads\": " << csStats.file_reads/runs << ",\n"
+       << "    \"file_read_bytes\": " << csStats.file_read_bytes/runs << ",\n"
+       << "    \"decoded_bytes\": " << csStats.decoded_bytes/runs << ",\n"
+       << "    \"verification_cache_hits\": " << csStats.verification_cache_hits/runs << ",\n"
+       << "    \"verification_cache_misses\": " << csStats.verification_cache_misses/runs << ",\n"
+       << "    \"function_summary_hits\": " << csStats.function_summary_hits/runs << ",\n"
+       << "    \"function_summary_misses\": " << csStats.function_summary_misses/runs << ",\n"
+       << "    \"proven_post_state_hits\": " << csStats.proven_post_state_hits/runs << ",\n"
+       << "    \"proven_post_state_misses\": " << csStats.proven_post_state_misses/runs << ",\n"
+       << "    \"inline_contain\": " << csStats.inline_contain_calls/runs << "\n"
+       << "  },\n";
+}
+
+void
+Benchmark::writeJSon(std::ostream& out) const {
+   double checkDuration = pmCheck.getTotalDuration();
+   out << "{\n"
+       << "  \"binary\": \"" << paArguments.getInputFile() << "\",\n"
+       << "  \"contracts\": \"" << paArguments.getMemoryFile() << "\",\n"
+       << "  \"warmup\": " << paArguments.getWarmup() << ",\n"
+       << "  \"repeat\": " << uRuns << ",\n"
+       << "  \"phases\": {\n";
+   pmLoad.writeJSon(out, "load");
+   out << ",\n";
+   pmTargets.writeJSon(out, "targets");
+   out << ",\n";
+   pmCheck.writeJSon(out, "check");
+   out << "\n  },\n";
+   writeStatsJSon(out);
+   out << "  \"blocks\": " << (uRuns ? rrResult.blocks/uRuns : 0) << ",\n"
+       << "  \"failed_blocks\": " << (uRuns ? rrResult.failedBlocks/uRuns : 0) << ",\n"
+       << "  \"instructions\": " << (uRuns ? rrResult.instructions/uRuns : 0) << ",\n"
+       << "  \"partition_blocks\": " << (uRuns ? rrResult.partitionBlocks/uRuns : 0) << ",\n"
+       << "  \"blocks_per_s\": " << (checkDuration > 0 ? rrResult.blocks/checkDuration : 0) << ",\n"
+       << "  \"instructions_per_s\": " << (checkDuration > 0 ? rrResult.instructions/checkDuration : 0) << "\n"
+       << "}\n";
+}
+
+int main(int argc, char** argv) {
+   ProcessArgument processArgument(argc, argv);
+   if (argc == 1) {
+      processArgument.printUsage(std::cout);
+      return 0;
+   };
+   if (!processArgument.isValid()) {
+      if (!processArgument.hasEchoedMessage())
+         processArgument.printUsage(std::cout);
+      return 1;
+   };
+
+   Benchmark benchmark(processArgument);
+   for (int warmup = 0; warmup < processArgument.getWarmup(); ++warmup)
+      if (!benchmark.run(false))
+         return 1;
+   if (processArgument.getTrace())
+      trace_start(1 << 20);
+   for (int repeat = 0; repeat < processArgument.getRepeat(); ++repeat)
+      if (!benchmark.run(true))
+         return 1;
+   if (processArgument.getTrace()) {
+      trace_stop();
+      if (!trace_write(processArgument.getTrace())) {
+         std::cerr << "unable to write the trace in " << processArgument.getTrace() << std::endl;
+         return 1;
+      }
+   }
+
+   if (processArgument.hasOutput()) {
+      std::ofstream out(processArgument.getOutput());
+      if (!out) {
+         std::cerr << "unable to write the report in " << processArgument.getOutput() << std::endl;
+         return 1;
+      }
+      benchmark.writeJSon(out);
+   }
+   else
+      benchmark.writeJSon(std::cout);
+   return 0;
+}
@@ -0,0 +1,519 @@
+#include "contract_checker.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef DEFAULT_ARCHITECTURE_LIBRARY
+#define DEFAULT_ARCHITECTURE_LIBRARY "armsec_decoder.so"
+#endif
+#ifndef DEFAULT_DOMAIN_LIBRARY
+#define DEFAULT_DOMAIN_LIBRARY "libScalarInterface.so"
+#endif
+
+/* Generation of synthetic contract graphs for the scalability benchmarks.
+ * The contracts form a tree rooted in the initial contract whose shape is
+ * controlled by the command line. The JSON text is loaded back with the
+ * architecture and domain libraries and saved through ContractGraph::writeJSon,
+ * so that the output is what the checker itself understands.
+ */
+
+class ProcessArgument {
+  private:
+   const char* szOutputFile = nullptr;
+   const char* szBinaryFile = nullptr;
+   const char* szArch = nullptr;
+   const char* szDomain = nullptr;
+   int uContracts = 64;
+   int uFanout = 2;
+   int uDominatorDepth = 0;
+   int uZones = 0;
+   int uConstraints = 2;
+   int uIndirectConstraints = 0;
+   int uExpressionDepth = 0;
+   int uSeed = 1;
+   int uStep = 0x40;
+   int uStart = 0x1000;
+   int uAllocShift = 0;
+   bool fHasLoops = false;
+   bool fHasCalls = false;
+   bool fHasLets = false;
+   bool fHasEchoedMessage = false;
+
+   bool readCount(char** argument, int& currentArgument, int& result, long min, long max);
+
+  public:
+   ProcessArgument() = default;
+   ProcessArgument(int argc, char** argv)
+      {  int arg = argc-2;
+         while (arg >= 0)
+            fHasEchoedMessage = !process(argv + (argc - arg - 1), arg) && fHasEchoedMessage;
+      }
+
+   bool process(char** argument, int& currentArgument);
+   void printUsage(std::ostream& out) const
+      {  if (fHasEchoedMessage)
+            return;
+         out << "usage of generate_contracts:\n"
+             << "\tgenerate_contracts [options] contracts.json\n"
+             << "\n"
+             << "where option can be:\n"
+             << "\t-arch armsec.so \t\tto provide the instruction set\n"
+             << "\t-dom domsec.so \t\tto provide the domain library\n"
+             << "\t-contracts n \t\tnumber of contracts (default 64)\n"
+             << "\t-fanout n \t\tnumber of successors of a non final contract (default 2)\n"
+             << "\t-dominator-depth n \tmaximal length of the dominator chains (default 0)\n"
+             << "\t-zones n \t\tnumber of zones created by each contract (default 0)\n"
+             << "\t-constraints n \t\tnumber of register constraints of each contract (default 2)\n"
+             << "\t-indirect n \t\tnumber of indirect constraints of each contract (default 0)\n"
+             << "\t-expr-depth n \t\tdepth of the constraint expressions (default 0)\n"
+             << "\t-seed n \t\tseed of the pseudo-random generator (default 1)\n"
+             << "\t-start n \t\taddress of the initial contract (default 4096)\n"
+             << "\t-step n \t\tdistance in bytes between consecutive contracts (default 64)\n"
+             << "\t-alloc-shift n \t\tdifference between addresses and file offsets (default 0)\n"
+             << "\t-loops \t\t\tstart each slot of the firmware with a loop of unknown count\n"
+             << "\t-calls \t\t\tcall a shared function from each slot of the firmware\n"
+             << "\t-lets \t\t\tcompute the indirect addresses from a let variable of the contract\n"
+             << "\t-binary code.bin \twrite a firmware for the stub decoder of stubs/\n";
+         out.flush();
+      }
+
+   bool isValid() const { return szOutputFile; }
+   bool hasEchoedMessage() const { return fHasEchoedMessage; }
+
+   const char* getOutputFile() const { return szOutputFile; }
+   const char* getBinaryFile() const { return szBinaryFile; }
+   const char* getArch() const { return szArch ? szArch : DEFAULT_ARCHITECTURE_LIBRARY; }
+   const char* getDomain() const { return szDomain ? szDomain : DEFAULT_DOMAIN_LIBRARY; }
+   int getContracts() const { return uContracts; }
+   int getFanout() const { return uFanout; }
+   int getDominatorDepth() const { return uDominatorDepth; }
+   int getZones() const { return uZones; }
+   int getConstraints() const { return uConstraints; }
+   int getIndirectConstraints() const { return uIndirectConstraints; }
+   int getExpressionDepth() const { return uExpressionDepth; }
+   int getSeed() const { return uSeed; }
+   uint64_t getStart() const { return (uint64_t) uStart; }
+   uint64_t getStep() const { return (uint64_t) uStep; }
+   uint64_t getAllocShift() const { return (uint64_t) uAllocShift; }
+   bool hasLoops() const { return fHasLoops; }
+   bool hasCalls() const { return fHasCalls; }
+   bool hasLets() const { return fHasLets; }
+};
+
+bool
+ProcessArgument::readCount(char** argument, int& currentArgument, int& result, long min, long max) {
+   if (currentArgument == 0) {
+      printUsage(std::cout);
+      return false;
+   }
+   char* end = nullptr;
+   long value = std::strtol(argument[1], &end, 0);
+   if (!end || *end != '\0' || value < min || value > max) {
+      printUsage(std::cout);
+      return false;
+   }
+   currentArgument -= 2;
+   result = (int) value;
+   return true;
+}
+
+bool
+ProcessArgument::process(char** argument, int& currentArgument) {
+   if (argument[0][0] == '-') {
+      const char* option = &argument[0][1];
+      const char** target = nullptr;
+      if (strcmp(option, "arch") == 0)
+         target = &szArch;
+      else if (strcmp(option, "dom") == 0)
+         target = &szDomain;
+      else if (strcmp(option, "binary") == 0)
+         target = &szBinaryFile;
+      else if (strcmp(option, "contracts") == 0)
+         return readCount(argument, currentArgument, uContracts, 1, 10000000);
+      else if (strcmp(option, "fanout") == 0)
+         return readCount(argument, currentArgument, uFanout, 1, 1000);
+      else if (strcmp(option, "dominator-depth") == 0)
+         return readCount(argument, currentArgument, uDominatorDepth, 0, 1000000);
+      else if (strcmp(option, "zones") == 0)
+         return readCount(argument, currentArgument, uZones, 0, 1000);
+      else if (strcmp(option, "constraints") == 0)
+         return readCount(argument, currentArgument, uConstraints, 0, 13);
+      else if (strcmp(option, "indirect") == 0)
+         return readCount(argument, currentArgument, uIndirectConstraints, 0, 1000);
+      else if (strcmp(option, "expr-depth") == 0)
+         return readCount(argument, currentArgument, uExpressionDepth, 0, 16);
+      else if (strcmp(option, "seed") == 0)
+         return readCount(argument, currentArgument, uSeed, 0, 0x7fffffff);
+      else if (strcmp(option, "start") == 0)
+         return readCount(argument, currentArgument, uStart, 1, 0x7fffffff);
+      else if (strcmp(option, "step") == 0)
+         return readCount(argument, currentArgument, uStep, 4, 0x100000);
+      else if (strcmp(option, "alloc-shift") == 0)
+         return readCount(argument, currentArgument, uAllocShift, 0, 0x7fffffff);
+      else if (strcmp(option, "loops") == 0) {
+         fHasLoops = true;
+         --currentArgument;
+         return true;
+      }
+      else if (strcmp(option, "calls") == 0) {
+         fHasCalls = true;
+         --currentArgument;
+         return true;
+      }
+      else if (strcmp(option, "lets") == 0) {
+         fHasLets = true;
+         --currentArgument;
+         return true;
+      }
+      else {
+         printUsage(std::cout);
+         --currentArgument;
+         return false;
+      }
+      if (currentArgument == 0 || *target) {
+         printUsage(std::cout);
+         return false;
+      };
+      currentArgument -= 2;
+      *target = argument[1];
+   }
+   else {
+      if (szOutputFile) {
+         printUsage(std::cout);
+         --currentArgument;
+         return false;
+      }
+      szOutputFile = argument[0];
+      --currentArgument;
+   }
+   return true;
+}
+
+/* Deterministic xorshift64* generator: the same seed always produces the
+ * same contract graph, independently of the standard library.
+ */
+class RandomGenerator {
+  private:
+   uint64_t uState;
+
+  public:
+   RandomGenerator(uint64_t seed) : uState(seed * 0x9e3779b97f4a7c15ULL + 1) {}
+   uint64_t next()
+      {  uState ^= uState >> 12;
+         uState ^= uState << 25;
+         uState ^= uState >> 27;
+         return uState * 0x2545f4914f6cdd1dULL;
+      }
+   uint64_t below(uint64_t bound) { return bound ? next() % bound : 0; }
+};
+
+class ContractGenerator {
+  private:
+   const ProcessArgument& paArguments;
+   std::vector<std::string> vsRegisterExpressions;
+   std::vector<std::string> vsIndirectExpressions;
+
+   std::string newExpression(RandomGenerator& random, int depth, int registerIndex) const;
+   std::string newDomain(RandomGenerator& random) const;
+   static std::string registerExpression(const std::string& name);
+   static std::string indirectAddress(int indirect, bool hasLets);
+
+  public:
+   ContractGenerator(const ProcessArgument& arguments);
+
+   int getParent(int index) const { return (index-1)/paArguments.getFanout(); }
+   uint64_t getAddress(int index) const
+      {  return paArguments.getStart() + paArguments.getStep()*(uint64_t) index; }
+   uint64_t getZoneStart(int index, int zone) const
+      {  return 0x100000 + 0x100*((uint64_t) index*paArguments.getZones() + zone); }
+   void writeJSon(std::ostream& out) const;
+   bool writeBinary(std::ostream& out) const;
+};
+
+std::string
+ContractGenerator::registerExpression(const std::string& name) {
+   return "{ \"type\": \"register\", \"content\": { \"content\": \"" + name + "\" } }";
+}
+
+/* With -lets, the base of the indirect addresses is the let variable "base"
+ * defined at the start of the constraints of every contract.
+ */
+std::string
+ContractGenerator::indirectAddress(int indirect, bool hasLets) {
+   std::ostringstream out;
+   if (!hasLets)
+      out << "{ \"type\": \"domain\", \"content\": { \"content\": \"" << (0x10000 + 4*indirect)
+          << "_32\" } }";
+   else
+      out << "{ \"type\": \"operation\", \"content\": { \"type\": \"integer\", "
+          << "\"first\": { \"type\": \"let\", \"content\": { \"content\": \"base\" } }, "
+          << "\"second\": { \"type\": \"domain\", \"content\": { \"content\": \"" << 4*indirect
+          << "_32\" } }, \"code\": \"+\" } }";
+   return out.str();
+}
+
+std::string
+ContractGenerator::newDomain(RandomGenerator& random) const {
+   std::ostringstream out;
+   uint64_t low = random.below(0x1000);
+   out << "{ \"type\": \"domain\", \"content\": { \"content\": \"";
+   if (random.below(2) == 0)
+      out << low << "_32";
+   else
+      out << '[' << low << "_32, " << (low + 1 + random.below(0x1000)) << "_32]U_32";
+   out << "\" } }";
+   return out.str();
+}
+
+/* The leaves of the expressions only refer to the registers of lower index,
+ * so that a constraint never depends on itself.
+ */
+std::string
+ContractGenerator::newExpression(RandomGenerator& random, int depth, int registerIndex) const {
+   if (depth == 0) {
+      if (registerIndex > 0 && random.below(3) == 0)
+         return registerExpression("r" + std::to_string(random.below(registerIndex)));
+      return newDomain(random);
+   }
+   static const char* codes[] = { "+", "-", "&", "|" };
+   const char* code = codes[random.below(sizeof(codes)/sizeof(codes[0]))];
+   std::ostringstream out;
+   out << "{ \"type\": \"operation\", \"content\": { \"type\": \"integer\", "
+       << "\"first\": " << newExpression(random, depth-1, registerIndex) << ", "
+       << "\"second\": " << newExpression(random, depth-1, registerIndex) << ", "
+       << "\"code\": \"" << code << "\" } }";
+   return out.str();
+}
+
+/* The constraint expressions only depend on the seed: every contract shares
+ * them, which keeps the blocks provable when the code does not modify the
+ * constrained locations.
+ */
+ContractGenerator::ContractGenerator(const ProcessArgument& arguments)
+   :  paArguments(arguments) {
+   RandomGenerator random(arguments.getSeed());
+   for (int index = 0; index < arguments.getConstraints(); ++index)
+      vsRegisterExpressions.push_back(newExpression(random, arguments.getExpressionDepth(), index));
+   for (int index = 0; index < arguments.getIndirectConstraints(); ++index)
+      vsIndirectExpressions.push_back(newExpression(random, arguments.getExpressionDepth(), 0));
+}
+
+void
+ContractGenerator::writeJSon(std::ostream& out) const {
+   int contracts = paArguments.getContracts();
+   int fanout = paArguments.getFanout();
+   std::vector<int> dominatorDepths(contracts, 0);
+   out << "{\n  [\n";
+   for (int index = 0; index < contracts; ++index) {
+      out << "    { \"nexts\": [";
+      for (int child = index*fanout+1; child <= index*fanout+fanout && child < contracts; ++child)
+         out << (child == index*fanout+1 ? " " : ", ") << child+1;
+      out << " ],\n      \"previouses\": [";
+      if (index > 0)
+         out << ' ' << getParent(index)+1;
+      out << " ],\n";
+      if (index > 0 && dominatorDepths[getParent(index)] < paArguments.getDominatorDepth()) {
+         dominatorDepths[index] = dominatorDepths[getParent(index)] + 1;
+         out << "      \"dominator\": " << getParent(index)+1 << ",\n";
+      }
+      out << "      \"id\": " << index+1 << ",\n"
+          << "      \"address\": " << getAddress(index) << ",\n"
+          << "      \"localization\": \"before\",\n"
+          << "      \"zones\": [";
+      for (int zone = 0; zone < paArguments.getZones(); ++zone)
+         out << (zone == 0 ? "\n" : ",\n")
+             << "        { \"type\": \"create\", \"content\": { \"start\": { \"type\": \"domain\", "
+             << "\"content\": { \"content\": \"" << getZoneStart(index, zone) << "_32\" } }, "
+             << "\"length\": { \"type\": \"domain\", \"content\": { \"content\": \"256_32\" } }, "
+             << "\"name\": \"z" << index+1 << '_' << zone << "\" } }";
+      out << " ],\n      \"constraints\": [";
+      bool isFirst = true;
+      if (paArguments.hasLets() && !vsIndirectExpressions.empty()) {
+         out << "\n        { \"type\": \"let\", \"content\": { \"constraint\": "
+             << "{ \"type\": \"operation\", \"content\": { \"type\": \"integer\", "
+             << "\"first\": { \"type\": \"domain\", \"content\": { \"content\": \"32768_32\" } }, "
+             << "\"second\": { \"type\": \"domain\", \"content\": { \"content\": \"32768_32\" } }, "
+             << "\"code\": \"+\" } }, \"name\": \"base\" } }";
+         isFirst = false;
+      }
+      for (int reg = 0; reg < (int) vsRegisterExpressions.size(); ++reg) {
+         out << (isFirst ? "\n" : ",\n")
+             << "        { \"type\": \"register\", \"content\": { \"constraint\": "
+             << vsRegisterExpressions[reg] << ", \"register\": \"r" << reg << "\" } }";
+         isFirst = false;
+      }
+      for (int indirect = 0; indirect < (int) vsIndirectExpressions.size(); ++indirect) {
+         out << (isFirst ? "\n" : ",\n")
+             << "        { \"type\": \"indirect\", \"content\": { \"constraint\": "
+             << vsIndirectExpressions[indirect] << ", \"address\": "
+             << indirectAddress(indirect, paArguments.hasLets()) << " } }";
+         isFirst = false;
+      }
+      out << " ]\n    }" << (index+1 < contracts ? ",\n" : "\n");
+   }
+   out << "  ]";
+   if (paArguments.getAllocShift() > 0)
+      out << ",\n  \"alloc-shift\": " << paArguments.getAllocShift();
+   out << "\n}\n";
+}
+
+/* Firmware for the instruction set of stubs/StubDecoder.cpp. The slot of
+ * each contract contains some arithmetic on r11, that is never constrained,
+ * and ends with a branch to each of its successors; the final contracts end
+ * with halt. Every block between two contracts is then a linear block, which
+ * limits the fan-out to the two targets of beqz. With -loops, the slot starts
+ * with a loop that increments r11 and exits on beqz r12: its number of
+ * iterations is unknown, which requires the fixpoint of processor_use_fixpoint.
+ * With -calls, every slot calls a function placed after the last slot that
+ * adds its argument r0 to r11; the argument comes from the contract, which
+ * gives the same summary to all the calls.
+ */
+bool
+ContractGenerator::writeBinary(std::ostream& out) const {
+   int contracts = paArguments.getContracts();
+   int fanout = paArguments.getFanout();
+   uint64_t step = paArguments.getStep();
+   if (paArguments.getStart() < paArguments.getAllocShift() || fanout > 2 || (step % 4) != 0) {
+      std::cerr << "the firmware requires start >= alloc-shift, fanout <= 2 and step multiple of 4" << std::endl;
+      return false;
+   }
+   std::vector<unsigned char> code((size_t) (paArguments.getStart() - paArguments.getAllocShift()), 0);
+   auto addInstruction = [&code](int opcode, int rd, int rs, int imm)
+      {  code.push_back((unsigned char) opcode);
+         code.push_back((unsigned char) rd);
+         code.push_back((unsigned char) rs);
+         code.push_back((unsigned char) imm);
+      };
+   for (int index = 0; index < contracts; ++index) {
+      int firstChild = index*fanout+1;
+      int children = firstChild >= contracts ? 0
+         : (firstChild + fanout <= contracts ? fanout : contracts - firstChild);
+      int bodySize = (int) (step/4) - (children > 0 ? children : 1);
+      if (paArguments.hasLoops() && bodySize < 5) {
+         std::cerr << "the loops require a step of at least " << 4*(5+fanout) << " bytes" << std::endl;
+         return false;
+      }
+      int callPosition = paArguments.hasLoops() ? 4 : 1;
+      if (paArguments.hasCalls() && bodySize <= callPosition) {
+         std::cerr << "the calls require a step of at least " << 4*(callPosition+1+fanout)
+            << " bytes" << std::endl;
+         return false;
+      }
+      for (int instruction = 0; instruction < bodySize; ++instruction) {
+         if (paArguments.hasCalls() && instruction == callPosition) {
+            uint64_t source = getAddress(index) + 4*(uint64_t) instruction;
+            int64_t offset = ((int64_t) getAddress(contracts) - (int64_t) source)/4;
+            if (offset > 0x7fff) {
+               std::cerr << "the call from contract " << index+1 << " is out of range, reduce -step"
+                  << std::endl;
+               return false;
+            };
+            uint16_t encoded = (uint16_t) (int16_t) offset;
+            addInstruction(0x09 /* bl */, 0, encoded & 0xff, encoded >> 8);
+         }
+         else if (instruction == 0)
+            addInstruction(0x01 /* movi */, 11, 0, index & 0xff);
+         else if (paArguments.hasLoops() && instruction == 1)
+            addInstruction(0x02 /* addi */, 11, 11, 1);
+         else if (paArguments.hasLoops() && instruction == 2)
+            addInstruction(0x08 /* beqz */, 12, 2, 0);
+         else if (paArguments.hasLoops() && instruction == 3)
+            addInstruction(0x07 /* b */, 0, 0xfe, 0xff);
+         else if (instruction % 2)
+            addInstruction(0x02 /* addi */, 11, 11, 1);
+         else
+            addInstruction(0x00 /* nop */, 0, 0, 0);
+      }
+      if (children == 0)
+         addInstruction(0x0a /* halt */, 0, 0, 0);
+      for (int child = 0; child < children; ++child) {
+         uint64_t source = getAddress(index) + 4*(uint64_t) (bodySize + child);
+         int64_t offset = ((int64_t) getAddress(firstChild + child) - (int64_t) source)/4;
+         if (offset > 0x7fff || offset < -0x8000) {
+            std::cerr << "the branch from contract " << index+1 << " to contract "
+               << firstChild+child+1 << " is out of range, reduce -step" << std::endl;
+            return false;
+         };
+         uint16_t encoded = (uint16_t) (int16_t) offset;
+         /* r12 is never constrained, hence both targets of beqz are reachable */
+         addInstruction(child+1 < children ? 0x08 /* beqz */ : 0x07 /* b */, 12,
+               encoded & 0xff, encoded >> 8);
+      }
+   }
+   if (paArguments.hasCalls()) {
+      addInstruction(0x03 /* add */, 11, 11, 0);
+      addInstruction(0x02 /* addi */, 11, 11, 1);
+      addInstruction(0x0b /* ret */, 0, 0, 0);
+   }
+   out.write(reinterpret_cast<const char*>(code.data()), code.size());
+   return (bool) out;
+}
+
+namespace {
+
+void
+printWarnings(struct _WarningsContent* warnings) {
+   struct _WarningCursorContent* cursor = warning_create_cursor(warnings);
+   while (warning_set_to_next(cursor)) {
+      struct _Warning error{};
+      warning_retrieve_message(cursor, &error);
+      std::cerr << error.filepos << ':' << error.linepos << " error at column "
+         << error.columnpos << ", " << error.message << '\n';
+   };
+   warning_free_cursor(cursor);
+   std::cerr.flush();
+}
+
+}
+
+int main(int argc, char** argv) {
+   ProcessArgument processArgument(argc, argv);
+   if (argc == 1) {
+      processArgument.printUsage(std::cout);
+      return 0;
+   };
+   if (!processArgument.isValid()) {
+      if (!processArgument.hasEchoedMessage())
+         processArgument.printUsage(std::cout);
+      return 1;
+   };
+
+   ContractGenerator generator(processArgument);
+   {  std::ofstream out(processArgument.getOutputFile());
+      if (!out) {
+         std::cerr << "unable to write the contracts in " << processArgument.getOutputFile() << std::endl;
+         return 1;
+      }
+      generator.writeJSon(out);
+   }
+   if (processArgument.getBinaryFile()) {
+      std::ofstream out(processArgument.getBinaryFile(), std::ios::binary);
+      if (!out || !generator.writeBinary(out)) {
+         std::cerr << "unable to write the firmware in " << processArgument.getBinaryFile() << std::endl;
+         return 1;
+      }
+   }
+
+   struct _PProcessor* processor = create_processor(processArgument.getArch(), processArgument.getDomain());
+   if (!processor)
+      return 1;
+   struct _WarningsContent* warnings = create_warnings();
+   struct _ContractGraphContent* contracts = load_contracts(processArgument.getOutputFile(),
+         processor, warnings);
+   if (!contracts) {
+      std::cerr << "unable to reload the generated contracts from " << processArgument.getOutputFile() << std::endl;
+      printWarnings(warnings);
+      free_warnings(warnings);
+      free_processor(processor);
+      return 1;
+   }
+   free_warnings(warnings);
+   bool result = save_contracts(contracts, processArgument.getOutputFile(), processor);
+   free_contracts(contracts);
+   free_processor(processor);
+   return result ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "Atom.h"
+#include "TString/TernaryTreeInterface.h"
+#include "TString/TernaryTreeInterface.template"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace {
+
+class AtomTable {
+  private:
+   struct AtomEntry : public EnhancedObject {
+      int id = 0;
+      AtomEntry() = default;
+      AtomEntry(int aid) : id(aid) {}
+      AtomEntry(const AtomEntry&) = default;
+      AtomEntry& operator=(const AtomEntry&) = default;
+      DefineCopy(AtomEntry)
+   };
+   typedef COL::TCopyCollection<COL::TTernaryTree<STG::SubString, AtomEntry> > AtomCollection;
+
+   AtomCollection ttAtoms;
+   std::deque<STG::SubString> dNames; // stable references, indexed by id
+   std::mutex mLock;                  // for the insertions only
+   /* the names are read without lock through chunks of pointers that never
+    * move; auSize publishes the pointers written before it.
+    */
+   static const int ChunkBits = 12, ChunkSize = 1 << ChunkBits, MaxChunks = 4096;
+   const STG::SubString** apChunks[MaxChunks] = {};
+   std::atomic<int> auSize;
+
+   void publish(const STG::SubString& name)
+      {  int id = auSize.load(std::memory_order_relaxed);
+         AssumeCondition((id >> ChunkBits) < MaxChunks)
+         const STG::SubString**& chunk = apChunks[id >> ChunkBits];
+         if (!chunk)
+            chunk = new const STG::SubString*[ChunkSize];
+         chunk[id & (ChunkSize-1)] = &name;
+         auSize.store(id+1, std::memory_order_release);
+      }
+
+  public:
+   AtomTable() : auSize(0)
+      {  dNames.push_back(STG::SString());
+         publish(dNames.back());
+      }
+   ~AtomTable()
+      {  for (auto* chunk : apChunks)
+            delete [] chunk;
+      }
+
+   static AtomTable& instance()
+      {  static AtomTable table;
+         return table;
+      }
+
+   int intern(const STG::SubString& name)
+      {  if (name.length() == 0)
+            return 0;
+         std::lock_guard<std::mutex> lock(mLock);
+         {  COL::TTernaryTree<STG::SubString, AtomEntry>::Cursor cursor(ttAtoms);
+            if (ttAtoms.locateKey(name, cursor, COL::VirtualCollection::RPExact))
+               return cursor.elementAt().id;
+         }
+         int result = (int) dNames.size();
+         dNames.push_back(STG::SString(name));
+         ttAtoms.add(dNames.back(), new AtomEntry(result));
+         publish(dNames.back());
+         return result;
+      }
+   const STG::SubString& retrieveName(int id) const
+      {  AssumeCondition(id >= 0 && id < auSize.load(std::memory_order_acquire))
+         return *apChunks[id >> ChunkBits][id & (ChunkSize-1)];
+      }
+};
+
+}
+
+int
+Atom::intern(const STG::SubString& name) {
+   return AtomTable::instance().intern(name);
+}
+
+const STG::SubString&
+Atom::retrieveName(int id) {
+   return AtomTable::instance().retrieveName(id);
+}
+
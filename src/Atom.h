@@ -0,0 +1,32 @@
+#pragma once
+
+#include "TString/String.hpp"
+
+/* An Atom is an interned name: the same text always gives the same id, so that
+ * register and zone names are compared as integers and their characters are
+ * stored only once in a global table. The id 0 stands for the empty name.
+ */
+class Atom {
+  private:
+   int uId = 0;
+
+   static int intern(const STG::SubString& name);
+   static const STG::SubString& retrieveName(int id);
+
+  public:
+   Atom() = default;
+   explicit Atom(const STG::SubString& name) : uId(intern(name)) {}
+   Atom(const Atom&) = default;
+   Atom& operator=(const Atom&) = default;
+   Atom& operator=(const STG::SubString& name) { uId = intern(name); return *this; }
+
+   bool isValid() const { return uId > 0; }
+   int getId() const { return uId; }
+   const STG::SubString& getName() const { return retrieveName(uId); }
+   void clear() { uId = 0; }
+
+   bool operator==(const Atom& source) const { return uId == source.uId; }
+   bool operator!=(const Atom& source) const { return uId != source.uId; }
+   ComparisonResult compare(const Atom& source) const { return fcompare(uId, source.uId); }
+};
+
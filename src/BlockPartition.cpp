@@ -0,0 +1,82 @@
+#include "BlockPartition.h"
+#include <algorithm>
+#include <iterator>
+
+int
+BlockPartition::locate(uint64_t address) const {
+   Instruction key;
+   key.address = address;
+   auto found = std::lower_bound(vInstructions.begin(), vInstructions.end(), key);
+   if (found == vInstructions.end() || found->address != address)
+      return -1;
+   return (int) (found - vInstructions.begin());
+}
+
+void
+BlockPartition::addLinear(std::vector<Instruction>& newInstructions, uint64_t address,
+      uint64_t next, uint64_t callReturn) {
+   newInstructions.emplace_back();
+   Instruction& instruction = newInstructions.back();
+   instruction.address = address;
+   instruction.next = next;
+   instruction.callReturn = callReturn;
+}
+
+void
+BlockPartition::addTerminator(std::vector<Instruction>& newInstructions, uint64_t address,
+      const uint64_t* successors, int successorsCount) {
+   newInstructions.emplace_back();
+   Instruction& instruction = newInstructions.back();
+   instruction.address = address;
+   instruction.successorsStart = (int) vSuccessors.size();
+   instruction.successorsCount = successorsCount;
+   vSuccessors.insert(vSuccessors.end(), successors, successors + successorsCount);
+}
+
+void
+BlockPartition::merge(std::vector<Instruction>&& newInstructions) {
+   if (newInstructions.empty())
+      return;
+   std::sort(newInstructions.begin(), newInstructions.end());
+   std::vector<Instruction> instructions;
+   instructions.reserve(vInstructions.size() + newInstructions.size());
+   std::merge(vInstructions.begin(), vInstructions.end(),
+         newInstructions.begin(), newInstructions.end(), std::back_inserter(instructions));
+   vInstructions.swap(instructions);
+
+   // the indices have moved: the links and the block starts are computed again
+   std::vector<bool> isBlockStart(vInstructions.size(), false);
+   uBlocksNumber = 0;
+   int index = 0;
+   for (auto& instruction : vInstructions) {
+      if (instruction.isLinear()) {
+         if (index + 1 < (int) vInstructions.size() && vInstructions[index + 1].address == instruction.next)
+            instruction.nextIndex = index + 1;
+         else
+            instruction.nextIndex = locate(instruction.next);
+         if (instruction.nextIndex >= 0 && instruction.nextIndex != index + 1)
+            isBlockStart[instruction.nextIndex] = true;
+         if (instruction.callReturn) {
+            int returnIndex = locate(instruction.callReturn);
+            if (returnIndex >= 0)
+               isBlockStart[returnIndex] = true;
+         }
+      }
+      else {
+         for (int successor = 0; successor < instruction.successorsCount; ++successor) {
+            int successorIndex = locate(vSuccessors[instruction.successorsStart + successor]);
+            if (successorIndex >= 0)
+               isBlockStart[successorIndex] = true;
+         }
+         if (index + 1 < (int) vInstructions.size())
+            isBlockStart[index + 1] = true;
+      }
+      ++index;
+   }
+   if (!vInstructions.empty())
+      isBlockStart[0] = true;
+   for (bool isStart : isBlockStart)
+      if (isStart)
+         ++uBlocksNumber;
+}
+
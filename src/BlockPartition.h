@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/* Partition of the code image in linear blocks, computed once with an
+ * unconstrained memory state and shared by all the contracts. The instructions
+ * are kept sorted by address in a compact array: a linear instruction has a
+ * single successor (the next instruction or the target of an unconditional
+ * jump) that is independent of the memory state, a terminator has the static
+ * successors returned by the decoder under an unconstrained state and its
+ * actual successors are decoded again with the memory state of the contract.
+ */
+class BlockPartition {
+  public:
+   struct Instruction {
+      uint64_t address = 0;
+      uint64_t next = 0;        // single successor of a linear instruction
+      uint64_t callReturn = 0;  // return address of a call, next being the callee
+      int nextIndex = -1;       // index of next, -1 if it is not in the partition
+      int successorsStart = 0;  // static successors of a terminator
+      int successorsCount = -1; // -1 for a linear instruction
+
+      bool isLinear() const { return successorsCount < 0; }
+      bool operator<(const Instruction& source) const { return address < source.address; }
+   };
+
+  private:
+   std::vector<char> vCode;
+   uint64_t uCodeStart = 0;
+   bool fHasCode = false;
+   std::vector<Instruction> vInstructions;
+   std::vector<uint64_t> vSuccessors;
+   int uBlocksNumber = 0;
+
+  public:
+   BlockPartition() = default;
+
+   void clear()
+      {  vCode.clear();
+         fHasCode = false;
+         vInstructions.clear();
+         vSuccessors.clear();
+         uBlocksNumber = 0;
+      }
+   bool hasCode() const { return fHasCode; }
+   size_t getCodeSize() const { return vCode.size(); }
+   void setCode(std::vector<char>&& code, uint64_t codeStart)
+      {  vCode = std::move(code);
+         uCodeStart = codeStart;
+         fHasCode = true;
+      }
+   // instruction bytes at address, nullptr outside of the code image
+   char* getCode(uint64_t address, size_t& size)
+      {  if (address < uCodeStart || address - uCodeStart >= vCode.size())
+            return nullptr;
+         size = vCode.size() - (size_t) (address - uCodeStart);
+         return &vCode[address - uCodeStart];
+      }
+
+   int locate(uint64_t address) const;
+   const Instruction& operator[](int index) const { return vInstructions[index]; }
+   int getInstructionsNumber() const { return (int) vInstructions.size(); }
+   int getBlocksNumber() const { return uBlocksNumber; }
+   const uint64_t* getSuccessors(const Instruction& instruction) const
+      {  return instruction.successorsCount > 0 ? &vSuccessors[instruction.successorsStart] : nullptr; }
+
+   // the new instructions come from an exploration that skips the known addresses
+   void addLinear(std::vector<Instruction>& newInstructions, uint64_t address, uint64_t next,
+         uint64_t callReturn = 0);
+   void addTerminator(std::vector<Instruction>& newInstructions, uint64_t address,
+         const uint64_t* successors, int successorsCount);
+   void merge(std::vector<Instruction>&& newInstructions);
+};
+
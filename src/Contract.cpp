@@ -1,5 +1,11 @@
 #include "Contract.h"
+#include "VerificationCache.h"
 #include "Collection/Collection.template"
+#include <fstream>
+#include <sstream>
+
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
 
 STG::Lexer::Base::ReadResult
 Contract::readJSon(STG::JSon::CommonParser::State& state,
@@ -32,8 +38,10 @@ Contract::readJSon(STG::JSon::CommonParser::State& state,
 #undef DefineGoto
 
 LBegin:
+   uSourceStartLine = arguments.getLine();
+   uSourceStartColumn = arguments.getColumn();
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
    }
    ++state.point();
@@ -54,7 +62,7 @@ LAfterBegin:
          if (!arguments.setToNextToken(result)) return result;
 LNextsArray:
          if (!arguments.isOpenArray()) {
-            if (!arguments.addErrorMessage(STG::SString("expected '['")))
+            if (!arguments.addErrorMessage("expected '['"))
                return result;
             state.point() = DAfterBegin;
             continue;
@@ -93,7 +101,7 @@ LNext:
          if (!arguments.setToNextToken(result)) return result;
 LPreviousesArray:
          if (!arguments.isOpenArray()) {
-            if (!arguments.addErrorMessage(STG::SString("expected '['")))
+            if (!arguments.addErrorMessage("expected '['"))
                return result;
             state.point() = DAfterBegin;
             continue;
@@ -202,7 +210,7 @@ LLocalization:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
             if (!setLocalizationFromText(clLocalization, arguments.valueAsText())) {
-               if (!arguments.addErrorMessage(STG::SString("invalid localization")))
+               if (!arguments.addErrorMessage("invalid localization"))
                   return result;
             }
          }
@@ -257,8 +265,10 @@ LConstraints:
    state.point() = DEnd;
    if (!arguments.setToNextToken(result)) return result;
 LEnd:
+   uSourceEndLine = arguments.getLine();
+   uSourceEndColumn = arguments.getColumn();
    if (!isValid()) {
-      if (!arguments.addErrorMessage(STG::SString("contract is not complete"))) {
+      if (!arguments.addErrorMessage("contract is not complete")) {
          arguments.reduceState(state);
          return result;
       }
@@ -342,7 +352,7 @@ LWriteNext:
    if (!arguments.writeEvent(result)) return result;
 
 LPreviouses:
-   arguments.setAddKey(STG::SString("nexts"));
+   arguments.setAddKey(STG::SString("previouses"));
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -454,6 +464,7 @@ Contract::applyOneTo(MemoryState& memoryState, struct _Processor* processor,
 void
 Contract::applyTo(MemoryState& memoryState, struct _Processor* processor,
       struct _ProcessorFunctions* processorFunctions) {
+   Statistics::Timer timer(Statistics::CContractApplication);
    std::vector<Contract*> hierarchy;
    Contract* current = this;
    while (current->cpDominator.isValid()) {
@@ -465,6 +476,91 @@ Contract::applyTo(MemoryState& memoryState, struct _Processor* processor,
    applyOneTo(memoryState, processor, processorFunctions);
 }
 
+const MemoryState&
+Contract::getAppliedState(int registersNumber, struct _DomainElementFunctions* domainFunctions,
+      struct _Processor* processor, struct _ProcessorFunctions* processorFunctions) {
+   if (!spAppliedState || spAppliedState->state.getDomainFunctions() != domainFunctions) {
+      spAppliedState = std::make_shared<AppliedState>(registersNumber, domainFunctions);
+      applyTo(spAppliedState->state, processor, processorFunctions);
+   }
+   return spAppliedState->state;
+}
+
+bool
+Contract::isProvenState(const std::vector<uint64_t>& fingerprint) const {
+   if (!spAppliedState || fingerprint.empty())
+      return false;
+   auto found = spAppliedState->provenStates.find(VerificationCache::hash(&fingerprint[0],
+         fingerprint.size()*sizeof(uint64_t)));
+   if (found == spAppliedState->provenStates.end())
+      return false;
+   // the hash only selects the candidates
+   for (const auto& provenState : found->second)
+      if (provenState == fingerprint)
+         return true;
+   return false;
+}
+
+void
+Contract::addProvenState(std::vector<uint64_t>&& fingerprint) {
+   AssumeCondition(spAppliedState && !fingerprint.empty())
+   spAppliedState->provenStates[VerificationCache::hash(&fingerprint[0],
+         fingerprint.size()*sizeof(uint64_t))].push_back(std::move(fingerprint));
+}
+
+// the contracts of a graph get the hash of their source text at load time
+uint64_t
+Contract::getContentHash(struct _Processor* processor,
+      struct _ProcessorFunctions* processorFunctions) const {
+   if (uContentHash == 0) {
+      std::ostringstream out;
+      STG::IOObject::OSStream stream(out);
+      STG::JSon::CommonWriter writer(*this, (WriteRuleResult*) nullptr, STG::JSon::CommonWriter::Write());
+      writer.state().getSResult((WriteRuleResult*) nullptr) = WriteRuleResult(processor, processorFunctions);
+      writer.write(stream);
+      std::string text = out.str();
+      uContentHash = VerificationCache::hash(text.data(), text.size()) | 1;
+   }
+   return uContentHash;
+}
+
+uint64_t
+Contract::getAppliedContentHash(struct _Processor* processor,
+      struct _ProcessorFunctions* processorFunctions) const {
+   uint64_t result = getContentHash(processor, processorFunctions);
+   for (const Contract* current = this; current->cpDominator.isValid(); ) {
+      current = &*current->cpDominator;
+      result = VerificationCache::hashValue(current->getContentHash(processor, processorFunctions), result);
+   }
+   return result;
+}
+
+void
+ContractGraph::setContentHashesFromFile(const char* filename) {
+   std::ifstream in(filename, std::ifstream::binary);
+   std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   std::vector<size_t> lineStarts{ 0, 0 }; // the lines of the parser start at 1
+   for (size_t index = 0; index < text.size(); ++index)
+      if (text[index] == '\n')
+         lineStarts.push_back(index+1);
+   auto offset = [&lineStarts, &text](unsigned line, unsigned column)
+      {  if (line == 0 || line >= lineStarts.size() || column == 0)
+            return std::string::npos;
+         size_t result = lineStarts[line] + column - 1;
+         return result <= text.size() ? result : std::string::npos;
+      };
+   inherited::foreachDo([&offset, &text](const ContractPointer& pointer)
+      {  if (!pointer.isValid())
+            return true;
+         Contract& contract = const_cast<Contract&>(*pointer);
+         size_t start = offset(contract.uSourceStartLine, contract.uSourceStartColumn);
+         size_t end = offset(contract.uSourceEndLine, contract.uSourceEndColumn);
+         if (start != std::string::npos && end != std::string::npos && start < end)
+            contract.uContentHash = VerificationCache::hash(text.data() + start, end - start) | 1;
+         return true;
+      });
+}
+
 STG::Lexer::Base::ReadResult
 ContractGraph::readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) {
    typedef STG::JSon::CommonParser Parser;
@@ -486,7 +582,7 @@ ContractGraph::readJSon(STG::JSon::CommonParser::State& state, STG::JSon::Common
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
    }
    ++state.point();
@@ -570,7 +666,7 @@ ContractGraph::writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::Commo
    WriteResult result = WRNeedEvent;
    enum Delimiters
       {  DBegin, DWriteContracts, DWriteContract, DAfterWriteContract, DAfterWriteContracts,
-         DEnd
+         DAllocShift, DAllocShiftValue, DEnd
       };
    Cursor* cursor = nullptr;
 
@@ -581,6 +677,8 @@ ContractGraph::writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::Commo
       DefineGoto(WriteContract)
       DefineGoto(AfterWriteContract)
       DefineGoto(AfterWriteContracts)
+      DefineGoto(AllocShift)
+      DefineGoto(AllocShiftValue)
       DefineGoto(End)
    };
 #undef DefineGoto
@@ -617,9 +715,22 @@ LAfterWriteContract:
 
 LAfterWriteContracts:
    arguments.setCloseArray();
-   ++state.point();
+   state.point() = DAllocShift;
    if (!arguments.writeEvent(result)) return result;
 
+LAllocShift:
+   if (hasAllocShift()) {
+      arguments.setAddKey(STG::SString("alloc-shift"));
+      ++state.point();
+      if (!arguments.writeEvent(result)) return result;
+LAllocShiftValue:
+      arguments.setLUIntValue(uAllocShift);
+      ++state.point();
+      if (!arguments.writeEvent(result)) return result;
+   }
+   else
+      state.point() = DEnd;
+
 LEnd:
    arguments.setCloseObject();
    arguments.reduceState(state);
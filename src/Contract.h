@@ -8,12 +8,17 @@
 #include "target_address_decoder.h"
 #include <vector>
 #include <map>
+#include <memory>
+#include <unordered_map>
+
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
 
 enum ContractLocalization
    {  CLBeforeInstruction, CLAfterInstruction, CLBetweenInstruction };
 
 typedef STG::JSon::CommonParser::Arguments::ErrorMessage Warning;
-typedef COL::TCopyCollection<COL::TList<Warning> > Warnings;
+typedef STG::JSon::CommonParser::Arguments::ErrorMessages Warnings;
 
 class ContractGraph;
 class Contract : public PNT::SharedElement, public STG::IOObject, public STG::Lexer::Base {
@@ -113,6 +118,23 @@ class Contract : public PNT::SharedElement, public STG::IOObject, public STG::Le
    MemoryZoneModifier zmZoneModifier;
    MemoryStateConstraint scMemoryConstraints; // should be true
    ContractGraph* pcgParent = nullptr;
+   // hash of the JSON text of the contract, 0 if not computed
+   mutable uint64_t uContentHash = 0;
+   /* the contract applied on an empty memory state, built once for the edges
+    * that reach it and for the ones that leave it, with the fingerprints of
+    * the states already proven to be contained in it, keyed by their hash
+    */
+   struct AppliedState {
+      MemoryState state;
+      std::unordered_map<uint64_t, std::vector<std::vector<uint64_t> > > provenStates;
+
+      AppliedState(int registersNumber, struct _DomainElementFunctions* domainFunctions)
+         :  state(registersNumber, domainFunctions) {}
+   };
+   std::shared_ptr<AppliedState> spAppliedState;
+   // localization of this text in the source file, given by the parser
+   unsigned uSourceStartLine = 0, uSourceStartColumn = 0;
+   unsigned uSourceEndLine = 0, uSourceEndColumn = 0;
 
    static bool setLocalizationFromText(ContractLocalization& localization,
          const STG::SubString& text)
@@ -139,6 +161,7 @@ class Contract : public PNT::SharedElement, public STG::IOObject, public STG::Le
       }
    void applyOneTo(MemoryState& memoryState, struct _Processor* processor,
          struct _ProcessorFunctions* processorFunctions);
+   friend class ContractGraph;
 
   public:
    Contract() = default;
@@ -167,11 +190,28 @@ class Contract : public PNT::SharedElement, public STG::IOObject, public STG::Le
                ++targets.addresses_length;
             }
       }
+   void retrieveNextAddresses(std::vector<uint64_t>& addresses)
+      {  for (EdgeContract& edgeContract : lecNexts)
+            if (edgeContract.isValid())
+               addresses.push_back(edgeContract->uAddress);
+      }
    bool isInitial() const { return lecPreviouses.isEmpty(); }
+   bool hasSeveralPreviouses() const { return lecPreviouses.count() > 1; }
    bool isFinal() const { return lecNexts.isEmpty(); }
    void applyTo(MemoryState& memoryState, struct _Processor* processor,
          struct _ProcessorFunctions* processorFunctions);
    const uint64_t& getAddress() const { return uAddress; }
+   uint64_t getContentHash(struct _Processor* processor,
+         struct _ProcessorFunctions* processorFunctions) const;
+   // content hash of the dominator chain applied by applyTo
+   uint64_t getAppliedContentHash(struct _Processor* processor,
+         struct _ProcessorFunctions* processorFunctions) const;
+   // result of applyTo on an empty memory state, computed at the first call
+   const MemoryState& getAppliedState(int registersNumber, struct _DomainElementFunctions* domainFunctions,
+         struct _Processor* processor, struct _ProcessorFunctions* processorFunctions);
+   // fingerprint of a state contained in getAppliedState (see MemoryState::retrieveFingerprint)
+   bool isProvenState(const std::vector<uint64_t>& fingerprint) const;
+   void addProvenState(std::vector<uint64_t>&& fingerprint);
 };
 
 class ContractGraph : public COL::TCopyCollection<COL::TSortedArray<Contract::ContractPointer, Contract::ContractPointer::Key> >, public STG::IOObject, public STG::Lexer::Base {
@@ -229,16 +269,20 @@ class ContractGraph : public COL::TCopyCollection<COL::TSortedArray<Contract::Co
          STG::JSon::CommonParser parser(*this, (ReadRuleResult*) nullptr, STG::JSon::CommonParser::Parse());
          parser.state().getSResult((ReadRuleResult*) nullptr) = ReadRuleResult(domainFunctions, processor, processorFunctions, idMap, pendingIds);
          parser.setPartialToken();
+         errors.setFilename(filename);
+         parser.sarguments().setErrorMessages(errors, true /* doesStopOnError */);
          parser.parse(inputFile);
-         if (parser.arguments().hasErrors()) {
-            parser.sarguments().errors().swap(errors);
+         if (parser.arguments().hasErrors())
             return false;
-         }
+         setContentHashesFromFile(filename);
          return true;
       }
-   bool saveFromFile(const char* filename)
+   void setContentHashesFromFile(const char* filename);
+   bool saveFromFile(const char* filename, struct _Processor* processor,
+         struct _ProcessorFunctions* processorFunctions)
       {  STG::DIOObject::OFStream outputFile(filename);
          STG::JSon::CommonWriter writer(*this, (WriteRuleResult*) nullptr, STG::JSon::CommonWriter::Write());
+         writer.state().getSResult((WriteRuleResult*) nullptr) = WriteRuleResult(processor, processorFunctions);
          writer.write(outputFile);
          return true;
       }
@@ -287,3 +331,6 @@ class ContractCoverage : public STG::IOObject {
    bool isComplete() const { return true; }
 
 };
+
+#include "StandardClasses/UndefineNew.h"
+#undef DefineAllocationRegion
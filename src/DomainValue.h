@@ -4,12 +4,61 @@
 #include "domsec_callback.h"
 #include "StandardClasses/Persistence.h"
 #include "TString/String.hpp"
+#include <cstdint>
 
 class MemoryState;
 class DomainValue : public STG::IOObject {
+  public:
+   /* Inline form of the constants, unsigned intervals and non-symbolic tops
+    * that the contract checker builds from their bounds, so that their
+    * containment needs no call to the domain library. The form is kept by the
+    * copies and dropped by any other modification of the value.
+    */
+   struct Bounds {
+      enum Tag { BUnknown, BInterval, BTop };
+      Tag tag = BUnknown;
+      int sizeInBits = 0;
+      uint64_t min = 0, max = 0; // min == max for a constant
+
+      static Bounds interval(int sizeInBits, uint64_t min, uint64_t max)
+         {  Bounds result;
+            // an empty interval is left to the domain
+            if (sizeInBits > 0 && sizeInBits <= 64 && min <= max) {
+               result.tag = BInterval;
+               result.sizeInBits = sizeInBits;
+               result.min = min;
+               result.max = max;
+            }
+            return result;
+         }
+      static Bounds constant(int sizeInBits, uint64_t value)
+         {  return interval(sizeInBits, value, value); }
+      static Bounds top(int sizeInBits)
+         {  Bounds result;
+            if (sizeInBits > 0 && sizeInBits <= 64) {
+               result.tag = BTop;
+               result.sizeInBits = sizeInBits;
+            }
+            return result;
+         }
+      bool isKnown() const { return tag != BUnknown; }
+      bool isFullRange() const
+         {  return min == 0 && max == (sizeInBits == 64 ? ~0ULL : ((1ULL << sizeInBits) - 1)); }
+      /* false if the containment is left to the domain library, otherwise
+       * result tells whether source is contained in this */
+      bool contain(const Bounds& source, bool& result) const
+         {  if (!isKnown() || !source.isKnown() || sizeInBits != source.sizeInBits
+                  || (source.tag == BTop && tag != BTop))
+               return false;
+            result = tag == BTop || (min <= source.min && source.max <= max);
+            return true;
+         }
+   };
+
   private:
    DomainElement deValue;
    struct _DomainElementFunctions* pfFunctions;
+   Bounds bBounds;
 
   protected:
    friend class MemoryState;
@@ -49,7 +98,8 @@ class DomainValue : public STG::IOObject {
       }
 
   public:
-   DomainElement& svalue() { return deValue; }
+   // the caller may modify the value: the bounds are dropped
+   DomainElement& svalue() { bBounds = Bounds(); return deValue; }
    const DomainElement& value() const { return deValue; }
    bool hasFunctionTable() const { return pfFunctions; }
    struct _DomainElementFunctions& functionTable() const { AssumeCondition(pfFunctions) return *pfFunctions; }
@@ -58,11 +108,15 @@ class DomainValue : public STG::IOObject {
    DomainValue(struct _DomainElementFunctions* functions) : deValue{}, pfFunctions(functions) {}
    DomainValue(DomainElement&& value, struct _DomainElementFunctions* functions)
       :  deValue(std::move(value)), pfFunctions(functions) {}
+   DomainValue(DomainElement&& value, struct _DomainElementFunctions* functions,
+         const Bounds& bounds)
+      :  deValue(std::move(value)), pfFunctions(functions), bBounds(bounds) {}
    DomainValue(DomainValue&& source)
-      :  deValue(source.deValue), pfFunctions(source.pfFunctions)
+      :  deValue(source.deValue), pfFunctions(source.pfFunctions), bBounds(source.bBounds)
       {  source.deValue.content = nullptr; }
    DomainValue(const DomainValue& source)
-      :  STG::IOObject(source), deValue{ nullptr }, pfFunctions(source.pfFunctions)
+      :  STG::IOObject(source), deValue{ nullptr }, pfFunctions(source.pfFunctions),
+         bBounds(source.bBounds)
       {  if (source.deValue.content) {
             AssumeCondition(pfFunctions)
             deValue = (*pfFunctions->clone)(source.deValue);
@@ -78,6 +132,7 @@ class DomainValue : public STG::IOObject {
          }
          pfFunctions = source.pfFunctions;
          deValue = source.deValue;
+         bBounds = source.bBounds;
          source.deValue.content = nullptr;
          return *this;
       }
@@ -87,6 +142,7 @@ class DomainValue : public STG::IOObject {
          if (deValue.content)
             (*pfFunctions->free)(&deValue);
          pfFunctions = source.pfFunctions;
+         bBounds = source.bBounds;
          if (source.deValue.content)
          {
             AssumeCondition(pfFunctions)
@@ -100,20 +156,29 @@ class DomainValue : public STG::IOObject {
    DDefineAssign(DomainValue)
 
    void mergeWith(DomainValue& source, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->merge)(&deValue, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->merge)(&deValue, source.deValue, &env);
          AssumeCondition(result)
       }
    bool isTop() const
-      {  return (*pfFunctions->is_top)(deValue); }
+      {  if (bBounds.tag == Bounds::BTop)
+            return true;
+         if (bBounds.tag == Bounds::BInterval && !bBounds.isFullRange())
+            return false;
+         return (*pfFunctions->is_top)(deValue);
+      }
+   const Bounds& getBounds() const { return bBounds; }
    bool contain(const DomainValue& source, DomainEvaluationEnvironment& env) const
       {  return (*pfFunctions->contain)(deValue, source.deValue, &env); }
    void applyAssign(DomainBitUnaryOperation operation, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->bit_unary_apply_assign)(&deValue, operation, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->bit_unary_apply_assign)(&deValue, operation, &env);
          AssumeCondition(result)
       }
    void applyAssign(DomainBitBinaryOperation operation, const DomainValue& source,
          DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->bit_binary_apply_assign)(&deValue, operation, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->bit_binary_apply_assign)(&deValue, operation, source.deValue, &env);
          AssumeCondition(result)
       }
    DomainValue applyCompare(DomainBitCompareOperation operation, const DomainValue& source,
@@ -127,25 +192,30 @@ class DomainValue : public STG::IOObject {
       }
 
    void applyAssign(DomainMultiBitUnaryOperation operation, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multibit_unary_apply_assign)(&deValue, operation, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multibit_unary_apply_assign)(&deValue, operation, &env);
          AssumeCondition(result)
       }
    void applyAssign(DomainMultiBitExtendOperation operation, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multibit_extend_apply_assign)(&deValue, operation, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multibit_extend_apply_assign)(&deValue, operation, &env);
          AssumeCondition(result)
       }
    void applyAssign(DomainMultiBitReduceOperation operation, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multibit_reduce_apply_assign)(&deValue, operation, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multibit_reduce_apply_assign)(&deValue, operation, &env);
          AssumeCondition(result)
       }
    void applyAssign(DomainMultiBitBinaryOperation operation, const DomainValue& source,
          DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multibit_binary_apply_assign)(&deValue, operation, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multibit_binary_apply_assign)(&deValue, operation, source.deValue, &env);
          AssumeCondition(result)
       }
    void applyAssign(DomainMultiBitSetOperation operation, const DomainValue& source,
          DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multibit_bitset_apply_assign)(&deValue, operation, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multibit_bitset_apply_assign)(&deValue, operation, source.deValue, &env);
          AssumeCondition(result)
       }
    DomainValue applyCompare(DomainMultiBitCompareOperation operation, const DomainValue& source,
@@ -178,12 +248,14 @@ class DomainValue : public STG::IOObject {
       }
 
    void applyAssign(DomainMultiFloatUnaryOperation operation, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multifloat_unary_apply_assign)(&deValue, operation, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multifloat_unary_apply_assign)(&deValue, operation, &env);
          AssumeCondition(result)
       }
    void applyAssign(DomainMultiFloatBinaryOperation operation, const DomainValue& source,
          DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multifloat_binary_apply_assign)(&deValue, operation, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multifloat_binary_apply_assign)(&deValue, operation, source.deValue, &env);
          AssumeCondition(result)
       }
    DomainValue applyCompare(DomainMultiFloatCompareOperation operation, const DomainValue& source,
@@ -196,22 +268,26 @@ class DomainValue : public STG::IOObject {
             (deValue, sizeInBits, &env), pfFunctions);
       }
    void applyFloatingToFloating(int sizeInBits, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->multifloat_cast_multifloat_assign)
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->multifloat_cast_multifloat_assign)
                (&deValue, sizeInBits, &env);
          AssumeCondition(result)
       }
 
    void mergeWith(const DomainValue& source, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->merge)(&deValue, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->merge)(&deValue, source.deValue, &env);
          AssumeCondition(result)
       }
    void intersectWith(const DomainValue& source, DomainEvaluationEnvironment& env)
-      {  bool result = (*pfFunctions->intersect)(&deValue, source.deValue, &env);
+      {  bBounds = Bounds();
+         bool result = (*pfFunctions->intersect)(&deValue, source.deValue, &env);
          AssumeCondition(result)
       }
 
    void clear()
-      {  if (deValue.content)
+      {  bBounds = Bounds();
+         if (deValue.content)
          {  AssumeCondition(pfFunctions)
             (*pfFunctions->free)(&deValue);
          }
@@ -232,6 +308,7 @@ class DomainValue : public STG::IOObject {
    DomainElement extractElement()
       {  auto res = deValue;
          deValue = DomainElement{};
+         bBounds = Bounds();
          return res;
       }
 };
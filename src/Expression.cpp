@@ -4,6 +4,9 @@
 #include "Numerics/Integer.h"
 #include "Numerics/HostFloating.h"
 
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
+
 const char* debugPrint(STG::IOObject* object) {
    static STG::SString result;
    result.clear();
@@ -30,7 +33,9 @@ VirtualExpressionNode::setArgumentFromText(PNT::TMngPointer<VirtualExpressionNod
       argument.absorbElement(new DomainNode(functions));
    else if (text == "operation")
       argument.absorbElement(new OperationNode);
-   else if (!context.addErrorMessage(STG::SString("unknown type for expression")))
+   else if (text == "let")
+      argument.absorbElement(new LetAccessNode);
+   else if (!context.addErrorMessage("unknown type for expression"))
       return false;
    return true;
 }
@@ -43,6 +48,7 @@ VirtualExpressionNode::getTextFromArgument(VirtualExpressionNode& argument) {
       case TEIndirection: return STG::SString("indirect");
       case TEDomain: return STG::SString("domain");
       case TEOperation: return STG::SString("operation");
+      case TELetAccess: return STG::SString("let");
    };
    return STG::SString();
 }
@@ -54,7 +60,6 @@ RegisterAccessNode::readJSon(STG::JSon::CommonParser::State& state,
       STG::JSon::CommonParser::Arguments& arguments) {
    typedef STG::JSon::CommonParser Parser;
    ReadResult result = RRContinue;
-   bool isEqual;
 
    enum Delimiters
       {  DBegin, DAfterBegin, DReadContent, DEnd };
@@ -70,7 +75,7 @@ RegisterAccessNode::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
       arguments.reduceState(state);
       return RRHasToken;
@@ -86,7 +91,7 @@ LAfterBegin:
       };
 
       if (arguments.isAddKey()
-            && ((result = arguments.isEqualKeyValue(isEqual, ssJSonContent)), isEqual)) {
+            && ((result = arguments.setArgumentKey()), arguments.key() == ssJSonContent)) {
          if (result == RRNeedChars) return result;
          ++state.point();
          if (!arguments.setToNextToken(result)) return result;
@@ -94,9 +99,11 @@ LAfterBegin:
 LReadContent:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssRegisterName = arguments.valueAsText();
+            atRegisterName = arguments.valueAsText();
          };
       }
+      else if (result == RRNeedChars)
+         return result;
       state.point() = DAfterBegin;
       if (!arguments.setToNextToken(result)) return result;
    }
@@ -135,7 +142,7 @@ LAfterBegin:
    if (!arguments.writeEvent(result)) return result;
 
 LWriteContent:
-   arguments.setStringValue(ssRegisterName);
+   arguments.setStringValue(atRegisterName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -175,7 +182,7 @@ IndirectionNode::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
       arguments.reduceState(state);
       return RRHasToken;
@@ -638,7 +645,7 @@ class DomainNode::Lexer : public STG::Lexer::Base {
          tToken = AbstractToken();
       }
 
-   bool addErrorMessage(const STG::SubString& message, unsigned pos)
+   bool addErrorMessage(const char* message, unsigned pos)
       {  unsigned column = jpaErrorList.getColumn();
          jpaErrorList.setColumn(column+pos);
          bool result = jpaErrorList.addErrorMessage(message);
@@ -782,13 +789,17 @@ DomainNode::Lexer::readMain(STG::SubString& in, unsigned& apos) {
       return RRHasToken;
    };
    apos += pos;
-   if (!addErrorMessage(STG::SString("unknown character"), apos))
+   if (!addErrorMessage("unknown character", apos))
       return RRFinished;
    return RRContinue;
 }
 
 namespace Details {
 
+inline uint64_t adjustToBitSize(uint64_t value, int sizeInBits) {
+   return (sizeInBits < 64) ? (value & ~(~(uint64_t) 0 << sizeInBits)) : value;
+}
+
 inline bool isCharDigit(char ch, int context) {
    return (context == 0)
       ? STG::SubString::Traits::isdigit(ch) : ((context == 1)
@@ -905,7 +916,7 @@ DomainNode::Lexer::readNumberToken(STG::SubString& in, unsigned& apos, NumberTok
    in.advance(pos);
    apos += pos;
    if (hasExtensionIssue)
-      if (!addErrorMessage(STG::SString("bad extension for number"), apos)) return RRFinished;
+      if (!addErrorMessage("bad extension for number", apos)) return RRFinished;
    return RRHasToken;
 }
 
@@ -1032,7 +1043,7 @@ class DomainNode::Parser : public STG::Lexer::Base {
          }
 
       DomainEvaluationEnvironment& evaluationEnvironment() { return deeEvaluationEnvironment; }
-      bool addErrorMessage(const STG::SubString& message)
+      bool addErrorMessage(const char* message)
          {  return lLexer.addErrorMessage(message, uPos); }
       bool setToNextToken(ReadResult& result)
          {  bool booleanResult = false;
@@ -1421,8 +1432,8 @@ DomainNode::OperatorStack::applyInterval(Operator& operation, Parser<char>::Argu
    DomainValue firstArgument = operation.extractFirstArgument();
    auto type = firstArgument.getType();
    if (secondArgument.getType() != type) {
-      context.addErrorMessage(STG::SString(
-         "interval has incompatible types for elements"));
+      context.addErrorMessage(
+         "interval has incompatible types for elements");
       return firstArgument;
    };
    if (type == DTInteger) {
@@ -1476,13 +1487,13 @@ DomainNode::OperatorStack::apply(Operator& operation, Parser<char>::Arguments& c
                   boolResult = (*argument.functionTable().multifloat_unary_apply_assign)
                      (&argument.svalue(), DMFUOOpposite, &context.evaluationEnvironment());
                else
-                  context.addErrorMessage(STG::SString(
-                     "unsupported type for the unary - operation"));
+                  context.addErrorMessage(
+                     "unsupported type for the unary - operation");
                AssumeCondition(boolResult)
             }
             return argument;
          default:
-            context.addErrorMessage(STG::SString("unknown unary operation type"));
+            context.addErrorMessage("unknown unary operation type");
             return argument;
       };
    }
@@ -1491,7 +1502,7 @@ DomainNode::OperatorStack::apply(Operator& operation, Parser<char>::Arguments& c
       DomainValue firstArgument = operation.extractFirstArgument();
       auto argumentType = firstArgument.getType();
       if (argumentType != secondArgument.getType()) {
-         context.addErrorMessage(STG::SString("arguments have incompatible types"));
+         context.addErrorMessage("arguments have incompatible types");
          return firstArgument;
       };
 
@@ -1504,7 +1515,7 @@ DomainNode::OperatorStack::apply(Operator& operation, Parser<char>::Arguments& c
                      secondArgument.svalue(), &context.evaluationEnvironment());
                return firstArgument;
             default:
-               context.addErrorMessage(STG::SString("unknown binary operation type for multibit"));
+               context.addErrorMessage("unknown binary operation type for multibit");
                return firstArgument;
          };
          context.clearEvaluationEnvironment();
@@ -1521,7 +1532,7 @@ DomainNode::OperatorStack::apply(Operator& operation, Parser<char>::Arguments& c
                      secondArgument.svalue(), &context.evaluationEnvironment());
                return firstArgument;
             default:
-               context.addErrorMessage(STG::SString("unknown binary operation type for bit"));
+               context.addErrorMessage("unknown binary operation type for bit");
                return firstArgument;
          };
          context.clearEvaluationEnvironment();
@@ -1539,7 +1550,7 @@ DomainNode::OperatorStack::apply(Operator& operation, Parser<char>::Arguments& c
                      secondArgument.svalue(), &context.evaluationEnvironment());
                return firstArgument;
             default:
-               context.addErrorMessage(STG::SString("unsupported binary operation for floating point type"));
+               context.addErrorMessage("unsupported binary operation for floating point type");
                return firstArgument;
          };
          context.clearEvaluationEnvironment();
@@ -1614,7 +1625,7 @@ DomainNode::OperatorStack::clear(Parser<char>::Arguments& context,
          operation->absorbLastArgument(std::move(result));
 
       if (!operation->isFinished()) {
-         context.addErrorMessage(STG::SString("unexpected end of expression"));
+         context.addErrorMessage("unexpected end of expression");
          return DomainValue(functions);
       };
       result = apply(*operation, context);
@@ -1632,53 +1643,63 @@ DomainNode::convertTokenToValue(const NumberToken& token,
    DomainValue element(&deValue.functionTable());
    doesRetry = false;
    if (token.isIntegerOrBit()) {
-      Numerics::BigInteger val;
-      STG::DIOObject::ISSubString in(token.getContent());
       Numerics::BigInteger::FormatParameters format;
       format.setText();
       if (token.hasSpecialCoding()) {
          if (token.hasHexaDecimalCoding())
             format.setText().setHexaDecimal();
          else if (token.hasOctalCoding()) {
-            if (!arguments.addErrorMessage(STG::SString(
-                  "unsupported octal coding for number in expression")))
+            if (!arguments.addErrorMessage(
+                  "unsupported octal coding for number in expression"))
                doesRetry = true;
             return DomainValue(&deValue.functionTable());
             // format.setText().setOctal();
          }
          else if (token.hasBitCoding()) {
-            if (!arguments.addErrorMessage(STG::SString(
-                  "unsupported bit coding for number in expression")))
+            if (!arguments.addErrorMessage(
+                  "unsupported bit coding for number in expression"))
                doesRetry = true;
             return DomainValue(&deValue.functionTable());
             // format.setText().setBitCoding();
          };
       };
-      val.read(in, format);
+      uint64_t value = 0;
+      bool isZero;
+      auto chunk = token.getContent().getChunk();
+      if ((int) chunk.length == token.getContent().length()
+            && Numerics::BigInteger::readSmallValue(chunk.string, chunk.length, format, value))
+         isZero = (value == 0);
+      else {
+         Numerics::BigInteger val;
+         STG::DIOObject::ISSubString in(token.getContent());
+         val.read(in, format);
+         isZero = val.isZero();
+         value = val.carray(0) | ((uint64_t) val.carray(1) << 32);
+      };
       if (token.hasBitExtension())
          element = DomainValue((*deValue.functionTable().bit_create_constant)
-               (!val.isZero()), &deValue.functionTable());
-      else {
-         val.adjustBitSize(token.getSize());
+               (!isZero), &deValue.functionTable());
+      else
          element = DomainValue((*deValue.functionTable().multibit_create_constant)
-               (DomainIntegerConstant{ token.getSize(), false, val[0]}), &deValue.functionTable());
-      };
+               (DomainIntegerConstant{ token.getSize(), false,
+                  Details::adjustToBitSize(value, token.getSize()) }), &deValue.functionTable(),
+               DomainValue::Bounds::constant(token.getSize(), Details::adjustToBitSize(value, token.getSize())));
    }
    else {
       AssumeCondition(token.isFloatingPoint())
       int sizeExponent = token.getFirstSize();
       int sizeMantissa = token.getSecondSize();
       if (sizeExponent == 0 || sizeMantissa == 0) {
-         if (!arguments.addErrorMessage(STG::SString(
-               "exponent and mantissa should have a positive size in floating point number")))
+         if (!arguments.addErrorMessage(
+               "exponent and mantissa should have a positive size in floating point number"))
             doesRetry = true;
          return DomainValue(&deValue.functionTable());
       };
       Numerics::DDouble::Access::ReadParameters format;
       format.setText();
       if (token.hasSpecialCoding()) {
-         if (!arguments.addErrorMessage(STG::SString(
-               "unsupported special coding for floating number in expression")))
+         if (!arguments.addErrorMessage(
+               "unsupported special coding for floating number in expression"))
             doesRetry = true;
          return DomainValue(&deValue.functionTable());
          // if (token.hasHexaDecimalCoding())
@@ -1707,8 +1728,8 @@ DomainNode::convertTokenToValue(const IdentifierTokenResult& token,
       case KeywordToken::TTop:
       case KeywordToken::TTopSymbolic:
          if (token.choice <= IdentifierTokenResult::CKeyword) {
-            if (!arguments.addErrorMessage(STG::SString(
-                  "the top keyword should have a size")))
+            if (!arguments.addErrorMessage(
+                  "the top keyword should have a size"))
                doesRetry = true;
             return DomainValue(&deValue.functionTable());
          };
@@ -1730,8 +1751,8 @@ DomainNode::convertTokenToValue(const IdentifierTokenResult& token,
       default:
          break;
    };
-   if (!arguments.addErrorMessage(STG::SString(
-         "keyword encountered where an expression was expected")))
+   if (!arguments.addErrorMessage(
+         "keyword encountered where an expression was expected"))
       doesRetry = true;
    return DomainValue(&deValue.functionTable());
 }
@@ -1766,8 +1787,8 @@ template <typename T> void
 DomainNode::convertTokenToError(const IdentifierTokenResult& token,
       typename Parser<T>::Arguments& arguments, bool& doesRetry) {
    doesRetry = false;
-   if (!arguments.addErrorMessage(STG::SString(
-         "keyword encountered where an expression was expected")))
+   if (!arguments.addErrorMessage(
+         "keyword encountered where an expression was expected"))
       doesRetry = true;
 }
 
@@ -1849,8 +1870,8 @@ LParen: // DParen, DParenStack
       }
    }
    if (hasFailed) {
-      if (!arguments.addErrorMessage(STG::SString(
-            "')' was expected during the parsing of a subexpression"))) return false;
+      if (!arguments.addErrorMessage(
+            "')' was expected during the parsing of a subexpression")) return false;
       state.point() = DEndParen;
       if (!arguments.setToNextToken(result)) return result;
 LEndParen:
@@ -1950,8 +1971,8 @@ LInterval:
             return false;
          }
       }
-      if (!arguments.addErrorMessage(STG::SString(
-         "',]' was expected during the parsing of an interval"))) return false;
+      if (!arguments.addErrorMessage(
+         "',]' was expected during the parsing of an interval")) return false;
       ++state.point();
       if (!arguments.setToNextToken(result)) return false;
 LEndBracket:
@@ -2038,8 +2059,8 @@ LSet:
       if (token.getType() == AbstractToken::TOperatorPunctuator) {
          auto type = ((const OperatorPunctuatorToken&) token).getType();
          if (type == OperatorPunctuatorToken::TCloseBrace) {
-            if (!arguments.addErrorMessage(STG::SString(
-               "empty set is not allowed"))) return false;
+            if (!arguments.addErrorMessage(
+               "empty set is not allowed")) return false;
             state.point() -= DSet - DBegin;
             return true;
          };
@@ -2101,8 +2122,8 @@ LFirstSetElement:
       };
    };
    if (hasFailed) {
-      if (!arguments.addErrorMessage(STG::SString(
-            "'}' was expected during the parsing of a set"))) return false;
+      if (!arguments.addErrorMessage(
+            "'}' was expected during the parsing of a set")) return false;
       state.point() = DEndSet;
       if (!arguments.setToNextToken(result)) return result;
 LEndSet:
@@ -2160,8 +2181,8 @@ LSetElement:
             }
          };
          if (hasFailed) {
-            if (!arguments.addErrorMessage(STG::SString(
-                  "'}' was expected during the parsing of a set"))) return false;
+            if (!arguments.addErrorMessage(
+                  "'}' was expected during the parsing of a set")) return false;
             state.point() = DEndSet;
             if (!arguments.setToNextToken(result)) return result;
             state.point() -= (DSetElement - DFirstSetElement);
@@ -2259,8 +2280,8 @@ LBegin: // DBegin, DBeginStack
             }
             else if (arguments.getIdentifierResult().isQualifier()) {
                if (state.point() == DBegin) {
-                  if (!arguments.addErrorMessage(STG::SString(
-                        "keyword '..._U/S' encountered where an expression was expected"))) return RRContinue;
+                  if (!arguments.addErrorMessage(
+                        "keyword '..._U/S' encountered where an expression was expected")) return RRContinue;
                   arguments.reduceState(state);
                   return RRHasToken;
                }
@@ -2304,8 +2325,8 @@ LSet: LFirstSetElement: LSetElement: LEndSet: LAfterSet:
                   };
                   continue;
                default:
-                  if (!arguments.addErrorMessage(STG::SString(
-                        "operator/punctuator encountered where an expression was expected"))) return RRContinue;
+                  if (!arguments.addErrorMessage(
+                        "operator/punctuator encountered where an expression was expected")) return RRContinue;
                   arguments.reduceState(state);
                   return RRHasToken;
             };
@@ -2366,11 +2387,176 @@ LAfterPrimary: // DAfterPrimary, DAfterPrimaryStack
    return RRHasToken;
 }
 
+namespace Details {
+
+class FastValueReader {
+  private:
+   typedef STG::SubString::Traits Traits;
+   const char* szText;
+   const char* szEnd;
+
+  public:
+   FastValueReader(const char* text, size_t length) : szText(text), szEnd(text+length) {}
+
+   bool isFinished() const { return szText == szEnd; }
+   bool isChar(char ch) const { return szText != szEnd && *szText == ch; }
+   bool isPrefix(char first, char second) const
+      {  return szText != szEnd && *szText == first
+            && szText+1 != szEnd && szText[1] == second;
+      }
+   void skipSpaces()
+      {  while (szText != szEnd && Traits::isspace(*szText))
+            ++szText;
+      }
+   bool skipChar(char ch)
+      {  if (!isChar(ch))
+            return false;
+         ++szText;
+         return true;
+      }
+   bool skipPrefix(char first, char second)
+      {  if (!isPrefix(first, second))
+            return false;
+         szText += 2;
+         return true;
+      }
+
+   bool readSize(int& size)
+      {  if (!isChar('_') || szText+1 == szEnd || !Traits::isdigit(szText[1]))
+            return false;
+         ++szText;
+         size = 0;
+         do {
+            size = size*10 + (*szText - '0');
+            if (size > (1 << 16))
+               return false;
+            ++szText;
+         } while (szText != szEnd && Traits::isdigit(*szText));
+         return size > 0;
+      }
+   bool readSizedInteger(DomainIntegerConstant& result);
+};
+
+bool
+FastValueReader::readSizedInteger(DomainIntegerConstant& result) {
+   if (szText == szEnd || !Traits::isdigit(*szText))
+      return false;
+   Numerics::BigInteger::FormatParameters format;
+   format.setText();
+   if (isPrefix('0', 'x') || isPrefix('0', 'X')) {
+      szText += 2;
+      format.setHexaDecimal();
+   }
+   else if (*szText == '0' && szText+1 != szEnd && Traits::isdigit(szText[1]))
+      return false; // octal coding is reported by the general parser
+   const char* start = szText;
+   while (szText != szEnd && (format.isHexaDecimal()
+         ? Traits::ishexadigit(*szText) : Traits::isdigit(*szText)))
+      ++szText;
+   uint64_t value = 0;
+   if (!Numerics::BigInteger::readSmallValue(start, szText - start, format, value)
+         || !readSize(result.sizeInBits))
+      return false;
+   result.isSigned = false;
+   result.integerValue = adjustToBitSize(value, result.sizeInBits);
+   return true;
+}
+
+}
+
+/* Recognizes without any allocation the most frequent values of the contracts:
+ *   sized integers like 21_32 or 0x8bf4_32,
+ *   intervals like [21_32, 500_32]S_32 with an optional S, U and _s qualification,
+ *   top values like T_32, T_s_32 and Tb.
+ * The other forms (disjunctions, floating point values, expressions) return false
+ * and are left to DomainNode::Parser.
+ */
+bool
+DomainNode::readFastValue(const STG::SubString& text) {
+   auto chunk = text.getChunk();
+   if ((int) chunk.length != text.length())
+      return false;
+   Details::FastValueReader in(chunk.string, chunk.length);
+   auto& functions = deValue.functionTable();
+   in.skipSpaces();
+   if (in.skipChar('T')) {
+      if (in.skipChar('b')) {
+         bool isSymbolic = in.skipPrefix('_', 's');
+         in.skipSpaces();
+         if (!in.isFinished())
+            return false;
+         deValue = DomainValue((*functions.bit_create_top)(isSymbolic), &functions);
+         return true;
+      };
+      bool isSymbolic = in.skipPrefix('_', 's');
+      int size = 0;
+      if (!in.readSize(size))
+         return false;
+      in.skipSpaces();
+      if (!in.isFinished())
+         return false;
+      deValue = DomainValue((*functions.multibit_create_top)(size, isSymbolic), &functions,
+            isSymbolic ? DomainValue::Bounds() : DomainValue::Bounds::top(size));
+      return true;
+   };
+   if (in.skipChar('[')) {
+      DomainIntegerConstant min, max;
+      in.skipSpaces();
+      if (!in.readSizedInteger(min))
+         return false;
+      in.skipSpaces();
+      if (!in.skipChar(','))
+         return false;
+      in.skipSpaces();
+      if (!in.readSizedInteger(max))
+         return false;
+      in.skipSpaces();
+      if (!in.skipChar(']'))
+         return false;
+      in.skipSpaces();
+      bool isSigned = false, hasQualification = false;
+      if (in.isChar('S') || in.isChar('U')) {
+         isSigned = in.skipChar('S');
+         if (!isSigned)
+            in.skipChar('U');
+         hasQualification = true;
+      };
+      bool isSymbolic = in.skipPrefix('_', 's');
+      if (hasQualification || isSymbolic) {
+         int size = 0;
+         if (in.isChar('_') && !in.readSize(size))
+            return false;
+      };
+      in.skipSpaces();
+      if (!in.isFinished())
+         return false;
+      DomainElement first = (*functions.multibit_create_constant)(min);
+      DomainElement second = (*functions.multibit_create_constant)(max);
+      // the signed intervals with non-negative bounds are also unsigned intervals
+      bool hasBounds = !isSymbolic && min.sizeInBits == max.sizeInBits && min.sizeInBits <= 64
+         && (!isSigned || (min.sizeInBits > 0
+               && ((min.integerValue | max.integerValue) >> (min.sizeInBits-1)) == 0));
+      deValue = DomainValue((*functions.multibit_create_interval_and_absorb)(
+            &first, &second, isSigned, isSymbolic), &functions,
+            hasBounds ? DomainValue::Bounds::interval(min.sizeInBits, min.integerValue, max.integerValue)
+               : DomainValue::Bounds());
+      return true;
+   };
+   DomainIntegerConstant value;
+   if (!in.readSizedInteger(value))
+      return false;
+   in.skipSpaces();
+   if (!in.isFinished())
+      return false;
+   deValue = DomainValue((*functions.multibit_create_constant)(value), &functions,
+         DomainValue::Bounds::constant(value.sizeInBits, value.integerValue));
+   return true;
+}
+
 DomainNode::ReadResult
 DomainNode::readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) {
    typedef STG::JSon::CommonParser Parser;
    ReadResult result = RRContinue;
-   bool isEqual = false;
 
    enum Delimiters
       {  DBegin, DAfterBegin, DReadContent, DEnd };
@@ -2386,7 +2572,7 @@ DomainNode::readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonPar
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
       arguments.reduceState(state);
       return RRHasToken;
@@ -2402,7 +2588,7 @@ LAfterBegin:
       };
 
       if (arguments.isAddKey()
-            && ((result = arguments.isEqualKeyValue(isEqual, ssJSonContent)), isEqual)) {
+            && ((result = arguments.setArgumentKey()), arguments.key() == ssJSonContent)) {
          if (result == RRNeedChars) return result;
          ++state.point();
          if (!arguments.setToNextToken(result)) return result;
@@ -2410,13 +2596,17 @@ LAfterBegin:
 LReadContent:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            DomainNode::Parser<char> parser(*this, arguments);
-            parser.state().shift(*this, &DomainNode::readToken<char>,
-                  (DomainNode::Parser<char>::State::UnionResult<DomainNode, OperatorStack>*) nullptr);
-            parser.parse(arguments.valueAsText());
+            if (!readFastValue(arguments.valueAsText())) {
+               DomainNode::Parser<char> parser(*this, arguments);
+               parser.state().shift(*this, &DomainNode::readToken<char>,
+                     (DomainNode::Parser<char>::State::UnionResult<DomainNode, OperatorStack>*) nullptr);
+               parser.parse(arguments.valueAsText());
+            };
             arguments.valueAsText().setToSupport();
          };
       }
+      else if (result == RRNeedChars)
+         return result;
       state.point() = DAfterBegin;
       if (!arguments.setToNextToken(result)) return result;
    }
@@ -2483,7 +2673,7 @@ OperationNode::setCodeFromText(const STG::SubString& text,
    typedef COL::TCopyCollection<COL::TTernaryTree<STG::SubString, BoxedUnsigned> > CodeCollection;
    static CodeCollection ccCodes;
    if (!mpFirst.isValid()) {
-      if (!arguments.addErrorMessage(STG::SString("operation requires at lease a \"first\" argument")))
+      if (!arguments.addErrorMessage("operation requires at lease a \"first\" argument"))
          return false;
       return true;
    }
@@ -2638,7 +2828,7 @@ OperationNode::setCodeFromText(const STG::SubString& text,
                break;
          }
          if (!result) {
-            if (!arguments.addErrorMessage(STG::SString("operation not in adequation with the types of operands")))
+            if (!arguments.addErrorMessage("operation not in adequation with the types of operands"))
                return false;
          }
          uOperationCode = (result << FType);
@@ -2649,7 +2839,7 @@ OperationNode::setCodeFromText(const STG::SubString& text,
          fSymbolic = (code >> FSymbolic);
       }
    }
-   if (!uOperationCode && !arguments.addErrorMessage(STG::SString("unknown operation")))
+   if (!uOperationCode && !arguments.addErrorMessage("unknown operation"))
       return false;
    return true;
 }
@@ -2690,7 +2880,7 @@ OperationNode::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
       arguments.reduceState(state);
       return RRHasToken;
@@ -2722,7 +2912,7 @@ LReadType:
                dtType = DTFloating;
             else {
                state.point() = DAfterBegin;
-               if (!arguments.addErrorMessage(STG::SString("unknown type")))
+               if (!arguments.addErrorMessage("unknown type"))
                   return result;
             }
          };
@@ -2889,7 +3079,7 @@ LReadCode:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
             if (dtType == DTUndefined) {
-               if (!arguments.addErrorMessage(STG::SString("type should be set before reading the code"))) {
+               if (!arguments.addErrorMessage("type should be set before reading the code")) {
                   state.point() = DAfterBegin;
                   if (!arguments.setToNextToken(result)) return result;
                   return RRContinue;
@@ -2982,7 +3172,7 @@ LReadSigned:
 LEnd:
    arguments.reduceState(state);
    if (!isValid()) {
-      if (!arguments.addErrorMessage(STG::SString("inconsistent operation")))
+      if (!arguments.addErrorMessage("inconsistent operation"))
          return RRContinue;
    }
    return RRHasToken;
@@ -3289,8 +3479,8 @@ OperationNode::writeJSon(STG::JSon::CommonWriter::State& state,
    WriteResult result = WRNeedEvent;
    enum Delimiters
       {  DBegin, DAfterBegin, DWriteType,
-         DWriteFirst, DWriteFirstKey, DWriteFirstType, DIdentifyFirstType, DWriteFirstContent, DCloseFirst,
-         DWriteSecond, DWriteSecondKey, DWriteSecondType, DIdentifySecondType, DWriteSecondContent, DCloseSecond,
+         DWriteFirstKey, DWriteFirst, DWriteFirstType, DIdentifyFirstType, DWriteFirstContent, DCloseFirst,
+         DWriteSecondKey, DWriteSecond, DWriteSecondType, DIdentifySecondType, DWriteSecondContent, DCloseSecond,
          DWriteCode, DWriteCodeContent, DWriteSize, DWriteSizeContent, DWriteStart,
          DWriteStartContent, DWriteSigned, DWriteSignedContent, DEnd
       };
@@ -3726,12 +3916,12 @@ Expression::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
       arguments.reduceState(state);
       return RRHasToken;
    }
-   ++state.point();
+   state.point() = DReadContent;
    if (!arguments.setToNextToken(result)) return result;
 
 LReadContent:
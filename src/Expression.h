@@ -5,6 +5,11 @@
 #include "Dll/dll.h"
 #include "decsec_callback.h"
 #include "DomainValue.h"
+#include "Atom.h"
+#include <vector>
+
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
 
 const char* debugPrint(STG::IOObject* object);
 
@@ -12,7 +17,7 @@ class Expression;
 class VirtualExpressionNode : public PNT::MngElement, public STG::IOObject, public STG::Lexer::Base {
   public:
    typedef struct _DomainElementFunctions* RuleResult;
-   enum TypeExpression { TERegisterAccess, TEIndirection, TEDomain, TEOperation };
+   enum TypeExpression { TERegisterAccess, TEIndirection, TEDomain, TEOperation, TELetAccess };
 
   protected:
    virtual ComparisonResult _compare(const EnhancedObject& asource) const override
@@ -42,20 +47,22 @@ class VirtualExpressionNode : public PNT::MngElement, public STG::IOObject, publ
    virtual bool isValid() const override { return PNT::MngElement::isValid(); }
    virtual DomainType getType() const { return DTUndefined; }
    virtual TypeExpression getTypeExpression() const { AssumeUncalled return TERegisterAccess; }
+   // false if a let variable is not in letNames, the definitions of the contract
+   virtual bool setLetSlots(const std::vector<Atom>& letNames) { return true; }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) { AssumeUncalled return RRContinue; }
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const { AssumeUncalled return WRNeedEvent; }
 };
 
 class RegisterAccessNode : public VirtualExpressionNode {
   private:
-   STG::SubString ssRegisterName = STG::SString();
+   Atom atRegisterName;
 
   protected:
    virtual ComparisonResult _compare(const EnhancedObject& asource) const override
       {  ComparisonResult result = VirtualExpressionNode::_compare(asource);
          if (result == CREqual) {
             const auto& source = static_cast<const RegisterAccessNode&>(castFromCopyHandler(asource));
-            result = ssRegisterName.compare(source.ssRegisterName);
+            result = atRegisterName.compare(source.atRegisterName);
          }
          return result;
       }
@@ -65,13 +72,45 @@ class RegisterAccessNode : public VirtualExpressionNode {
    RegisterAccessNode(const RegisterAccessNode&) = default;
    DefineCopy(RegisterAccessNode)
 
-   const STG::SubString& getName() const { return ssRegisterName; }
+   const STG::SubString& getName() const { return atRegisterName.getName(); }
+   const Atom& getAtom() const { return atRegisterName; }
    virtual DomainType getType() const override { return DTInteger; }
    virtual TypeExpression getTypeExpression() const override { return TERegisterAccess; }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) override;
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const override;
 };
 
+/* Reference to a let variable of the contract. The JSON format is the one of
+ * RegisterAccessNode; the name is replaced by the index of the definition
+ * (its slot) once the constraints of the contract are read.
+ */
+class LetAccessNode : public RegisterAccessNode {
+  private:
+   int uSlot = -1;
+
+  protected:
+   virtual ComparisonResult _compare(const EnhancedObject& asource) const override
+      {  const auto& source = static_cast<const VirtualExpressionNode&>(castFromCopyHandler(asource));
+         ComparisonResult result = fcompare(getTypeExpression(), source.getTypeExpression());
+         return (result == CREqual) ? RegisterAccessNode::_compare(asource) : result;
+      }
+
+  public:
+   LetAccessNode() = default;
+   LetAccessNode(const LetAccessNode&) = default;
+   DefineCopy(LetAccessNode)
+
+   int getSlot() const { return uSlot; }
+   virtual TypeExpression getTypeExpression() const override { return TELetAccess; }
+   virtual bool setLetSlots(const std::vector<Atom>& letNames) override
+      {  for (uSlot = 0; uSlot < (int) letNames.size(); ++uSlot)
+            if (letNames[uSlot] == getAtom())
+               return true;
+         uSlot = -1;
+         return false;
+      }
+};
+
 class IndirectionNode : public VirtualExpressionNode {
   private:
    PNT::TMngPointer<VirtualExpressionNode> mpAddress;
@@ -102,6 +141,8 @@ class IndirectionNode : public VirtualExpressionNode {
 
    virtual DomainType getType() const override { return DTInteger; }
    virtual TypeExpression getTypeExpression() const override { return TEIndirection; }
+   virtual bool setLetSlots(const std::vector<Atom>& letNames) override
+      {  return !mpAddress.isValid() || mpAddress.getElement().setLetSlots(letNames); }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) override;
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const override;
 };
@@ -146,6 +187,7 @@ class DomainNode : public VirtualExpressionNode {
          bool& hasReadToken);
    template <typename T>
    ReadResult readToken(typename Parser<T>::State& state, typename Parser<T>::Arguments& arguments);
+   bool readFastValue(const STG::SubString& text);
 
   protected:
    virtual ComparisonResult _compare(const EnhancedObject& asource) const override
@@ -258,6 +300,10 @@ class OperationNode : public VirtualExpressionNode {
    void applyOperation(DomainValue& first, const DomainValue& second) const;
    virtual DomainType getType() const override { return dtType; }
    virtual TypeExpression getTypeExpression() const override { return TEOperation; }
+   virtual bool setLetSlots(const std::vector<Atom>& letNames) override
+      {  return (!mpFirst.isValid() || mpFirst.getElement().setLetSlots(letNames))
+            && (!mpSecond.isValid() || mpSecond.getElement().setLetSlots(letNames));
+      }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) override;
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const override;
 };
@@ -284,7 +330,11 @@ class Expression : public STG::IOObject, public STG::Lexer::Base {
       }
    void clear() { mpContent.release(); }
    const VirtualExpressionNode& getContent() const { return *mpContent; }
+   bool setLetSlots(const std::vector<Atom>& letNames)
+      {  return !mpContent.isValid() || mpContent.getElement().setLetSlots(letNames); }
    ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments);
    WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const;
 };
 
+#include "StandardClasses/UndefineNew.h"
+#undef DefineAllocationRegion
@@ -0,0 +1,27 @@
+#include "FunctionSummaries.h"
+
+const FunctionSummaries::Summary*
+FunctionSummaries::find(uint64_t callee, uint64_t returnAddress,
+      const std::vector<DomainValue>& arguments) const {
+   auto found = mSummaries.find(callee);
+   if (found == mSummaries.end())
+      return nullptr;
+   DomainEvaluationEnvironment env{};
+   env.defaultDomainType = DISFormal;
+   for (const auto& summary : found->second) {
+      if (summary->returnAddress != returnAddress)
+         continue;
+      AssumeCondition(summary->arguments.size() == arguments.size())
+      bool isCompatible = true;
+      for (size_t index = 0; isCompatible && index < arguments.size(); ++index) {
+         const DomainValue& value = summary->arguments[index];
+         if (!value.isValid())
+            continue;
+         isCompatible = arguments[index].isValid() && value.contain(arguments[index], env);
+      }
+      if (isCompatible)
+         return summary.get();
+   }
+   return nullptr;
+}
+
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MemoryState.h"
+#include "VerificationCache.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/* Summaries of the functions called in the code, filled by the fixpoint of
+ * processor_check_block. A summary is found by the entry of the callee, by
+ * its return address, since the callee may save the link register in its
+ * stack, and by the values of its argument registers; it records the effect
+ * of the callee on a state where only these registers are known: the entries
+ * written or removed at the return, whether the memory has been stored and
+ * whether the callee returns at all. A call with the same return address
+ * whose arguments are contained in the ones of a summary reuses it instead of
+ * interpreting the callee again.
+ */
+class FunctionSummaries {
+  public:
+   struct Summary {
+      uint64_t returnAddress = 0;
+      std::vector<DomainValue> arguments; // invalid value for top
+      std::unique_ptr<MemoryState> written, removed;
+      bool hasClobberedMemory = false;
+      bool hasNoReturn = false;
+      // code of the callee, for the verification cache
+      std::vector<VerificationCache::Span> spans;
+   };
+
+  private:
+   std::unordered_map<uint64_t, std::vector<std::unique_ptr<Summary> > > mSummaries;
+   std::unordered_set<uint64_t> sComputing;
+
+  public:
+   FunctionSummaries() = default;
+
+   const Summary* find(uint64_t callee, uint64_t returnAddress,
+         const std::vector<DomainValue>& arguments) const;
+   void insert(uint64_t callee, std::unique_ptr<Summary>&& summary)
+      {  mSummaries[callee].push_back(std::move(summary)); }
+   void clear() { mSummaries.clear(); sComputing.clear(); }
+
+   // a recursive call has no summary yet
+   bool isComputing(uint64_t callee) const { return sComputing.find(callee) != sComputing.end(); }
+   void setComputing(uint64_t callee) { sComputing.insert(callee); }
+   void clearComputing(uint64_t callee) { sComputing.erase(callee); }
+};
+
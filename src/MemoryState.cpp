@@ -1,6 +1,9 @@
 #include "MemoryState.h"
 #include "Collection/Collection.template"
 
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
+
 MemoryModelFunctions MemoryState::functions={
    &MemoryState::set_number_of_registers,
    &MemoryState::clone,
@@ -14,12 +17,232 @@ MemoryModelFunctions MemoryState::functions={
    &MemoryState::load_multibit_disjunctive_value,
    &MemoryState::load_multifloat_value,
    &MemoryState::store_value,
-   nullptr /* &MemoryState::constraint_store_value */,
-   nullptr /* &MemoryState::constraint_address */
+   &MemoryState::constraint_store_value,
+   &MemoryState::constraint_address
 };
 
 template class COL::TSortedAVL<MemoryState::RegisterValue, MemoryState::RegisterValue::Key>;
 
+std::atomic<uint64_t> MemoryState::auLastVersion(0);
+
+void
+MemoryState::narrowMemory(const AddressKey& key, DomainValueZone&& address, DomainValueZone&& value) {
+   MemoryContent::Cursor cursor(mcMemory);
+   auto localize = mcMemory.locateKey(key, cursor);
+   if (localize) {
+      uint64_t oldVersion = cursor.elementAt().getVersion();
+      DomainValueZone refined(cursor.elementAt().getValue());
+      DomainEvaluationEnvironment env{};
+      env.defaultDomainType = DISFormal;
+      refined.intersectWith(value, env);
+      cursor.elementSAt().setValue(std::move(refined));
+      replaceVersion(oldVersion, cursor.elementAt().getVersion());
+   }
+   else {
+      MemoryValue* entry = new MemoryValue(std::move(address), std::move(value), key);
+      addVersion(entry->getVersion());
+      mcMemory.add(entry, localize.queryInsertionParameters().setFreeOnError(), &cursor);
+   }
+}
+
+void
+MemoryState::constraintMemory(const DomainElement& address, const DomainElement& value) {
+   DomainValueZone cellAddress(DomainValue((*domainFunctions->clone)(address), domainFunctions),
+         PNT::TSharedPointer<MemoryZone>());
+   AddressKey key = normalize(cellAddress.value());
+   narrowMemory(key, std::move(cellAddress), DomainValueZone(DomainValue((*domainFunctions->clone)(value),
+         domainFunctions), PNT::TSharedPointer<MemoryZone>()));
+}
+
+void
+MemoryState::constraintRegister(int registerIndex, const DomainElement& value) {
+   DomainValueZone constraint(DomainValue((*domainFunctions->clone)(value), domainFunctions),
+         PNT::TSharedPointer<MemoryZone>());
+   RegisterContent::Cursor cursor(rcRegisters);
+   if (rcRegisters.locateKey(registerIndex, cursor, COL::VirtualCollection::RPExact)) {
+      DomainValueZone refined(cursor.elementAt().getZoneValue());
+      DomainEvaluationEnvironment env{};
+      env.defaultDomainType = DISFormal;
+      refined.intersectWith(constraint, env);
+      constraint = std::move(refined);
+   }
+   setRegister(registerIndex, std::move(constraint));
+}
+
+// a cell whose address becomes another key after the guard is moved to it
+void
+MemoryState::constraintAddress(const DomainElement& address, const DomainElement& value) {
+   MemoryContent::Cursor cursor(mcMemory);
+   if (!mcMemory.locateKey(normalize(address), cursor, COL::VirtualCollection::RPExact))
+      return;
+   DomainValueZone refinedAddress(DomainValue((*domainFunctions->clone)(address), domainFunctions),
+         PNT::TSharedPointer<MemoryZone>());
+   refinedAddress.setZoneFrom(cursor.elementAt().getAddress());
+   DomainEvaluationEnvironment env{};
+   env.defaultDomainType = DISFormal;
+   refinedAddress.intersectWith(DomainValue((*domainFunctions->clone)(value), domainFunctions), env);
+   AddressKey key = normalize(refinedAddress.value(), refinedAddress.getZoneId());
+   if (key.compare(cursor.elementAt().getAddressKey()) == CREqual)
+      return;
+   DomainValueZone cellValue(cursor.elementAt().getValue());
+   removeVersion(cursor.elementAt().getVersion());
+   mcMemory.freeAt(cursor);
+   narrowMemory(key, std::move(refinedAddress), std::move(cellValue));
+}
+
+bool
+MemoryState::isSameAs(const MemoryState& source) const {
+   if (uGeneration == source.uGeneration)
+      return true;
+   if (uHash != source.uHash || rcRegisters.count() != source.rcRegisters.count()
+         || mcMemory.count() != source.mcMemory.count())
+      return false;
+   // an entry is created with a new version: the same version means the same key
+   {  RegisterContent::Cursor thisCursor(rcRegisters), sourceCursor(source.rcRegisters);
+      while (thisCursor.setToNext()) {
+         sourceCursor.setToNext();
+         if (thisCursor.elementAt().getVersion() != sourceCursor.elementAt().getVersion())
+            return false;
+      }
+   }
+   {  MemoryContent::Cursor thisCursor(mcMemory), sourceCursor(source.mcMemory);
+      while (thisCursor.setToNext()) {
+         sourceCursor.setToNext();
+         if (thisCursor.elementAt().getVersion() != sourceCursor.elementAt().getVersion())
+            return false;
+      }
+   }
+   return true;
+}
+
+bool
+MemoryState::retrieveFingerprint(std::vector<uint64_t>& fingerprint) const {
+   auto addValue = [this, &fingerprint](const DomainValueZone& value)
+      {  fingerprint.push_back((uint64_t) (int64_t) value.getZoneId());
+         const DomainValue::Bounds& bounds = value.getBounds();
+         if (bounds.tag == DomainValue::Bounds::BInterval && bounds.min == bounds.max) {
+            // no call to the domain library
+            fingerprint.push_back((uint64_t) bounds.sizeInBits);
+            fingerprint.push_back(bounds.min);
+            return true;
+         }
+         AddressKey key = AddressKey::normalize(value.value(), domainFunctions, value.getZoneId());
+         if (!key.isConstant())
+            return false;
+         fingerprint.push_back((uint64_t) key.getSizeInBits());
+         fingerprint.push_back(key.getValue());
+         return true;
+      };
+   fingerprint.clear();
+   fingerprint.push_back(rcRegisters.count());
+   for (RegisterContent::Cursor cursor(rcRegisters); cursor.setToNext(); ) {
+      fingerprint.push_back((uint64_t) cursor.elementAt().getRegister());
+      if (!addValue(cursor.elementAt().getZoneValue()))
+         return false;
+   }
+   fingerprint.push_back(mcMemory.count());
+   for (MemoryContent::Cursor cursor(mcMemory); cursor.setToNext(); ) {
+      // the address key is already normalized
+      AddressKey address = cursor.elementAt().getAddressKey();
+      if (!address.isConstant())
+         return false;
+      fingerprint.push_back((uint64_t) (int64_t) cursor.elementAt().getAddress().getZoneId());
+      fingerprint.push_back((uint64_t) address.getSizeInBits());
+      fingerprint.push_back(address.getValue());
+      if (!addValue(cursor.elementAt().getValue()))
+         return false;
+   }
+   return true;
+}
+
+void
+MemoryState::setTopRegisters(int sizeInBits) {
+   for (int registerIndex = 0; registerIndex < uRegisterNumber; ++registerIndex) {
+      RegisterContent::Cursor cursor(rcRegisters);
+      if (!rcRegisters.locateKey(registerIndex, cursor, COL::VirtualCollection::RPExact))
+         setRegister(registerIndex, DomainValueZone(DomainValue((*domainFunctions->multibit_create_top)
+               (sizeInBits, true /* isSymbolic */), domainFunctions), PNT::TSharedPointer<MemoryZone>()));
+   }
+}
+
+void
+MemoryState::setRegistersFrom(const MemoryState& source, const int* registers, int registersNumber) {
+   for (int index = 0; index < registersNumber; ++index) {
+      RegisterContent::Cursor cursor(source.rcRegisters);
+      if (source.rcRegisters.locateKey(registers[index], cursor, COL::VirtualCollection::RPExact))
+         setRegister(registers[index], DomainValueZone(cursor.elementAt().getZoneValue()));
+   }
+}
+
+void
+MemoryState::retrieveChangesSince(const MemoryState& source, MemoryState& written,
+      MemoryState& removed) const {
+   {  RegisterContent::Cursor cursor(rcRegisters), sourceCursor(source.rcRegisters);
+      while (cursor.setToNext()) {
+         if (!source.rcRegisters.locateKey(cursor.elementAt().getRegister(), sourceCursor,
+                  COL::VirtualCollection::RPExact)
+               || sourceCursor.elementAt().getVersion() != cursor.elementAt().getVersion())
+            written.setRegister(cursor.elementAt().getRegister(),
+                  DomainValueZone(cursor.elementAt().getZoneValue()));
+      }
+      sourceCursor.setToFirst();
+      for (; sourceCursor.isValid(); sourceCursor.setToNext())
+         if (!rcRegisters.locateKey(sourceCursor.elementAt().getRegister(), cursor,
+                  COL::VirtualCollection::RPExact))
+            removed.setRegister(sourceCursor.elementAt().getRegister(),
+                  DomainValueZone(sourceCursor.elementAt().getZoneValue()));
+   }
+   {  MemoryContent::Cursor cursor(mcMemory), sourceCursor(source.mcMemory);
+      while (cursor.setToNext()) {
+         if (!source.mcMemory.locateKey(cursor.elementAt().getAddressKey(), sourceCursor,
+                  COL::VirtualCollection::RPExact)
+               || sourceCursor.elementAt().getVersion() != cursor.elementAt().getVersion())
+            written.setMemory(DomainValueZone(cursor.elementAt().getAddress()),
+                  DomainValueZone(cursor.elementAt().getValue()));
+      }
+      sourceCursor.setToFirst();
+      for (; sourceCursor.isValid(); sourceCursor.setToNext())
+         if (!mcMemory.locateKey(sourceCursor.elementAt().getAddressKey(), cursor,
+                  COL::VirtualCollection::RPExact))
+            removed.setMemory(DomainValueZone(sourceCursor.elementAt().getAddress()),
+                  DomainValueZone(sourceCursor.elementAt().getValue()));
+   }
+}
+
+void
+MemoryState::applyChanges(const MemoryState& written, const MemoryState& removed,
+      bool hasClobberedMemory) {
+   for (RegisterContent::Cursor removedCursor(removed.rcRegisters); removedCursor.setToNext(); ) {
+      RegisterContent::Cursor cursor(rcRegisters);
+      if (rcRegisters.locateKey(removedCursor.elementAt().getRegister(), cursor,
+               COL::VirtualCollection::RPExact)) {
+         removeVersion(cursor.elementAt().getVersion());
+         rcRegisters.freeAt(cursor);
+      }
+   }
+   for (RegisterContent::Cursor writtenCursor(written.rcRegisters); writtenCursor.setToNext(); )
+      setRegister(writtenCursor.elementAt().getRegister(),
+            DomainValueZone(writtenCursor.elementAt().getZoneValue()));
+   if (hasClobberedMemory) {
+      // the stores of the callee may have been lost in its joins
+      for (MemoryContent::Cursor cursor(mcMemory); cursor.setToNext(); )
+         removeVersion(cursor.elementAt().getVersion());
+      mcMemory.freeAll();
+   }
+   else
+      for (MemoryContent::Cursor removedCursor(removed.mcMemory); removedCursor.setToNext(); ) {
+         MemoryContent::Cursor cursor(mcMemory);
+         if (mcMemory.locateKey(removedCursor.elementAt().getAddressKey(), cursor,
+                  COL::VirtualCollection::RPExact)) {
+            removeVersion(cursor.elementAt().getVersion());
+            mcMemory.freeAt(cursor);
+         }
+      }
+   for (MemoryContent::Cursor writtenCursor(written.mcMemory); writtenCursor.setToNext(); )
+      setMemory(DomainValueZone(writtenCursor.elementAt().getAddress()),
+            DomainValueZone(writtenCursor.elementAt().getValue()));
+}
+
 STG::Lexer::Base::ReadResult
 VirtualAddressConstraint::readJSon(STG::JSon::CommonParser::State& state,
       STG::JSon::CommonParser::Arguments& arguments) {
@@ -27,7 +250,7 @@ VirtualAddressConstraint::readJSon(STG::JSon::CommonParser::State& state,
    ReadResult result = RRContinue;
    bool hasHit = false;
 
-   enum Delimiters { DBegin, DAfterBegin, DConstraint, DZoneName, DEnd, DInherited };
+   enum Delimiters { DBegin, DAfterBegin, DConstraint, DZoneName, DEnd, DInherited = UInheritedPoint };
 
 #define DefineGoto(Target) case D##Target: goto L##Target;
    switch (state.point()) {
@@ -45,7 +268,7 @@ VirtualAddressConstraint::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
       arguments.reduceState(state);
       return RRHasToken;
@@ -83,16 +306,11 @@ LConstraint:
          if ((result = arguments.setArgumentKey()) == RRNeedChars) return result;
          state.point() = DInherited;
 LInherited:
-         state.point() -= DInherited;
          if (readFromKey(arguments.key(), state, arguments, result)) {
-            state.point() += DInherited;
             if (result == RRNeedChars) return result;
-            state.point() = DAfterBegin;
-            if (!arguments.setToNextToken(result)) return result;
             hasHit = true;
          }
-         else
-            state.point() += DInherited;
+         state.point() = DAfterBegin;
       }
 
       if (arguments.isAddKey()
@@ -103,7 +321,7 @@ LInherited:
 LZoneName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssZoneName = arguments.valueAsText();
+            atZoneName = arguments.valueAsText();
          }
          else {
             state.point() = DAfterBegin;
@@ -130,12 +348,13 @@ STG::Lexer::Base::WriteResult
 VirtualAddressConstraint::writeJSon(STG::JSon::CommonWriter::State& state,
       STG::JSon::CommonWriter::Arguments& arguments) const {
    WriteResult result = WRNeedEvent;
-   enum Delimiters { DBegin, DStart, DBeforeZoneName, DZoneName, DEnd, DInherited };
+   enum Delimiters { DBegin, DStart, DBeforeInherited, DBeforeZoneName, DZoneName, DEnd, DInherited = UInheritedPoint };
 
    #define DefineGoto(Target) case D##Target: goto L##Target;
    switch (state.point()) {
       DefineGoto(Begin)
       DefineGoto(Start)
+      DefineGoto(BeforeInherited)
       DefineGoto(BeforeZoneName)
       DefineGoto(ZoneName)
       DefineGoto(End)
@@ -158,23 +377,26 @@ LStart:
    if (!arguments.writeEvent(result)) return result;
    if (!arguments.writeTokens(state, result)) return result;
 
-LBeforeZoneName:
-   arguments.setAddKey(STG::SString("zone_name"));
+LBeforeInherited:
    state.point() = DInherited;
-   if (!arguments.writeEvent(result)) return result;
 
 LInherited:
-   state.point() -= DInherited;
-   if (writeToKey(state, arguments, result)) {
-      state.point() += DInherited;
-      if (result == WRNeedWrite) return result;
-   };
-   state.point() = DZoneName;
+   if (writeToKey(state, arguments, result) && result == WRNeedWrite)
+      return result;
+   state.point() = DBeforeZoneName;
 
+LBeforeZoneName:
+   if (atZoneName.isValid()) {
+      arguments.setAddKey(STG::SString("zone_name"));
+      ++state.point();
+      if (!arguments.writeEvent(result)) return result;
 LZoneName:
-   arguments.setStringValue(ssZoneName);
-   ++state.point();
-   if (!arguments.writeEvent(result)) return result;
+      arguments.setStringValue(atZoneName.getName());
+      ++state.point();
+      if (!arguments.writeEvent(result)) return result;
+   }
+   else
+      state.point() = DEnd;
 
 LEnd:
    arguments.setCloseObject();
@@ -186,22 +408,25 @@ LEnd:
 bool
 RegisterConstraint::readFromKey(const STG::SubString& key, STG::JSon::CommonParser::State& state,
       STG::JSon::CommonParser::Arguments& arguments, ReadResult& result) {
-   if (state.point() == 0) {
+   if (state.point() == UInheritedPoint) {
       if (key != "register")
          return false;
       ++state.point();
       if (!arguments.setToNextToken(result)) return true;
    }
-   if (state.point() == 1) {
+   if (state.point() == UInheritedPoint+1) {
       if (arguments.isSetString()) {
-         if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
+         if ((result = arguments.setArgumentTextValue()) == RRNeedChars) return true;
          const auto& ruleResult = state.getResult((ReadRuleResult*) nullptr);
          AssumeCondition(ruleResult.processor && ruleResult.processorFunctions)
          uRegisterIndex = (*ruleResult.processorFunctions->get_register_index)
                (ruleResult.processor, arguments.valueAsText().getChunk().string);
-         state.point() = 0;
       }
+      ++state.point();
+      if (!arguments.setToNextToken(result)) return true;
    }
+   if (state.point() == UInheritedPoint+2)
+      state.point() = UInheritedPoint;
    return true;
 }
 
@@ -209,18 +434,18 @@ bool
 RegisterConstraint::writeToKey(STG::JSon::CommonWriter::State& state,
       STG::JSon::CommonWriter::Arguments& arguments, WriteResult& result) const {
    const char* name = nullptr;
-   if (state.point() == 0) {
+   if (state.point() == UInheritedPoint) {
       const auto& ruleResult = state.getResult((WriteRuleResult*) nullptr);
       AssumeCondition(ruleResult.processor && ruleResult.processorFunctions)
       name = (*ruleResult.processorFunctions->get_register_name)(ruleResult.processor,
             uRegisterIndex);
       if (name == nullptr)
          return false;
-      arguments.setAddKey(STG::SString("name"));
+      arguments.setAddKey(STG::SString("register"));
       ++state.point();
       if (!arguments.writeEvent(result)) return true;
    }
-   if (state.point() == 1) {
+   if (state.point() == UInheritedPoint+1) {
       if (!name) {
          const auto& ruleResult = state.getResult((WriteRuleResult*) nullptr);
          AssumeCondition(ruleResult.processor && ruleResult.processorFunctions)
@@ -229,7 +454,7 @@ RegisterConstraint::writeToKey(STG::JSon::CommonWriter::State& state,
       }
       arguments.setStringValue(STG::SString(name));
       ++state.point();
-      if (!arguments.writeEvent(result)) return result;
+      if (!arguments.writeEvent(result)) return true;
    }
    return true;
 }
@@ -237,7 +462,7 @@ RegisterConstraint::writeToKey(STG::JSon::CommonWriter::State& state,
 bool
 IndirectAddressConstraint::readFromKey(const STG::SubString& key, STG::JSon::CommonParser::State& state,
       STG::JSon::CommonParser::Arguments& arguments, ReadResult& result) {
-   if (state.point() == 0) {
+   if (state.point() == UInheritedPoint) {
       if (key != "address")
          return false;
       {  auto ruleResult = state.getResult((ReadRuleResult*) nullptr);
@@ -249,15 +474,15 @@ IndirectAddressConstraint::readFromKey(const STG::SubString& key, STG::JSon::Com
       if (!arguments.setToNextToken(result)) return true;
       if (!arguments.parseTokens(state, result)) return true;
    }
-   if (state.point() == 1)
-      state.point() = 0;
+   if (state.point() == UInheritedPoint+1)
+      state.point() = UInheritedPoint;
    return true;
 }
 
 bool
 IndirectAddressConstraint::writeToKey(STG::JSon::CommonWriter::State& state,
       STG::JSon::CommonWriter::Arguments& arguments, WriteResult& result) const {
-   if (state.point() == 0) {
+   if (state.point() == UInheritedPoint) {
       arguments.setAddKey(STG::SString("address"));
       ++state.point();
       arguments.shiftState(state, eAddress, &Expression::writeJSon,
@@ -265,11 +490,65 @@ IndirectAddressConstraint::writeToKey(STG::JSon::CommonWriter::State& state,
       if (!arguments.writeEvent(result)) return true;
       if (!arguments.writeTokens(state, result)) return true;
    }
-   if (state.point() == 1)
-      state.point() = 0;
+   if (state.point() == UInheritedPoint+1)
+      state.point() = UInheritedPoint;
    return true;
 }
 
+bool
+LetConstraint::readFromKey(const STG::SubString& key, STG::JSon::CommonParser::State& state,
+      STG::JSon::CommonParser::Arguments& arguments, ReadResult& result) {
+   if (state.point() == UInheritedPoint) {
+      if (key != "name")
+         return false;
+      ++state.point();
+      if (!arguments.setToNextToken(result)) return true;
+   }
+   if (state.point() == UInheritedPoint+1) {
+      if (arguments.isSetString()) {
+         if ((result = arguments.setArgumentTextValue()) == RRNeedChars) return true;
+         atName = arguments.valueAsText();
+      }
+      ++state.point();
+      if (!arguments.setToNextToken(result)) return true;
+   }
+   if (state.point() == UInheritedPoint+2)
+      state.point() = UInheritedPoint;
+   return true;
+}
+
+bool
+LetConstraint::writeToKey(STG::JSon::CommonWriter::State& state,
+      STG::JSon::CommonWriter::Arguments& arguments, WriteResult& result) const {
+   if (state.point() == UInheritedPoint) {
+      arguments.setAddKey(STG::SString("name"));
+      ++state.point();
+      if (!arguments.writeEvent(result)) return true;
+   }
+   if (state.point() == UInheritedPoint+1) {
+      arguments.setStringValue(atName.getName());
+      ++state.point();
+      if (!arguments.writeEvent(result)) return true;
+   }
+   return true;
+}
+
+// a constraint only refers to the let variables defined before it
+bool
+MemoryStateConstraint::setLetSlots() {
+   std::vector<Atom> letNames;
+   bool result = true;
+   Cursor cursor(*this);
+   while (cursor.setToNext()) {
+      if (!cursor.elementSAt().setLetSlots(letNames))
+         result = false;
+      if (cursor.elementAt().isLet())
+         letNames.push_back(static_cast<const LetConstraint&>(cursor.elementAt()).getName());
+   }
+   uLetsNumber = (int) letNames.size();
+   return result;
+}
+
 STG::Lexer::Base::ReadResult
 MemoryStateConstraint::readJSon(STG::JSon::CommonParser::State& state,
       STG::JSon::CommonParser::Arguments& arguments) {
@@ -292,7 +571,7 @@ MemoryStateConstraint::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenArray()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '['")))
+      if (!arguments.addErrorMessage("expected '['"))
          return result;
    }
    ++state.point();
@@ -367,6 +646,8 @@ LMemoryConstraintContent:
    state.point() = DEnd;
    if (!arguments.setToNextToken(result)) return result;
 LEnd:
+   if (!setLetSlots() && !arguments.addErrorMessage("unknown let variable in the constraints"))
+      return result;
    arguments.reduceState(state);
    return RRHasToken;
 }
@@ -426,16 +707,22 @@ LWriteContent:
       ++state.point();
       if (!cursor)
          cursor = &*state.getSResult((WriteRuleResult*) nullptr).writeCursor;
-      arguments.shiftState(state, cursor->elementSAt(), &VirtualAddressConstraint::writeJSon,
-            (char*) nullptr);
+      {  VirtualAddressConstraint::WriteRuleResult ruleResult = state.getResult((WriteRuleResult*) nullptr);
+         arguments.shiftState(state, cursor->elementSAt(), &VirtualAddressConstraint::writeJSon,
+               (VirtualAddressConstraint::WriteRuleResult*) nullptr);
+         state.getSResult((VirtualAddressConstraint::WriteRuleResult*) nullptr) = ruleResult;
+      }
       if (!arguments.writeEvent(result)) return result;
       if (!arguments.writeTokens(state, result)) return result;
 
 LEndContent:
+      arguments.setCloseObject();
       state.point() = DAfterBegin;
+      if (!arguments.writeEvent(result)) return result;
       if (!cursor)
          cursor = &*state.getSResult((WriteRuleResult*) nullptr).writeCursor;
    }
+   state.point() = DEnd;
 
 LEnd:
    arguments.setCloseArray();
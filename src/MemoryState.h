@@ -4,6 +4,12 @@
 #include "decsec_callback.h"
 #include "DomainValue.h"
 #include "MemoryZone.h"
+#include "Statistics.h"
+#include <atomic>
+#include <vector>
+
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
 
 class MemoryInterpretParameters {
 
@@ -165,38 +171,54 @@ class ImplicitHypotheses : public PNT::SharedElement {
 class Processor;
 class VirtualAddressConstraint;
 class MemoryState : public STG::IOObject {
+  private:
+   /* Every value stored in an entry receives a version that is unique in the
+    * process. A copied entry keeps its version, so two entries with the same
+    * version hold the same value and the domain is not called to compare them.
+    */
+   static std::atomic<uint64_t> auLastVersion;
+   static uint64_t newVersion() { return auLastVersion.fetch_add(1, std::memory_order_relaxed) + 1; }
+   static uint64_t hashVersion(uint64_t version)
+      {  // finalizer of splitmix64, to spread the consecutive versions
+         version = (version ^ (version >> 30)) * 0xbf58476d1ce4e5b9ULL;
+         version = (version ^ (version >> 27)) * 0x94d049bb133111ebULL;
+         return version ^ (version >> 31);
+      }
+
+  public:
+   /* The zones are shared elements whose pointers are linked without any
+    * lock: a state that crosses the threads only keeps the id of its zones
+    * (see copyEntriesTo) and they are bound again on its return.
+    */
+   typedef std::unordered_map<int, PNT::TSharedPointer<MemoryZone> > DetachedZones;
+
   private:
    class DomainValueZone : public DomainValue {
      private:
       PNT::TSharedPointer<MemoryZone> spmzZone;
+      int uZoneId = -1; // id of spmzZone, kept when the zone is detached
 
      protected:
       virtual ComparisonResult _compare(const EnhancedObject& asource) const
-         {  ComparisonResult result = CREqual;
-            const DomainValueZone& source = static_cast<const DomainValueZone&>(castFromCopyHandler(asource));
-            if (!spmzZone.isValid())
-               result = !source.spmzZone.isValid() ? CREqual : CRLess;
-            else if (!source.spmzZone.isValid())
-               result = CRGreater;
-            else if (spmzZone.key() == source.spmzZone.key())
-               result = DomainValue::_compare(source);
-            else
-               result = fcompare(spmzZone->getId(), source.spmzZone->getId());
-            return result;
+         {  const DomainValueZone& source = static_cast<const DomainValueZone&>(castFromCopyHandler(asource));
+            ComparisonResult result = fcompare(uZoneId, source.uZoneId);
+            return (result != CREqual) ? result : DomainValue::_compare(source);
          }
 
      public:
       DomainValueZone(DomainValue&& value, const PNT::TSharedPointer<MemoryZone>& zone)
-         :  DomainValue(value), spmzZone(zone) {}
+         :  DomainValue(value), spmzZone(zone), uZoneId(zone.isValid() ? zone->getId() : -1) {}
       DomainValueZone(DomainValueZone&& source) = default;
       DomainValueZone(const DomainValueZone& source) = default;
       DomainValueZone& operator=(DomainValueZone&& source) = default;
       DomainValueZone& operator=(const DomainValueZone& source) = default;
 
       void mergeWith(DomainValueZone& source)
-         {  if (spmzZone.isValid() != source.spmzZone.isValid()
-                  || (spmzZone.isValid() && spmzZone.key() != source.spmzZone.key()))
+         {  if (uZoneId != source.uZoneId || spmzZone.isValid() != source.spmzZone.isValid()
+                  || (spmzZone.isValid() && spmzZone.key() != source.spmzZone.key())) {
                spmzZone = PNT::TSharedPointer<MemoryZone>();
+               uZoneId = -1;
+            }
             DomainEvaluationEnvironment env{};
             env.defaultDomainType = DISFormal;
             DomainValue::mergeWith(source, env);
@@ -204,19 +226,44 @@ class MemoryState : public STG::IOObject {
       bool contain(const DomainValueZone& source) const
          {  // if (spmzZone.isValid() && spmzZone.key() != source.spmzZone.key())
             //    return false;
+            bool result;
+            if (getBounds().contain(source.getBounds(), result)) {
+               Statistics::local().addCall(Statistics::CInlineContain);
+               return result;
+            }
             DomainEvaluationEnvironment env{};
             env.defaultDomainType = DISFormal;
             return DomainValue::contain(source, env);
          }
       const PNT::TSharedPointer<MemoryZone>& getZone() const { return spmzZone; }
+      const int& getZoneId() const { return uZoneId; }
       void setFrom(DomainValue&& value, const PNT::TSharedPointer<MemoryZone>& zone)
-         {  DomainValue::operator=(std::move(value)); spmzZone = zone; }
+         {  DomainValue::operator=(std::move(value));
+            spmzZone = zone;
+            uZoneId = zone.isValid() ? zone->getId() : -1;
+         }
+      void setZoneFrom(const DomainValueZone& source)
+         {  spmzZone = source.spmzZone; uZoneId = source.uZoneId; }
+      void detachZone(DetachedZones& zones)
+         {  if (spmzZone.isValid()) {
+               zones.insert(std::make_pair(uZoneId, spmzZone));
+               spmzZone = PNT::TSharedPointer<MemoryZone>();
+            }
+         }
+      void bindZone(const DetachedZones& zones)
+         {  if (uZoneId >= 0 && !spmzZone.isValid()) {
+               auto found = zones.find(uZoneId);
+               if (found != zones.end())
+                  spmzZone = found->second;
+            }
+         }
    };
    class RegisterValue : public COL::GenericAVL::Node {
      private:
       typedef COL::GenericAVL::Node inherited;
       int uRegister;
       DomainValueZone dvzValue;
+      uint64_t uVersion = newVersion();
 
      public:
       RegisterValue(int aregister, DomainValue&& value,
@@ -228,20 +275,28 @@ class MemoryState : public STG::IOObject {
       DefineCopy(RegisterValue)
 
       const int& getRegister() const { return uRegister; }
+      const uint64_t& getVersion() const { return uVersion; }
       void setValue(DomainValue&& value, const PNT::TSharedPointer<MemoryZone>& zone)
-         {  dvzValue.setFrom(std::move(value), zone); }
+         {  dvzValue.setFrom(std::move(value), zone); uVersion = newVersion(); }
       void setValue(DomainValueZone&& value)
-         {  dvzValue = std::move(value); }
+         {  dvzValue = std::move(value); uVersion = newVersion(); }
       const DomainValue& getValue() const { return dvzValue; }
+      const DomainValueZone& getZoneValue() const { return dvzValue; }
       void mergeWith(RegisterValue& source)
          {  AssumeCondition(uRegister == source.uRegister)
+            if (uVersion == source.uVersion)
+               return;
             dvzValue.mergeWith(source.dvzValue);
+            uVersion = newVersion();
          }
       bool contain(const RegisterValue& source) const
          {  AssumeCondition(uRegister == source.uRegister)
-            return dvzValue.contain(source.dvzValue);
+            return uVersion == source.uVersion || dvzValue.contain(source.dvzValue);
          }
       bool isTop() const { return dvzValue.isTop(); }
+      // the version is kept: the value does not change
+      void detachZone(DetachedZones& zones) { dvzValue.detachZone(zones); }
+      void bindZone(const DetachedZones& zones) { dvzValue.bindZone(zones); }
       class Key {
         public:
          Key(const COL::VirtualCollection&) {}
@@ -251,40 +306,131 @@ class MemoryState : public STG::IOObject {
          static ComparisonResult compare(KeyType fst, KeyType snd) { return fcompare(fst, snd); }
       };
    };
+   /* Normalized key of a memory cell. A constant address is compared on its
+    * zone, its size and its value as plain integers. The other addresses are
+    * ordered after the constants of their zone and fall back on the compare
+    * of the domain library.
+    */
+   class AddressKey {
+     private:
+      const DomainElement* pdeAddress = nullptr;
+      struct _DomainElementFunctions* pfFunctions = nullptr;
+      int uZoneId = -1;
+      bool fIsConstant = false;
+      int uSizeInBits = 0;
+      uint64_t uValue = 0;
+
+     public:
+      AddressKey() = default;
+      AddressKey(const DomainElement& address, struct _DomainElementFunctions* functions,
+            int zoneId, bool isConstant, int sizeInBits, uint64_t value)
+         :  pdeAddress(&address), pfFunctions(functions), uZoneId(zoneId),
+            fIsConstant(isConstant), uSizeInBits(sizeInBits), uValue(value) {}
+      // the only calls to the domain library, once per key
+      static AddressKey normalize(const DomainElement& address, struct _DomainElementFunctions* functions,
+            int zoneId)
+         {  AddressKey result(address, functions, zoneId, false, 0, 0);
+            DomainIntegerConstant constant{};
+            if (address.content && functions && (*functions->get_type)(address) == DTInteger
+                  && (*functions->multibit_is_constant_value)(address, &constant)) {
+               result.fIsConstant = true;
+               result.uSizeInBits = constant.sizeInBits;
+               result.uValue = constant.integerValue;
+            }
+            return result;
+         }
+
+      bool isConstant() const { return fIsConstant; }
+      int getSizeInBits() const { return uSizeInBits; }
+      const uint64_t& getValue() const { return uValue; }
+      ComparisonResult compare(const AddressKey& source) const
+         {  ComparisonResult result = fcompare(uZoneId, source.uZoneId);
+            if (result != CREqual)
+               return result;
+            if (fIsConstant != source.fIsConstant)
+               return fIsConstant ? CRLess : CRGreater;
+            if (fIsConstant) {
+               result = fcompare(uSizeInBits, source.uSizeInBits);
+               return (result != CREqual) ? result : fcompare(uValue, source.uValue);
+            }
+            if (!pfFunctions)
+               return !source.pfFunctions ? CREqual : CRLess;
+            if (!source.pfFunctions)
+               return CRGreater;
+            int res = (*pfFunctions->compare)(*pdeAddress, *source.pdeAddress);
+            AssumeCondition(-1 <= res && res <= 2)
+            return (ComparisonResult) res;
+         }
+   };
    class MemoryValue : public COL::GenericAVL::Node {
      private:
       typedef COL::GenericAVL::Node inherited;
       DomainValueZone dvzAddress;
       DomainValueZone dvzValue;
+      uint64_t uVersion = newVersion();
+      // normalized form of dvzAddress, computed once per entry
+      bool fIsConstantAddress = false;
+      int uAddressSizeInBits = 0;
+      uint64_t uAddressValue = 0;
+
+      void normalizeAddress()
+         {  AddressKey key = AddressKey::normalize(dvzAddress.value(),
+               dvzAddress.hasFunctionTable() ? &dvzAddress.functionTable() : nullptr,
+               dvzAddress.getZoneId());
+            fIsConstantAddress = key.isConstant();
+            uAddressSizeInBits = key.getSizeInBits();
+            uAddressValue = key.getValue();
+         }
 
      public:
       MemoryValue(DomainValue&& address, const PNT::TSharedPointer<MemoryZone>& zoneAddress,
             DomainValue&& value, const PNT::TSharedPointer<MemoryZone>& zoneValue)
-         :  dvzAddress(std::move(address), zoneAddress), dvzValue(std::move(value), zoneValue) {}
+         :  dvzAddress(std::move(address), zoneAddress), dvzValue(std::move(value), zoneValue)
+         {  normalizeAddress(); }
       MemoryValue(DomainValueZone&& address, DomainValueZone&& value)
-         :  dvzAddress(std::move(address)), dvzValue(std::move(value)) {}
+         :  dvzAddress(std::move(address)), dvzValue(std::move(value))
+         {  normalizeAddress(); }
+      // key is the normalized form of address, already computed by the caller
+      MemoryValue(DomainValueZone&& address, DomainValueZone&& value, const AddressKey& key)
+         :  dvzAddress(std::move(address)), dvzValue(std::move(value)),
+            fIsConstantAddress(key.isConstant()), uAddressSizeInBits(key.getSizeInBits()),
+            uAddressValue(key.getValue()) {}
       MemoryValue(const MemoryValue& source) = default;
       DefineCopy(MemoryValue)
 
       const DomainValueZone& getAddress() const { return dvzAddress; }
+      AddressKey getAddressKey() const
+         {  return AddressKey(dvzAddress.value(),
+               dvzAddress.hasFunctionTable() ? &dvzAddress.functionTable() : nullptr,
+               dvzAddress.getZoneId(), fIsConstantAddress, uAddressSizeInBits, uAddressValue);
+         }
+      const uint64_t& getVersion() const { return uVersion; }
       void setValue(DomainValue&& value, const PNT::TSharedPointer<MemoryZone>& zone)
-         {  dvzValue.setFrom(std::move(value), zone); }
+         {  dvzValue.setFrom(std::move(value), zone); uVersion = newVersion(); }
       void setValue(DomainValueZone&& value)
-         {  dvzValue = std::move(value); }
+         {  dvzValue = std::move(value); uVersion = newVersion(); }
       const DomainValueZone& getValue() const { return dvzValue; }
       void mergeWith(MemoryValue& source)
-         {  dvzValue.mergeWith(source.dvzValue);
+         {  if (uVersion == source.uVersion)
+               return;
+            dvzValue.mergeWith(source.dvzValue);
+            uVersion = newVersion();
          }
       bool contain(const MemoryValue& source) const
-         {  return dvzValue.contain(source.dvzValue);
+         {  return uVersion == source.uVersion || dvzValue.contain(source.dvzValue);
          }
       bool isTop() const { return dvzValue.isTop(); }
+      // the address key only depends on the zone id
+      void detachZone(DetachedZones& zones)
+         {  dvzAddress.detachZone(zones); dvzValue.detachZone(zones); }
+      void bindZone(const DetachedZones& zones)
+         {  dvzAddress.bindZone(zones); dvzValue.bindZone(zones); }
       class Key {
         public:
          Key(const COL::VirtualCollection&) {}
-         typedef const DomainValue& KeyType;
-         typedef DomainValue ControlKeyType;
-         static KeyType key(const MemoryValue& element) { return element.getAddress(); }
+         typedef AddressKey KeyType;
+         typedef AddressKey ControlKeyType;
+         static KeyType key(const MemoryValue& element) { return element.getAddressKey(); }
          static ComparisonResult compare(KeyType fst, KeyType snd) { return fst.compare(snd); }
       };
    };
@@ -297,6 +443,24 @@ class MemoryState : public STG::IOObject {
    struct _DomainElementFunctions* domainFunctions;
    MemoryZones mzMemoryZones;
    PNT::TSharedPointer<ImplicitHypotheses> sphImplicitHypotheses;
+   /* uHash combines the versions of the entries and is updated with each of
+    * them. uGeneration changes with any modification and is kept by a copy:
+    * two states with the same generation are equal.
+    */
+   uint64_t uHash = 0;
+   uint64_t uGeneration = newVersion();
+   // a store happened on one of the paths joined in this state
+   bool fHasStoredMemory = false;
+
+   void replaceVersion(uint64_t oldVersion, uint64_t version)
+      {  uHash ^= hashVersion(oldVersion) ^ hashVersion(version);
+         uGeneration = newVersion();
+      }
+   void addVersion(uint64_t version)
+      {  uHash ^= hashVersion(version);
+         uGeneration = newVersion();
+      }
+   void removeVersion(uint64_t version) { addVersion(version); }
 
   public:
    static MemoryModelFunctions functions;
@@ -335,14 +499,8 @@ class MemoryState : public STG::IOObject {
          DomainElement* avalue, InterpretParameters* parameters,
          unsigned* error /* set of MemoryEvaluationErrorFlags */)
       {  MemoryState* memory = reinterpret_cast<MemoryState*>(amemory);
-         RegisterContent::Cursor cursor(memory->rcRegisters);
-         auto locationResult = memory->rcRegisters.locateKey(registerIndex, cursor);
          DomainValueZone value(DomainValue(std::move(*avalue), memory->domainFunctions), PNT::TSharedPointer<MemoryZone>());
-         if (locationResult)
-            cursor.elementSAt().setValue(std::move(value));
-         else
-            memory->rcRegisters.add(new RegisterValue(registerIndex, std::move(value)),
-                  locationResult.queryInsertionParameters().setFreeOnError(), &cursor);
+         memory->setRegister(registerIndex, std::move(value));
       }
    static DomainElement get_register_value(MemoryModel* amemory,
          int registerIndex, InterpretParameters* parameters,
@@ -364,10 +522,10 @@ class MemoryState : public STG::IOObject {
          DomainElement indirect_address, size_t size, InterpretParameters* parameters,
          unsigned* error, struct _DomainElementFunctions** elementFunctions)
       {  MemoryState* memory = reinterpret_cast<MemoryState*>(amemory);
-         DomainValue address((*memory->domainFunctions->clone)(indirect_address), memory->domainFunctions);
          MemoryContent::Cursor cursor(memory->mcMemory);
          DomainValue result(memory->domainFunctions);
-         if (memory->mcMemory.locateKey(address, cursor, COL::VirtualCollection::RPExact))
+         if (memory->mcMemory.locateKey(memory->normalize(indirect_address), cursor,
+                  COL::VirtualCollection::RPExact))
             result = cursor.elementAt().getValue();
          else
             result = DomainValue((*memory->domainFunctions->multibit_create_top)(size, true /* isSymbolic */), memory->domainFunctions);
@@ -379,10 +537,10 @@ class MemoryState : public STG::IOObject {
          DomainElement indirect_address, size_t size, InterpretParameters* parameters,
          unsigned* error, struct _DomainElementFunctions** elementFunctions)
       {  MemoryState* memory = reinterpret_cast<MemoryState*>(amemory);
-         DomainValue address((*memory->domainFunctions->clone)(indirect_address), memory->domainFunctions);
          MemoryContent::Cursor cursor(memory->mcMemory);
          DomainValue result(memory->domainFunctions);
-         if (memory->mcMemory.locateKey(address, cursor, COL::VirtualCollection::RPExact))
+         if (memory->mcMemory.locateKey(memory->normalize(indirect_address), cursor,
+                  COL::VirtualCollection::RPExact))
             result = cursor.elementAt().getValue();
          else
             result = DomainValue((*memory->domainFunctions->multibit_create_top)(size, true /* isSymbolic */), memory->domainFunctions);
@@ -405,14 +563,61 @@ class MemoryState : public STG::IOObject {
       {  MemoryState* memory = reinterpret_cast<MemoryState*>(amemory);
          DomainValueZone value(DomainValue((*memory->domainFunctions->clone)(avalue), memory->domainFunctions), PNT::TSharedPointer<MemoryZone>());
          DomainValueZone address(DomainValue((*memory->domainFunctions->clone)(indirect_address), memory->domainFunctions), PNT::TSharedPointer<MemoryZone>());
-         MemoryContent::Cursor cursor(memory->mcMemory);
-         auto localize = memory->mcMemory.locateKey(address, cursor);
-         if (localize)
+         memory->setMemory(std::move(address), std::move(value));
+      }
+   /* backward refinement after a guard: the value stored at indirect_address
+    * and the register indirect_register loaded from it are narrowed in place
+    */
+   static void constraint_store_value(MemoryModel* amemory, DomainElement indirect_address,
+         DomainElement value, unsigned indirect_register, InterpretParameters* parameters, unsigned* error)
+      {  MemoryState* memory = reinterpret_cast<MemoryState*>(amemory);
+         memory->constraintMemory(indirect_address, value);
+         if (indirect_register < (unsigned) memory->uRegisterNumber)
+            memory->constraintRegister((int) indirect_register, value);
+      }
+   // the address of the cell found at indirect_address is narrowed by value
+   static void constraint_address(MemoryModel* amemory, DomainElement indirect_address,
+         DomainElement value, InterpretParameters* parameters, unsigned* error)
+      {  MemoryState* memory = reinterpret_cast<MemoryState*>(amemory);
+         memory->constraintAddress(indirect_address, value);
+      }
+   AddressKey normalize(const DomainElement& address, int zoneId = -1) const
+      {  return AddressKey::normalize(address, domainFunctions, zoneId); }
+   void setRegister(int registerIndex, DomainValueZone&& value)
+      {  RegisterContent::Cursor cursor(rcRegisters);
+         auto locationResult = rcRegisters.locateKey(registerIndex, cursor);
+         if (locationResult) {
+            uint64_t oldVersion = cursor.elementAt().getVersion();
             cursor.elementSAt().setValue(std::move(value));
-         else
-            memory->mcMemory.add(new MemoryValue(std::move(address), std::move(value)),
-                  localize.queryInsertionParameters().setFreeOnError(), &cursor);
+            replaceVersion(oldVersion, cursor.elementAt().getVersion());
+         }
+         else {
+            RegisterValue* entry = new RegisterValue(registerIndex, std::move(value));
+            addVersion(entry->getVersion());
+            rcRegisters.add(entry, locationResult.queryInsertionParameters().setFreeOnError(), &cursor);
+         }
+      }
+   void setMemory(DomainValueZone&& address, DomainValueZone&& value)
+      {  fHasStoredMemory = true;
+         MemoryContent::Cursor cursor(mcMemory);
+         AddressKey key = normalize(address.value(), address.getZoneId());
+         auto localize = mcMemory.locateKey(key, cursor);
+         if (localize) {
+            uint64_t oldVersion = cursor.elementAt().getVersion();
+            cursor.elementSAt().setValue(std::move(value));
+            replaceVersion(oldVersion, cursor.elementAt().getVersion());
+         }
+         else {
+            MemoryValue* entry = new MemoryValue(std::move(address), std::move(value), key);
+            addVersion(entry->getVersion());
+            mcMemory.add(entry, localize.queryInsertionParameters().setFreeOnError(), &cursor);
+         }
       }
+   // intersection with the current content, which is top for a missing entry
+   void narrowMemory(const AddressKey& key, DomainValueZone&& address, DomainValueZone&& value);
+   void constraintMemory(const DomainElement& address, const DomainElement& value);
+   void constraintRegister(int registerIndex, const DomainElement& value);
+   void constraintAddress(const DomainElement& address, const DomainElement& value);
 
   public:
    MemoryState(int registerNumber, struct _DomainElementFunctions* adomainFunctions)
@@ -429,11 +634,21 @@ class MemoryState : public STG::IOObject {
          rcRegisters.swap(source.rcRegisters);
          mcMemory.swap(source.mcMemory);
          mzMemoryZones.swap(source.mzMemoryZones);
+         std::swap(uHash, source.uHash);
+         std::swap(uGeneration, source.uGeneration);
+         std::swap(fHasStoredMemory, source.fHasStoredMemory);
       }
-   void mergeWith(MemoryState& source)
+   /* With doesWiden, an entry whose value does not contain the value of
+    * source is removed, that is set to top: the join at a loop head then
+    * terminates since the entries can only disappear.
+    */
+   void mergeWith(MemoryState& source, bool doesWiden=false)
       {  AssumeCondition(uRegisterNumber == source.uRegisterNumber && domainFunctions == source.domainFunctions
                && sphImplicitHypotheses.isValid() == source.sphImplicitHypotheses.isValid()
                && (!sphImplicitHypotheses.isValid() || sphImplicitHypotheses.key() == source.sphImplicitHypotheses.key()))
+         if (uGeneration == source.uGeneration)
+            return;
+         fHasStoredMemory = fHasStoredMemory || source.fHasStoredMemory;
          mzMemoryZones.mergeWith(source.mzMemoryZones);
          {  RegisterContent::Cursor thisCursor(rcRegisters), sourceCursor(source.rcRegisters);
             sourceCursor.setToFirst();
@@ -441,6 +656,7 @@ class MemoryState : public STG::IOObject {
                if (!sourceCursor.isValid()) {
                   auto copyCursor = thisCursor;
                   thisCursor.setToPrevious();
+                  removeVersion(copyCursor.elementAt().getVersion());
                   rcRegisters.freeAt(copyCursor);
                }
                else {
@@ -450,14 +666,27 @@ class MemoryState : public STG::IOObject {
                   if (compare == CRLess) {
                      auto copyCursor = thisCursor;
                      thisCursor.setToPrevious();
+                     removeVersion(copyCursor.elementAt().getVersion());
                      rcRegisters.freeAt(copyCursor);
                   }
                   else if (compare == CRGreater) {
                      thisCursor.setToPrevious();
                      sourceCursor.setToNext();
                   }
-                  else {
+                  else if (!doesWiden) {
+                     uint64_t oldVersion = thisCursor.elementAt().getVersion();
                      thisCursor.elementSAt().mergeWith(sourceCursor.elementSAt());
+                     if (thisCursor.elementAt().getVersion() != oldVersion)
+                        replaceVersion(oldVersion, thisCursor.elementAt().getVersion());
+                     sourceCursor.setToNext();
+                  }
+                  else {
+                     if (!thisCursor.elementAt().contain(sourceCursor.elementAt())) {
+                        auto copyCursor = thisCursor;
+                        thisCursor.setToPrevious();
+                        removeVersion(copyCursor.elementAt().getVersion());
+                        rcRegisters.freeAt(copyCursor);
+                     }
                      sourceCursor.setToNext();
                   }
                };
@@ -469,6 +698,7 @@ class MemoryState : public STG::IOObject {
                if (!sourceCursor.isValid()) {
                   auto copyCursor = thisCursor;
                   thisCursor.setToPrevious();
+                  removeVersion(copyCursor.elementAt().getVersion());
                   mcMemory.freeAt(copyCursor);
                }
                else {
@@ -478,14 +708,27 @@ class MemoryState : public STG::IOObject {
                   if (compare == CRLess) {
                      auto copyCursor = thisCursor;
                      thisCursor.setToPrevious();
+                     removeVersion(copyCursor.elementAt().getVersion());
                      mcMemory.freeAt(copyCursor);
                   }
                   else if (compare == CRGreater) {
                      thisCursor.setToPrevious();
                      sourceCursor.setToNext();
                   }
-                  else {
+                  else if (!doesWiden) {
+                     uint64_t oldVersion = thisCursor.elementAt().getVersion();
                      thisCursor.elementSAt().mergeWith(sourceCursor.elementSAt());
+                     if (thisCursor.elementAt().getVersion() != oldVersion)
+                        replaceVersion(oldVersion, thisCursor.elementAt().getVersion());
+                     sourceCursor.setToNext();
+                  }
+                  else {
+                     if (!thisCursor.elementAt().contain(sourceCursor.elementAt())) {
+                        auto copyCursor = thisCursor;
+                        thisCursor.setToPrevious();
+                        removeVersion(copyCursor.elementAt().getVersion());
+                        mcMemory.freeAt(copyCursor);
+                     }
                      sourceCursor.setToNext();
                   }
                };
@@ -493,8 +736,9 @@ class MemoryState : public STG::IOObject {
          }
       }
 
-   DomainValue evaluate(const VirtualExpressionNode& aexpression, struct _Processor* processor,
-         struct _ProcessorFunctions* processorFunctions)
+   // letValues contains the values of the let variables, indexed by their slot
+   DomainValue evaluate(const VirtualExpressionNode& aexpression, const DomainValue* letValues,
+         struct _Processor* processor, struct _ProcessorFunctions* processorFunctions)
       {  switch (aexpression.getTypeExpression()) {
             case VirtualExpressionNode::TERegisterAccess:
                {  const auto& expression = static_cast<const RegisterAccessNode&>(aexpression);
@@ -508,9 +752,9 @@ class MemoryState : public STG::IOObject {
             case VirtualExpressionNode::TEIndirection:
                {  const auto& expression = static_cast<const IndirectionNode&>(aexpression);
                   // [TODO] do it symbolically
-                  DomainValue address = evaluate(expression.getAddress(), processor, processorFunctions);
+                  DomainValue address = evaluate(expression.getAddress(), letValues, processor, processorFunctions);
                   MemoryContent::Cursor cursor(mcMemory);
-                  if (mcMemory.locateKey(address, cursor, COL::VirtualCollection::RPExact))
+                  if (mcMemory.locateKey(normalize(address.value()), cursor, COL::VirtualCollection::RPExact))
                      return cursor.elementAt().getValue();
                   return DomainValue(domainFunctions);
                }
@@ -520,27 +764,106 @@ class MemoryState : public STG::IOObject {
                }
             case VirtualExpressionNode::TEOperation:
                {  const auto& expression = static_cast<const OperationNode&>(aexpression);
-                  DomainValue first = evaluate(expression.getFirst(), processor, processorFunctions);
+                  DomainValue first = evaluate(expression.getFirst(), letValues, processor, processorFunctions);
                   DomainValue second = DomainValue(domainFunctions);
                   if (expression.isBinary())
-                     second = evaluate(expression.getSecond(), processor, processorFunctions);
+                     second = evaluate(expression.getSecond(), letValues, processor, processorFunctions);
                   expression.applyOperation(first, second);
                   return first;
                }
+            case VirtualExpressionNode::TELetAccess:
+               {  const auto& expression = static_cast<const LetAccessNode&>(aexpression);
+                  AssumeCondition(letValues && expression.getSlot() >= 0)
+                  return letValues[expression.getSlot()];
+               }
             default:
                break;
          };
          return DomainValue(DomainElement{}, domainFunctions);
       }
-   MemoryZones& memoryZones() { return mzMemoryZones; }
+   // the zones may be modified by the caller
+   MemoryZones& memoryZones() { uGeneration = newVersion(); return mzMemoryZones; }
+   const uint64_t& getHash() const { return uHash; }
+   const uint64_t& getGeneration() const { return uGeneration; }
+   // exact equality of the entries, decided on the versions without the domain
+   bool isSameAs(const MemoryState& source) const;
+   /* fingerprint of a state whose values and addresses are constants, false
+    * otherwise: two states with the same fingerprint have equal entries.
+    */
+   bool retrieveFingerprint(std::vector<uint64_t>& fingerprint) const;
+
+   /* support for the function summaries */
+   bool hasStoredMemory() const { return fHasStoredMemory; }
+   // invalid value if the register is top
+   DomainValue getRegisterValue(int registerIndex) const
+      {  RegisterContent::Cursor cursor(rcRegisters);
+         if (rcRegisters.locateKey(registerIndex, cursor, COL::VirtualCollection::RPExact))
+            return cursor.elementAt().getValue();
+         return DomainValue(domainFunctions);
+      }
+   // explicit top entries, so that a join with a written register is a change
+   void setTopRegisters(int sizeInBits);
+   void setRegistersFrom(const MemoryState& source, const int* registers, int registersNumber);
+   /* written receives the entries of this state that are not in source with
+    * the same version, removed the entries of source that are no longer in
+    * this state; they form the effect of the code interpreted since source.
+    */
+   void retrieveChangesSince(const MemoryState& source, MemoryState& written,
+         MemoryState& removed) const;
+   void applyChanges(const MemoryState& written, const MemoryState& removed,
+         bool hasClobberedMemory);
+   void clearContent()
+      {  for (RegisterContent::Cursor cursor(rcRegisters); cursor.setToNext(); )
+            removeVersion(cursor.elementAt().getVersion());
+         for (MemoryContent::Cursor cursor(mcMemory); cursor.setToNext(); )
+            removeVersion(cursor.elementAt().getVersion());
+         rcRegisters.freeAll();
+         mcMemory.freeAll();
+      }
+
+   /* support for the forks of Processor::interpret: the zones and the
+    * hypotheses are shared with the contracts and cannot cross the threads,
+    * hence a fork only receives the entries, whose zones are detached into
+    * zones and bound again by moveEntriesFrom on the thread of this state.
+    */
+   void copyEntriesTo(MemoryState& result, DetachedZones& zones) const
+      {  AssumeCondition(uRegisterNumber == result.uRegisterNumber && domainFunctions == result.domainFunctions)
+         result.rcRegisters = rcRegisters;
+         result.mcMemory = mcMemory;
+         for (RegisterContent::Cursor cursor(result.rcRegisters); cursor.setToNext(); )
+            cursor.elementSAt().detachZone(zones);
+         for (MemoryContent::Cursor cursor(result.mcMemory); cursor.setToNext(); )
+            cursor.elementSAt().detachZone(zones);
+         result.uHash = uHash;
+         result.uGeneration = newVersion();
+         result.fHasStoredMemory = fHasStoredMemory;
+      }
+   void moveEntriesFrom(MemoryState& source, const DetachedZones& zones)
+      {  AssumeCondition(uRegisterNumber == source.uRegisterNumber && domainFunctions == source.domainFunctions)
+         rcRegisters.swap(source.rcRegisters);
+         mcMemory.swap(source.mcMemory);
+         if (!zones.empty()) {
+            for (RegisterContent::Cursor cursor(rcRegisters); cursor.setToNext(); )
+               cursor.elementSAt().bindZone(zones);
+            for (MemoryContent::Cursor cursor(mcMemory); cursor.setToNext(); )
+               cursor.elementSAt().bindZone(zones);
+         }
+         std::swap(uHash, source.uHash);
+         std::swap(fHasStoredMemory, source.fHasStoredMemory);
+         uGeneration = newVersion();
+         source.uGeneration = newVersion();
+      }
    // void intersectWith(const VirtualAddressConstraint& contract);
    MemoryModelFunctions* getFunctions() const { return &functions; }
    void write(std::ostream& out) const { out << "end of memory description\n"; }
    const struct _DomainElementFunctions* getDomainFunctions() const { return domainFunctions; }
-   bool contain(const MemoryState& source, const MemoryInterpretParameters& parameters)
-      {  AssumeCondition(uRegisterNumber == source.uRegisterNumber && domainFunctions == source.domainFunctions
+   bool contain(const MemoryState& source, const MemoryInterpretParameters& parameters) const
+      {  Statistics::Timer timer(Statistics::CContain);
+         AssumeCondition(uRegisterNumber == source.uRegisterNumber && domainFunctions == source.domainFunctions
                && sphImplicitHypotheses.isValid() == source.sphImplicitHypotheses.isValid()
                && (!sphImplicitHypotheses.isValid() || sphImplicitHypotheses.key() == source.sphImplicitHypotheses.key()))
+         if (uGeneration == source.uGeneration || isSameAs(source))
+            return true;
          {  RegisterContent::Cursor thisCursor(rcRegisters), sourceCursor(source.rcRegisters);
             sourceCursor.setToFirst();
             while (thisCursor.setToNext()) {
@@ -561,7 +884,7 @@ class MemoryState : public STG::IOObject {
                      sourceCursor.setToNext();
                   }
                   else {
-                     if (!thisCursor.elementSAt().contain(sourceCursor.elementSAt()))
+                     if (!thisCursor.elementAt().contain(sourceCursor.elementAt()))
                         return false;
                      sourceCursor.setToNext();
                   }
@@ -588,7 +911,7 @@ class MemoryState : public STG::IOObject {
                      sourceCursor.setToNext();
                   }
                   else {
-                     if (!thisCursor.elementSAt().contain(sourceCursor.elementSAt()))
+                     if (!thisCursor.elementAt().contain(sourceCursor.elementAt()))
                         return false;
                      sourceCursor.setToNext();
                   }
@@ -597,26 +920,28 @@ class MemoryState : public STG::IOObject {
          }
          return true;
       }
+   /* support for the early exit of Processor::interpret */
+   // contain restricted to registerIndex, a missing entry being top
+   bool containRegister(int registerIndex, const MemoryState& source) const
+      {  RegisterContent::Cursor thisCursor(rcRegisters), sourceCursor(source.rcRegisters);
+         if (!rcRegisters.locateKey(registerIndex, thisCursor, COL::VirtualCollection::RPExact))
+            return true;
+         if (!source.rcRegisters.locateKey(registerIndex, sourceCursor, COL::VirtualCollection::RPExact))
+            return thisCursor.elementAt().isTop();
+         return thisCursor.elementAt().contain(sourceCursor.elementAt());
+      }
+   void retrieveRegisters(std::vector<int>& registers) const
+      {  for (RegisterContent::Cursor cursor(rcRegisters); cursor.setToNext(); )
+            registers.push_back(cursor.elementAt().getRegister());
+      }
    void intersectRegister(int registerIndex, DomainValue&& avalue)
-      {  RegisterContent::Cursor cursor(rcRegisters);
-         auto locationResult = rcRegisters.locateKey(registerIndex, cursor);
-         DomainValueZone value(std::move(avalue), PNT::TSharedPointer<MemoryZone>());
-         if (locationResult)
-            cursor.elementSAt().setValue(std::move(value));
-         else
-            rcRegisters.add(new RegisterValue(registerIndex, std::move(value)),
-                  locationResult.queryInsertionParameters().setFreeOnError(), &cursor);
+      {  DomainValueZone value(std::move(avalue), PNT::TSharedPointer<MemoryZone>());
+         setRegister(registerIndex, std::move(value));
       }
    void intersectMemory(DomainValue&& aaddress, DomainValue&& avalue)
       {  DomainValueZone value(std::move(avalue), PNT::TSharedPointer<MemoryZone>());
          DomainValueZone address(std::move(aaddress), PNT::TSharedPointer<MemoryZone>());
-         MemoryContent::Cursor cursor(mcMemory);
-         auto localize = mcMemory.locateKey(address, cursor);
-         if (localize)
-            cursor.elementSAt().setValue(std::move(value));
-         else
-            mcMemory.add(new MemoryValue(std::move(address), std::move(value)),
-                  localize.queryInsertionParameters().setFreeOnError(), &cursor);
+         setMemory(std::move(address), std::move(value));
       }
 };
 
@@ -647,9 +972,12 @@ class VirtualAddressConstraint
   private:
    typedef PNT::TSharedCollection<BaseLocation, HandlerCast<BaseLocation, PNT::SharedCollection::Element> > inherited;
    Expression eConstraint; 
-   STG::SubString ssZoneName = STG::SString();
+   Atom atZoneName;
 
   protected:
+   // first point of the parsing and writing states left to readFromKey and writeToKey
+   static const int UInheritedPoint = 16;
+
    virtual bool readFromKey(const STG::SubString& key, STG::JSon::CommonParser::State& state,
          STG::JSon::CommonParser::Arguments& arguments, ReadResult& result) { return false; }
    virtual bool writeToKey(STG::JSon::CommonWriter::State& state,
@@ -657,8 +985,12 @@ class VirtualAddressConstraint
 
    const Expression& getConstraint() const { return eConstraint; }
    DomainValue evaluateInMemory(MemoryState& memoryState, const Expression& expression,
+         const std::vector<DomainValue>& letValues,
          struct _Processor* processor, struct _ProcessorFunctions* processorFunctions)
-      {  return memoryState.evaluate(expression.getContent(), processor, processorFunctions); }
+      {  Statistics::Timer timer(Statistics::CExpressionEvaluation);
+         return memoryState.evaluate(expression.getContent(), letValues.data(),
+               processor, processorFunctions);
+      }
 
   public:
    VirtualAddressConstraint() = default;
@@ -666,10 +998,17 @@ class VirtualAddressConstraint
    DefineCopy(VirtualAddressConstraint)
    StaticInheritConversions(VirtualAddressConstraint, inherited)
 
+   /* letValues receives the values of the let variables of the contract in
+    * the order of their definition.
+    */
    virtual bool apply(MemoryState& memoryState, uint64_t startAddress,
+         std::vector<DomainValue>& letValues,
          struct _Processor* processor, struct _ProcessorFunctions* processorFunctions) { return true; }
    virtual bool isRegister() const { return false; }
    virtual bool isIndirect() const { return false; }
+   virtual bool isLet() const { return false; }
+   virtual bool setLetSlots(const std::vector<Atom>& letNames)
+      {  return eConstraint.setLetSlots(letNames); }
    ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments);
    WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const;
 };
@@ -689,9 +1028,10 @@ class RegisterConstraint : public VirtualAddressConstraint {
    RegisterConstraint(const RegisterConstraint&) = default;
 
    virtual bool apply(MemoryState& memoryState, uint64_t startAddress,
+         std::vector<DomainValue>& letValues,
          struct _Processor* processor, struct _ProcessorFunctions* processorFunctions) override
       {  memoryState.intersectRegister(uRegisterIndex,
-            evaluateInMemory(memoryState, getConstraint(), processor, processorFunctions));
+            evaluateInMemory(memoryState, getConstraint(), letValues, processor, processorFunctions));
          return true;
       }
    virtual bool isRegister() const override { return true; }
@@ -712,18 +1052,50 @@ class IndirectAddressConstraint : public VirtualAddressConstraint {
    IndirectAddressConstraint(const IndirectAddressConstraint&) = default;
 
    virtual bool apply(MemoryState& memoryState, uint64_t startAddress,
+         std::vector<DomainValue>& letValues,
          struct _Processor* processor, struct _ProcessorFunctions* processorFunctions) override
       {  memoryState.intersectMemory(
-            evaluateInMemory(memoryState, eAddress, processor, processorFunctions),
-            evaluateInMemory(memoryState, getConstraint(), processor, processorFunctions));
+            evaluateInMemory(memoryState, eAddress, letValues, processor, processorFunctions),
+            evaluateInMemory(memoryState, getConstraint(), letValues, processor, processorFunctions));
          return true;
       }
    virtual bool isIndirect() const override { return true; }
+   virtual bool setLetSlots(const std::vector<Atom>& letNames) override
+      {  return VirtualAddressConstraint::setLetSlots(letNames) && eAddress.setLetSlots(letNames); }
+};
+
+/* A let variable is evaluated once per application of the contract, at the
+ * place of its definition. The next constraints refer to it by its slot
+ * instead of evaluating again the shared sub-term.
+ */
+class LetConstraint : public VirtualAddressConstraint {
+  private:
+   Atom atName;
+
+  protected:
+   virtual bool readFromKey(const STG::SubString& key, STG::JSon::CommonParser::State& state,
+         STG::JSon::CommonParser::Arguments& arguments, ReadResult& result) override;
+   virtual bool writeToKey(STG::JSon::CommonWriter::State& state,
+         STG::JSon::CommonWriter::Arguments& arguments, WriteResult& result) const override;
+
+  public:
+   LetConstraint() = default;
+   LetConstraint(const LetConstraint&) = default;
+
+   const Atom& getName() const { return atName; }
+   virtual bool apply(MemoryState& memoryState, uint64_t startAddress,
+         std::vector<DomainValue>& letValues,
+         struct _Processor* processor, struct _ProcessorFunctions* processorFunctions) override
+      {  letValues.push_back(evaluateInMemory(memoryState, getConstraint(), letValues,
+            processor, processorFunctions));
+         return true;
+      }
+   virtual bool isLet() const override { return true; }
 };
 
 class MemoryStateConstraint : public COL::TCopyCollection<COL::TArray<VirtualAddressConstraint> >, public STG::IOObject, public STG::Lexer::Base {
   public:
-   enum TypeConstraint { TCUndefined, TCRegister, TCIndirect };
+   enum TypeConstraint { TCUndefined, TCRegister, TCIndirect, TCLet };
    struct ReadRuleResult : public VirtualAddressConstraint::ReadRuleResult {
       TypeConstraint type = TCUndefined;
       ReadRuleResult() = default;
@@ -744,11 +1116,15 @@ class MemoryStateConstraint : public COL::TCopyCollection<COL::TArray<VirtualAdd
    };
 
   private:
+   int uLetsNumber = 0;
+
    static void setTypeConstraintFromText(TypeConstraint& type, const STG::SubString& text)
       {  if (text == "register")
             type = TCRegister;
          else if (text == "indirect")
             type = TCIndirect;
+         else if (text == "let")
+            type = TCLet;
       }
    static PNT::PassPointer<VirtualAddressConstraint> newAddressConstraint(TypeConstraint type)
       {  PNT::PassPointer<VirtualAddressConstraint> result;
@@ -759,6 +1135,9 @@ class MemoryStateConstraint : public COL::TCopyCollection<COL::TArray<VirtualAdd
             case TCIndirect:
                result.absorbElement(new IndirectAddressConstraint());
                break;
+            case TCLet:
+               result.absorbElement(new LetConstraint());
+               break;
             default:
                break;
          }
@@ -769,8 +1148,11 @@ class MemoryStateConstraint : public COL::TCopyCollection<COL::TArray<VirtualAdd
             return STG::SString("register");
          else if (constraint.isIndirect())
             return STG::SString("indirect");
+         else if (constraint.isLet())
+            return STG::SString("let");
          return STG::SString();
       }
+   bool setLetSlots();
 
   public:
    MemoryStateConstraint() = default;
@@ -778,11 +1160,15 @@ class MemoryStateConstraint : public COL::TCopyCollection<COL::TArray<VirtualAdd
 
    void apply(MemoryState& memoryState, uint64_t startAddress, struct _Processor* processor,
          struct _ProcessorFunctions* processorFunctions)
-      {  Cursor cursor(*this);
+      {  std::vector<DomainValue> letValues;
+         letValues.reserve(uLetsNumber);
+         Cursor cursor(*this);
          while (cursor.setToNext())
-            cursor.elementSAt().apply(memoryState, startAddress, processor, processorFunctions);
+            cursor.elementSAt().apply(memoryState, startAddress, letValues, processor, processorFunctions);
       }
    ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments);
    WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const;
 };
 
+#include "StandardClasses/UndefineNew.h"
+#undef DefineAllocationRegion
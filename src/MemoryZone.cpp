@@ -1,6 +1,9 @@
 #include "MemoryZone.h"
 #include "Collection/Collection.template"
 
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
+
 STG::Lexer::Base::ReadResult
 MemoryZoneCreate::readJSon(STG::JSon::CommonParser::State& state,
       STG::JSon::CommonParser::Arguments& arguments) {
@@ -23,7 +26,7 @@ MemoryZoneCreate::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
    }
    ++state.point();
@@ -81,7 +84,7 @@ LAfterLength:
 LName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssName = arguments.valueAsText();
+            atName = arguments.valueAsText();
          }
          state.point() = DAfterBegin;
          if (!arguments.setToNextToken(result)) return result;
@@ -143,7 +146,7 @@ LBeforeName:
    if (!arguments.writeEvent(result)) return result;
 
 LName:
-   arguments.setStringValue(ssName);
+   arguments.setStringValue(atName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -174,7 +177,7 @@ MemoryZoneRename::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
    }
    ++state.point();
@@ -195,7 +198,7 @@ LAfterBegin:
 LOldName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssOldName = arguments.valueAsText();
+            atOldName = arguments.valueAsText();
          }
          state.point() = DAfterBegin;
       }
@@ -210,7 +213,7 @@ LOldName:
 LNewName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssNewName = arguments.valueAsText();
+            atNewName = arguments.valueAsText();
          }
          state.point() = DAfterBegin;
       }
@@ -253,7 +256,7 @@ LBeforeOldName:
    if (!arguments.writeEvent(result)) return result;
 
 LOldName:
-   arguments.setStringValue(ssOldName);
+   arguments.setStringValue(atOldName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -263,7 +266,7 @@ LBeforeNewName:
    if (!arguments.writeEvent(result)) return result;
 
 LNewName:
-   arguments.setStringValue(ssNewName);
+   arguments.setStringValue(atNewName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -296,7 +299,7 @@ MemoryZoneSplit::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
    }
    ++state.point();
@@ -336,7 +339,7 @@ LAfterStart:
 LOldName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssOldName = arguments.valueAsText();
+            atOldName = arguments.valueAsText();
          }
          state.point() = DAfterBegin;
          if (!arguments.setToNextToken(result)) return result;
@@ -353,7 +356,7 @@ LOldName:
 LNewName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssNewName = arguments.valueAsText();
+            atNewName = arguments.valueAsText();
          }
          state.point() = DAfterBegin;
          if (!arguments.setToNextToken(result)) return result;
@@ -408,7 +411,7 @@ LBeforeOldName:
    if (!arguments.writeEvent(result)) return result;
 
 LOldName:
-   arguments.setStringValue(ssOldName);
+   arguments.setStringValue(atOldName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -418,7 +421,7 @@ LBeforeNewName:
    if (!arguments.writeEvent(result)) return result;
 
 LNewName:
-   arguments.setStringValue(ssNewName);
+   arguments.setStringValue(atNewName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -450,7 +453,7 @@ MemoryZoneMerge::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenObject()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '{'")))
+      if (!arguments.addErrorMessage("expected '{'"))
          return result;
    }
    ++state.point();
@@ -472,7 +475,7 @@ LAfterBegin:
 LFirstName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssFirstName = arguments.valueAsText();
+            atFirstName = arguments.valueAsText();
          }
          else {
             state.point() = DAfterBegin;
@@ -493,7 +496,7 @@ LFirstName:
 LSecondName:
          if (arguments.isSetString()) {
             if (arguments.setArgumentTextValue() == RRNeedChars) return RRNeedChars;
-            ssSecondName = arguments.valueAsText();
+            atSecondName = arguments.valueAsText();
          }
          else {
             state.point() = DAfterBegin;
@@ -543,7 +546,7 @@ LBeforeFirstName:
    if (!arguments.writeEvent(result)) return result;
 
 LFirstName:
-   arguments.setStringValue(ssFirstName);
+   arguments.setStringValue(atFirstName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -553,7 +556,7 @@ LBeforeSecondName:
    if (!arguments.writeEvent(result)) return result;
 
 LSecondName:
-   arguments.setStringValue(ssSecondName);
+   arguments.setStringValue(atSecondName.getName());
    ++state.point();
    if (!arguments.writeEvent(result)) return result;
 
@@ -565,32 +568,73 @@ LEnd:
 }
 
 void
-MemoryZoneMerge::apply(MemoryZones& zones, uint64_t startAddress) {
-   MemoryZones::Cursor cursor(zones), otherCursor(zones);
-   bool hasFirst = false, hasSecond = false;
-   while (cursor.setToNext() && (!hasFirst || !hasSecond)) {
-      auto& zone = cursor.elementSAt();
-      if (!hasFirst && zone.getName() == ssFirstName) {
-         hasFirst = true;
-         if (hasSecond) {
-            cursor.elementSAt().mergeWith(std::move(otherCursor.elementSAt()));
-            zones.freeAt(otherCursor);
-            return;
-         }
-         else
-            otherCursor = cursor;
+MemoryZones::unindexName(const MemoryZone& zone) {
+   if (!zone.getName().isValid())
+      return;
+   auto found = umNameIndex.find(zone.getName().getId());
+   AssumeCondition(found != umNameIndex.end())
+   if (--found->second.count == 0) {
+      umNameIndex.erase(found);
+      return;
+   };
+   if (found->second.zone != &zone)
+      return;
+   // another zone has the same name: the index points to the one with the smallest id
+   for (auto& other : *this)
+      if (&other != &zone && other.getName() == zone.getName()) {
+         found->second.zone = &other;
+         break;
+      };
+}
+
+void
+MemoryZones::mergeWith(MemoryZones& source) {
+   Cursor thisCursor(*this), sourceCursor(source);
+   sourceCursor.setToFirst();
+   while (thisCursor.setToNext()) {
+      if (!sourceCursor.isValid()) {
+         auto copyCursor = thisCursor;
+         thisCursor.setToPrevious();
+         unindexZone(copyCursor.elementAt());
+         freeAt(copyCursor);
       }
-      else if (!hasSecond && zone.getName() == ssSecondName) {
-         hasSecond = true;
-         if (hasFirst) {
-            otherCursor.elementSAt().mergeWith(std::move(cursor.elementSAt()));
-            zones.freeAt(cursor);
-            return;
+      else {
+         ComparisonResult compare = MemoryZone::Key::compare(
+               MemoryZone::Key::key(thisCursor.elementAt()),
+               MemoryZone::Key::key(sourceCursor.elementAt()));
+         if (compare == CRLess) {
+            auto copyCursor = thisCursor;
+            thisCursor.setToPrevious();
+            unindexZone(copyCursor.elementAt());
+            freeAt(copyCursor);
          }
-         else
-            otherCursor = cursor;
-      }
+         else if (compare == CRGreater)
+            sourceCursor.setToNext();
+         else {
+            thisCursor.elementSAt().mergeWith(std::move(sourceCursor.elementSAt()));
+            sourceCursor.setToNext();
+         }
+      };
    };
+   source.rebuildIndexes();
+}
+
+void
+MemoryZoneMerge::apply(MemoryZones& zones, uint64_t startAddress) {
+   MemoryZone* first = zones.searchZone(atFirstName);
+   MemoryZone* second = first ? zones.searchZone(atSecondName) : nullptr;
+   if (second == first && second) {
+      // same name: the zone with the next id, the zones are sorted by id
+      second = nullptr;
+      for (auto& zone : zones)
+         if (&zone != first && zone.getName() == atSecondName) {
+            second = &zone;
+            break;
+         }
+   }
+   if (!second)
+      return;
+   zones.mergeZones(*first, *second);
 }
 
 STG::Lexer::Base::ReadResult
@@ -615,7 +659,7 @@ MemoryZoneModifier::readJSon(STG::JSon::CommonParser::State& state,
 
 LBegin:
    if (!arguments.isOpenArray()) {
-      if (!arguments.addErrorMessage(STG::SString("expected '['")))
+      if (!arguments.addErrorMessage("expected '['"))
          return result;
    }
    ++state.point();
@@ -755,10 +799,13 @@ LWriteContent:
       if (!arguments.writeTokens(state, result)) return result;
 
 LEndContent:
+      arguments.setCloseObject();
       state.point() = DAfterBegin;
+      if (!arguments.writeEvent(result)) return result;
       if (!cursor)
          cursor = &*state.getSResult((WriteRuleResult*) nullptr);
    }
+   state.point() = DEnd;
 
 LEnd:
    arguments.setCloseArray();
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Expression.h"
+#include <unordered_map>
+
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
 
 class MemoryZone;
 class MemoryZonePool : public PNT::SharedElement {
@@ -34,7 +38,7 @@ class MemoryZone : public PNT::SharedElement, public STG::IOObject {
    uint64_t uStartAddressInCode = 0;
    Expression eStartAddress;
    Expression eLength;
-   STG::SubString ssName = STG::SString();
+   Atom atName;
 
   public:
    MemoryZone() : spPool(new MemoryZonePool(), PNT::Pointer::Init())
@@ -42,10 +46,10 @@ class MemoryZone : public PNT::SharedElement, public STG::IOObject {
    MemoryZone(MemoryZonePool& pool) : spPool(&pool, PNT::Pointer::Init())
       {  uZoneId = spPool->generateNewId(); }
    MemoryZone(MemoryZonePool& pool, uint64_t startAddressInCode,
-         const STG::SubString& name, Expression&& start, Expression&& length)
+         const Atom& name, Expression&& start, Expression&& length)
       :  uZoneId(pool.generateNewId()), spPool(&pool, PNT::Pointer::Init()),
          uStartAddressInCode(startAddressInCode), eStartAddress(std::move(start)),
-         eLength(std::move(length)), ssName(name) {}
+         eLength(std::move(length)), atName(name) {}
    MemoryZone(const MemoryZone& source) = default;
    DefineCopy(MemoryZone)
    StaticInheritConversions(MemoryZone, PNT::SharedElement)
@@ -53,27 +57,27 @@ class MemoryZone : public PNT::SharedElement, public STG::IOObject {
    virtual bool isValid() const override { return uZoneId > 0; }
    const int& getId() const { return uZoneId; }
    MemoryZonePool& getPool() const { return *spPool; }
-   const STG::SubString& getName() const { return ssName; }
+   const Atom& getName() const { return atName; }
 
    void initialize(uint64_t startAddressInCode,
-         const STG::SubString& name, Expression&& start, Expression&& length)
+         const Atom& name, Expression&& start, Expression&& length)
       {  AssumeCondition(uZoneId == 0);
          uZoneId = spPool->generateNewId();
          uStartAddressInCode = startAddressInCode;
          eStartAddress = std::move(start);
          eLength = std::move(length);
-         ssName = name;
+         atName = name;
       }
    void clear()
       {  uZoneId = 0;
          uStartAddressInCode = 0;
          eStartAddress.clear();
          eLength.clear();
-         ssName.clear();
+         atName.clear();
       }
-   void rename(const STG::SubString& newName) { ssName = newName; }
+   void rename(const Atom& newName) { atName = newName; }
    PNT::PassPointer<MemoryZone> newZoneFromSplit(uint64_t startAddressInCode,
-         const STG::SubString& name, Expression&& start)
+         const Atom& name, Expression&& start)
       {  Expression newLength(eLength);
          eLength = start;
          eLength -= eStartAddress;
@@ -100,37 +104,100 @@ class MemoryZone : public PNT::SharedElement, public STG::IOObject {
 };
 
 class MemoryZones : public COL::TCopyCollection<COL::TSortedArray<MemoryZone, MemoryZone::Key> > {
-  public:
-   MemoryZones() = default;
-   MemoryZones(const MemoryZones&) = default;
-
-   void mergeWith(MemoryZones& source)
-      {  Cursor thisCursor(*this), sourceCursor(source);
-         sourceCursor.setToFirst();
-         while (thisCursor.setToNext()) {
-            if (!sourceCursor.isValid()) {
-               auto copyCursor = thisCursor;
-               thisCursor.setToPrevious();
-               freeAt(copyCursor);
-            }
-            else {
-               ComparisonResult compare = MemoryZone::Key::compare(
-                     MemoryZone::Key::key(thisCursor.elementAt()),
-                     MemoryZone::Key::key(sourceCursor.elementAt()));
-               if (compare == CRLess) {
-                  auto copyCursor = thisCursor;
-                  thisCursor.setToPrevious();
-                  freeAt(copyCursor);
-               }
-               else if (compare == CRGreater)
-                  sourceCursor.setToNext();
-               else {
-                  thisCursor.elementSAt().mergeWith(std::move(sourceCursor.elementSAt()));
-                  sourceCursor.setToNext();
-               }
+  private:
+   typedef COL::TCopyCollection<COL::TSortedArray<MemoryZone, MemoryZone::Key> > inherited;
+   // secondary indexes: the zones stay owned by the sorted array
+   std::unordered_map<int, MemoryZone*> umIdIndex;   // zone id -> zone
+   struct NameEntry {
+      MemoryZone* zone; // zone with the smallest id among the ones with this name
+      int count;
+
+      NameEntry(MemoryZone* azone) : zone(azone), count(1) {}
+   };
+   std::unordered_map<int, NameEntry> umNameIndex; // name atom -> zones
+
+   void indexZone(MemoryZone& zone)
+      {  umIdIndex[zone.getId()] = &zone;
+         if (zone.getName().isValid()) {
+            auto insertion = umNameIndex.insert(std::make_pair(zone.getName().getId(), NameEntry(&zone)));
+            if (!insertion.second) {
+               ++insertion.first->second.count;
+               if (insertion.first->second.zone->getId() > zone.getId())
+                  insertion.first->second.zone = &zone;
             };
          };
       }
+   void unindexName(const MemoryZone& zone);
+   void unindexZone(const MemoryZone& zone)
+      {  umIdIndex.erase(zone.getId());
+         unindexName(zone);
+      }
+   void rebuildIndexes()
+      {  umIdIndex.clear();
+         umNameIndex.clear();
+         for (auto& zone : *this)
+            indexZone(zone);
+      }
+
+  public:
+   MemoryZones() = default;
+   MemoryZones(MemoryZones&& source)
+      :  inherited(std::move(source)), umIdIndex(std::move(source.umIdIndex)),
+         umNameIndex(std::move(source.umNameIndex)) {}
+   MemoryZones(const MemoryZones& source) : inherited(source) { rebuildIndexes(); }
+   MemoryZones& operator=(MemoryZones&& source)
+      {  inherited::operator=(std::move(source));
+         umIdIndex = std::move(source.umIdIndex);
+         umNameIndex = std::move(source.umNameIndex);
+         source.umIdIndex.clear();
+         source.umNameIndex.clear();
+         return *this;
+      }
+   MemoryZones& operator=(const MemoryZones& source)
+      {  inherited::operator=(source);
+         rebuildIndexes();
+         return *this;
+      }
+
+   void swap(MemoryZones& source)
+      {  inherited::swap(source);
+         umIdIndex.swap(source.umIdIndex);
+         umNameIndex.swap(source.umNameIndex);
+      }
+   MemoryZone* searchZone(const Atom& name) const
+      {  auto found = umNameIndex.find(name.getId());
+         return (found != umNameIndex.end()) ? found->second.zone : nullptr;
+      }
+   MemoryZone* searchZoneById(int id) const
+      {  auto found = umIdIndex.find(id);
+         return (found != umIdIndex.end()) ? found->second : nullptr;
+      }
+
+   void insertNewZone(MemoryZone* zone)
+      {  insertNewAtEnd(zone);
+         indexZone(*zone);
+      }
+   void renameZone(MemoryZone& zone, const Atom& newName)
+      {  unindexName(zone);
+         zone.rename(newName);
+         indexZone(zone);
+      }
+   void freeZone(MemoryZone& zone)
+      {  unindexZone(zone);
+         Cursor cursor(*this);
+         if (locateKey(zone.getId(), cursor, COL::VirtualCollection::RPExact))
+            freeAt(cursor);
+      }
+   // second is located and unindexed before its merge clears its id and its name
+   void mergeZones(MemoryZone& first, MemoryZone& second)
+      {  Cursor cursor(*this);
+         bool isFound = locateKey(second.getId(), cursor, COL::VirtualCollection::RPExact);
+         AssumeCondition(isFound && &first != &second)
+         unindexZone(second);
+         first.mergeWith(std::move(second));
+         freeAt(cursor);
+      }
+   void mergeWith(MemoryZones& source);
 };
 
 class MemoryZoneAction : public STG::IOObject, public STG::Lexer::Base {
@@ -155,7 +222,7 @@ class MemoryZoneCreate : public MemoryZoneAction {
   private:
    Expression eStartAddress;
    Expression eLength;
-   STG::SubString ssName = STG::SString();
+   Atom atName;
 
   public:
    MemoryZoneCreate() = default;
@@ -164,12 +231,10 @@ class MemoryZoneCreate : public MemoryZoneAction {
 
    virtual TypeAction getType() const override { return TACreate; }
    virtual void apply(MemoryZones& zones, uint64_t startAddress) override
-      {  MemoryZone* newZone;
-         if (zones.isEmpty())
-            zones.insertNewAtEnd(newZone = new MemoryZone());
-         else
-            zones.insertNewAtEnd(newZone = new MemoryZone(zones.getFirst().getPool()));
-         newZone->initialize(startAddress, ssName, Expression(eStartAddress), Expression(eLength));
+      {  MemoryZonePool* pool = zones.isEmpty() ? new MemoryZonePool()
+               : &zones.getFirst().getPool();
+         zones.insertNewZone(new MemoryZone(*pool, startAddress, atName,
+               Expression(eStartAddress), Expression(eLength)));
       }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) override;
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const override;
@@ -177,8 +242,8 @@ class MemoryZoneCreate : public MemoryZoneAction {
 
 class MemoryZoneRename : public MemoryZoneAction {
   private:
-   STG::SubString ssOldName = STG::SString();
-   STG::SubString ssNewName = STG::SString();
+   Atom atOldName;
+   Atom atNewName;
 
   public:
    MemoryZoneRename() = default;
@@ -187,11 +252,8 @@ class MemoryZoneRename : public MemoryZoneAction {
 
    virtual TypeAction getType() const override { return TARename; }
    virtual void apply(MemoryZones& zones, uint64_t startAddress) override
-      {  for (auto& zone : zones)
-            if (zone.getName() == ssOldName) {
-               zone.rename(ssNewName);
-               break;
-            }
+      {  if (MemoryZone* zone = zones.searchZone(atOldName))
+            zones.renameZone(*zone, atNewName);
       }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) override;
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const override;
@@ -200,8 +262,8 @@ class MemoryZoneRename : public MemoryZoneAction {
 class MemoryZoneSplit : public MemoryZoneAction {
   private:
    Expression eNewStartAddress;
-   STG::SubString ssOldName = STG::SString();
-   STG::SubString ssNewName = STG::SString();
+   Atom atOldName;
+   Atom atNewName;
 
   public:
    MemoryZoneSplit() = default;
@@ -210,12 +272,10 @@ class MemoryZoneSplit : public MemoryZoneAction {
 
    virtual TypeAction getType() const override { return TASplit; }
    virtual void apply(MemoryZones& zones, uint64_t startAddress) override
-      {  for (auto& zone : zones)
-            if (zone.getName() == ssOldName) {
-               auto newZone = zone.newZoneFromSplit(startAddress, ssNewName, Expression(eNewStartAddress));
-               zones.insertNewAtEnd(newZone.extractElement());
-               break;
-            }
+      {  if (MemoryZone* zone = zones.searchZone(atOldName)) {
+            auto newZone = zone->newZoneFromSplit(startAddress, atNewName, Expression(eNewStartAddress));
+            zones.insertNewZone(newZone.extractElement());
+         };
       }
    virtual ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments) override;
    virtual WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const override;
@@ -223,8 +283,8 @@ class MemoryZoneSplit : public MemoryZoneAction {
 
 class MemoryZoneMerge : public MemoryZoneAction {
   private:
-   STG::SubString ssFirstName = STG::SString();
-   STG::SubString ssSecondName = STG::SString();
+   Atom atFirstName;
+   Atom atSecondName;
 
   public:
    MemoryZoneMerge() = default;
@@ -307,3 +367,6 @@ class MemoryZoneModifier : public STG::IOObject, public STG::Lexer::Base {
    ReadResult readJSon(STG::JSon::CommonParser::State& state, STG::JSon::CommonParser::Arguments& arguments);
    WriteResult writeJSon(STG::JSon::CommonWriter::State& state, STG::JSon::CommonWriter::Arguments& arguments) const;
 };
+
+#include "StandardClasses/UndefineNew.h"
+#undef DefineAllocationRegion
@@ -1,10 +1,19 @@
 #include "Processor.h"
+#include "Statistics.h"
+#include "Trace.h"
 #include <unistd.h>
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 
 void
 Processor::setFromFile(const char* filename) {
    AssumeCondition(!pvContent)
+   sArchitectureFilename = filename;
    dlProcessorLibrary.setFromFile(filename);
    if (!(bool) dlProcessorLibrary) {
       char cwd[1024];
@@ -21,10 +30,96 @@ Processor::setFromFile(const char* filename) {
    pvContent = (*architectureFunctions.create_processor)();
 }
 
+namespace {
+
+/* Clone, free, merge and compare are called through these timing functions,
+ * by the checker and by the decoder alike. The wrappers cannot carry the
+ * library they forward to: each of the first CountedDomainLibraries domain
+ * libraries has its own instance of them.
+ */
+struct CountedDomainFunctions {
+   decltype(_DomainElementFunctions::clone) clone = nullptr;
+   decltype(_DomainElementFunctions::free) free = nullptr;
+   decltype(_DomainElementFunctions::merge) merge = nullptr;
+   decltype(_DomainElementFunctions::compare) compare = nullptr;
+
+   bool isEqual(const _DomainElementFunctions& functions) const
+      {  return clone == functions.clone && free == functions.free
+            && merge == functions.merge && compare == functions.compare;
+      }
+};
+
+const int CountedDomainLibraries = 4;
+CountedDomainFunctions countedDomainFunctions[CountedDomainLibraries];
+std::mutex countedDomainLock;
+
+template <int Library>
+DomainElement
+countedClone(DomainElement element) {
+   Statistics::Timer timer(Statistics::CDomainClone);
+   return (*countedDomainFunctions[Library].clone)(element);
+}
+
+template <int Library>
+void
+countedFree(DomainElement* element) {
+   Statistics::Timer timer(Statistics::CDomainFree);
+   (*countedDomainFunctions[Library].free)(element);
+}
+
+template <int Library>
+bool
+countedMerge(DomainElement* element, DomainElement source, DomainEvaluationEnvironment* env) {
+   Statistics::Timer timer(Statistics::CDomainMerge);
+   return (*countedDomainFunctions[Library].merge)(element, source, env);
+}
+
+template <int Library>
+int
+countedCompare(DomainElement element, DomainElement source) {
+   Statistics::Timer timer(Statistics::CDomainCompare);
+   return (*countedDomainFunctions[Library].compare)(element, source);
+}
+
+template <int Library>
+void
+setCountedFunctions(struct _DomainElementFunctions& functions) {
+   functions.clone = &countedClone<Library>;
+   functions.free = &countedFree<Library>;
+   functions.merge = &countedMerge<Library>;
+   functions.compare = &countedCompare<Library>;
+}
+
+void (* const countedFunctionsSetters[CountedDomainLibraries])(struct _DomainElementFunctions&)
+   = { &setCountedFunctions<0>, &setCountedFunctions<1>, &setCountedFunctions<2>,
+       &setCountedFunctions<3> };
+
+// the domain functions of a library beyond CountedDomainLibraries are left uncounted
+void
+setCountedDomainFunctions(struct _DomainElementFunctions& functions) {
+   std::lock_guard<std::mutex> lock(countedDomainLock);
+   for (int library = 0; library < CountedDomainLibraries; ++library) {
+      CountedDomainFunctions& counted = countedDomainFunctions[library];
+      if (!counted.clone) {
+         counted.clone = functions.clone;
+         counted.free = functions.free;
+         counted.merge = functions.merge;
+         counted.compare = functions.compare;
+      }
+      if (counted.isEqual(functions)) {
+         (*countedFunctionsSetters[library])(functions);
+         return;
+      }
+   }
+}
+
+}
+
 void
 Processor::setDomainFunctionsFromFile(const char* domainFilename) {
    AssumeCondition(pvContent)
    struct _DomainElementFunctions domainFunctions;
+   sDomainFilename = domainFilename;
    dlDomainLibrary.setFromFile(domainFilename);
    if (!(bool) dlDomainLibrary) {
       char cwd[1024];
@@ -128,6 +223,7 @@ Processor::setDomainFunctionsFromFile(const char* domainFilename) {
    dlDomainLibrary.loadSymbol("domain_create_disjunction_and_absorb", &domainFunctions.create_disjunction_and_absorb);
    dlDomainLibrary.loadSymbol("domain_disjunction_absorb", &domainFunctions.disjunction_absorb);
    dlDomainLibrary.loadSymbol("domain_specialize", &domainFunctions.specialize);
+   setCountedDomainFunctions(domainFunctions);
    (*architectureFunctions.set_domain_functions)(pvContent, &domainFunctions);
 }
 
@@ -135,6 +231,26 @@ bool
 Processor::retrieveNextTargets(uint64_t address, MemoryState& memoryState,
       TargetAddresses& targetAddresses, DecisionVector& decisionVector,
       MemoryInterpretParameters& parameters) {
+   std::vector<uint64_t> stopAddresses;
+   stopAddresses.reserve(targetAddresses.addresses_length);
+   if (targetAddresses.addresses_length >= 1) {
+      for (int index = 0; index < targetAddresses.addresses_length; ++index) {
+         stopAddresses.push_back(targetAddresses.addresses[index]);
+         targetAddresses.addresses[index] = 0;
+      }
+      targetAddresses.addresses_length = 0;
+   }
+   if (fUseBlockPartition)
+      return retrieveNextTargetsFromPartition(address, memoryState, targetAddresses,
+            decisionVector, parameters, stopAddresses);
+   return decodeNextTargets(address, memoryState, targetAddresses, decisionVector,
+         parameters, stopAddresses);
+}
+
+bool
+Processor::decodeNextTargets(uint64_t address, MemoryState& memoryState,
+      TargetAddresses& targetAddresses, DecisionVector& decisionVector,
+      MemoryInterpretParameters& parameters, const std::vector<uint64_t>& stopAddresses) {
    if ((uint64_t) fBinaryFile.tellg() != address-uLoaderAllocShift) {
       fBinaryFile.seekg(address-uLoaderAllocShift);
       if (!fBinaryFile.good())
@@ -143,28 +259,32 @@ Processor::retrieveNextTargets(uint64_t address, MemoryState& memoryState,
    static const int BufferSize = 1000;
    char instructionBuffer[BufferSize];
    int length = fBinaryFile.readsome(instructionBuffer, BufferSize);
+   Statistics::local().addRead(length);
    if (length <= 0)
       return false;
 
    char* instruction = instructionBuffer;
    char* nextInstruction = instructionBuffer;
 
-   std::vector<uint64_t> stopAddresses;
-   stopAddresses.reserve(targetAddresses.addresses_length);
-   if (targetAddresses.addresses_length >= 1) {
-      for (int index = 0; index < targetAddresses.addresses_length; ++index) {
-         stopAddresses.push_back(targetAddresses.addresses[index]);
-         targetAddresses.addresses[index] = 0;
-      }
-      targetAddresses.addresses_length = 0;
-   }
    while (length > 0) {
-      bool isValid = (*architectureFunctions.processor_next_targets)(pvContent,
-            nextInstruction, length, address, &targetAddresses,
-            reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
-            decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+      bool isValid;
+      {  Statistics::Timer timer(Statistics::CNextTargets);
+         Trace::Scope trace("processor_next_targets", Trace::currentContract(), address);
+         isValid = (*architectureFunctions.processor_next_targets)(pvContent,
+               nextInstruction, length, address, &targetAddresses,
+               reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
+               decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+      }
       AssumeCondition(isValid)
       if (targetAddresses.addresses_length == 1) {
+         uint64_t callee = 0, returnAddress = 0;
+         const int* argumentRegisters = nullptr;
+         int argumentRegistersLength = 0;
+         if (architectureFunctions.processor_get_call
+               && (*architectureFunctions.processor_get_call)(pvContent, nextInstruction, length,
+                  address, &callee, &returnAddress, &argumentRegisters, &argumentRegistersLength))
+            // the block goes on after the call
+            targetAddresses.addresses[0] = returnAddress;
          for (const auto& stopAddress : stopAddresses)
             if (targetAddresses.addresses[0] == stopAddress)
                return true;
@@ -176,6 +296,7 @@ Processor::retrieveNextTargets(uint64_t address, MemoryState& memoryState,
             }
          length -= (nextInstruction-instruction);
          address += (nextInstruction-instruction);
+         Statistics::local().addDecodedBytes(nextInstruction-instruction);
          if (length <= 20 || length > BufferSize) {
             if ((uint64_t) fBinaryFile.tellg() != address-uLoaderAllocShift) {
                fBinaryFile.seekg(address-uLoaderAllocShift);
@@ -183,6 +304,7 @@ Processor::retrieveNextTargets(uint64_t address, MemoryState& memoryState,
                   return false;
             }
             length = fBinaryFile.readsome(instructionBuffer, BufferSize);
+            Statistics::local().addRead(length);
             if (length <= 0)
                return false;
             instruction = nextInstruction = instructionBuffer;
@@ -199,31 +321,208 @@ Processor::retrieveNextTargets(uint64_t address, MemoryState& memoryState,
    return false;
 }
 
+bool
+Processor::loadCode() {
+   if (bpPartition.hasCode())
+      return true;
+   fBinaryFile.clear();
+   fBinaryFile.seekg(0, std::ios::end);
+   std::streamoff size = fBinaryFile.tellg();
+   if (size <= 0)
+      return false;
+   std::vector<char> code((size_t) size);
+   fBinaryFile.seekg(0);
+   fBinaryFile.read(&code[0], size);
+   Statistics::local().addRead((int) fBinaryFile.gcount());
+   fBinaryFile.clear();
+   if (fBinaryFile.gcount() != size)
+      return false;
+   bpPartition.setCode(std::move(code), uLoaderAllocShift);
+   return true;
+}
+
 void
+Processor::exploreBlocks(uint64_t address) {
+   if (!loadCode())
+      return;
+
+   // unconstrained state: the single successors are those of any memory state
+   MemoryState memoryState(getRegistersNumber(), getDomainFunctions());
+   MemoryInterpretParameters parameters;
+   DecisionVector decisionVector = createDecisionVector();
+   std::vector<uint64_t> targets(2);
+   TargetAddresses targetAddresses;
+   targetAddresses.addresses = &targets[0];
+   targetAddresses.addresses_array_size = 2;
+   targetAddresses.realloc_addresses = &reallocAddresses;
+   targetAddresses.address_container = &targets;
+
+   std::vector<BlockPartition::Instruction> newInstructions;
+   std::unordered_set<uint64_t> visited;
+   std::vector<uint64_t> toExplore{ address };
+   while (!toExplore.empty()) {
+      uint64_t instructionAddress = toExplore.back();
+      toExplore.pop_back();
+      if (!visited.insert(instructionAddress).second || bpPartition.locate(instructionAddress) >= 0)
+         continue;
+      size_t size = 0;
+      char* code = bpPartition.getCode(instructionAddress, size);
+      if (!code)
+         continue;
+      targetAddresses.addresses_length = 0;
+      bool isValid;
+      {  Statistics::Timer timer(Statistics::CNextTargets);
+         isValid = (*architectureFunctions.processor_next_targets)(pvContent,
+               code, size, instructionAddress, &targetAddresses,
+               reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
+               decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+      }
+      if (!isValid)
+         continue;
+      uint64_t callee = 0, returnAddress = 0;
+      const int* argumentRegisters = nullptr;
+      int argumentRegistersLength = 0;
+      if (targetAddresses.addresses_length == 1 && architectureFunctions.processor_get_call
+            && (*architectureFunctions.processor_get_call)(pvContent, code, size, instructionAddress,
+               &callee, &returnAddress, &argumentRegisters, &argumentRegistersLength)) {
+         bpPartition.addLinear(newInstructions, instructionAddress, targetAddresses.addresses[0],
+               returnAddress);
+         toExplore.push_back(returnAddress);
+      }
+      else if (targetAddresses.addresses_length == 1)
+         bpPartition.addLinear(newInstructions, instructionAddress, targetAddresses.addresses[0]);
+      else
+         bpPartition.addTerminator(newInstructions, instructionAddress,
+               targetAddresses.addresses, targetAddresses.addresses_length);
+      for (int index = 0; index < targetAddresses.addresses_length; ++index)
+         toExplore.push_back(targetAddresses.addresses[index]);
+   }
+   bpPartition.merge(std::move(newInstructions));
+}
+
+bool
+Processor::retrieveNextTargetsFromPartition(uint64_t address, MemoryState& memoryState,
+      TargetAddresses& targetAddresses, DecisionVector& decisionVector,
+      MemoryInterpretParameters& parameters, const std::vector<uint64_t>& stopAddresses) {
+   int index = bpPartition.locate(address);
+   if (index < 0) {
+      exploreBlocks(address);
+      index = bpPartition.locate(address);
+   }
+   // a cycle of single successors does not end in the decoding loop either
+   int remainingSteps = bpPartition.getInstructionsNumber();
+   while (index >= 0 && --remainingSteps >= 0) {
+      const BlockPartition::Instruction& instruction = bpPartition[index];
+      uint64_t next;
+      if (instruction.isLinear())
+         // a call is stepped over
+         next = instruction.callReturn ? instruction.callReturn : instruction.next;
+      else if (instruction.successorsCount == 0)
+         // no successor under the unconstrained state, nor under a more precise one
+         return true;
+      else {
+         size_t size = 0;
+         char* code = bpPartition.getCode(instruction.address, size);
+         AssumeCondition(code)
+         bool isValid;
+         {  Statistics::Timer timer(Statistics::CNextTargets);
+            Trace::Scope trace("processor_next_targets", Trace::currentContract(), instruction.address);
+            isValid = (*architectureFunctions.processor_next_targets)(pvContent,
+                  code, size, instruction.address, &targetAddresses,
+                  reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
+                  decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+         }
+         AssumeCondition(isValid)
+         if (targetAddresses.addresses_length != 1)
+            return true;
+         next = targetAddresses.addresses[0];
+         targetAddresses.addresses_length = 0;
+         targetAddresses.addresses[0] = 0;
+      }
+      for (const auto& stopAddress : stopAddresses)
+         if (next == stopAddress) {
+            if (targetAddresses.addresses_array_size < 1)
+               targetAddresses.addresses = (*targetAddresses.realloc_addresses)(targetAddresses.addresses,
+                     targetAddresses.addresses_array_size, &targetAddresses.addresses_array_size,
+                     targetAddresses.address_container);
+            targetAddresses.addresses[0] = next;
+            targetAddresses.addresses_length = 1;
+            return true;
+         }
+      index = (instruction.isLinear() && !instruction.callReturn) ? instruction.nextIndex
+         : bpPartition.locate(next);
+      if (index < 0) {
+         exploreBlocks(next);
+         index = bpPartition.locate(next);
+      }
+      if (index < 0)
+         return decodeNextTargets(next, memoryState, targetAddresses, decisionVector,
+               parameters, stopAddresses);
+   }
+   if (index < 0)
+      return decodeNextTargets(address, memoryState, targetAddresses, decisionVector,
+            parameters, stopAddresses);
+   return false;
+}
+
+bool
 Processor::interpret(uint64_t address, MemoryState& memoryState,
       uint64_t targetAddress, DecisionVector& decisionVector, Warnings& warnings,
-      MemoryInterpretParameters& parameters) {
+      MemoryInterpretParameters& parameters, const std::vector<uint64_t>& stopAddresses,
+      const MemoryState* postState) {
+   decisionVector.filter(targetAddress);
+   vInterpretedSpans.clear();
+   uFailureAddress = 0;
+   bool hasReachedTarget = false;
+   if (fUseFixpoint && interpretFixpoint(address, memoryState, targetAddress,
+            stopAddresses, decisionVector, parameters, &hasReachedTarget))
+      // otherwise memoryState is still the pre-state, not a state at targetAddress
+      return hasReachedTarget;
+   if (ptpBranchPool && interpretBranches(address, memoryState, targetAddress,
+            stopAddresses, decisionVector))
+      return true;
+   // the early exit only follows the single path
+   if (!fUseEarlyExit || fUseFixpoint || ptpBranchPool
+         || !architectureFunctions.processor_get_written_registers
+         || !retrieveFinalRegisters(address, targetAddress, stopAddresses, *postState))
+      postState = nullptr;
+   if (postState && !checkFinalRegisters(address, memoryState, *postState))
+      return false;
    if ((uint64_t) fBinaryFile.tellg() != address-uLoaderAllocShift) {
       fBinaryFile.seekg(address-uLoaderAllocShift);
       if (!fBinaryFile.good())
-         return;
+         return true;
    }
    static const int BufferSize = 1000;
    char instructionBuffer[BufferSize];
    int length = fBinaryFile.readsome(instructionBuffer, BufferSize);
+   Statistics::local().addRead(length);
    if (length <= 0)
-      return;
+      return true;
 
    char* instruction = instructionBuffer;
-   decisionVector.filter(targetAddress);
+   if (architectureFunctions.processor_interpret_range)
+      return interpretRanges(address, memoryState, targetAddress, decisionVector, parameters,
+            instructionBuffer, BufferSize, length, postState);
    while (length > 0) {
       uint64_t old_address = address;
-      bool hasFound = (*architectureFunctions.processor_interpret)(pvContent,
-            instruction, length, &address, targetAddress,
-            reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
-            decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+      bool hasFound;
+      {  Statistics::Timer timer(Statistics::CInterpret);
+         Trace::Scope trace("processor_interpret", Trace::currentContract(), address, targetAddress);
+         hasFound = (*architectureFunctions.processor_interpret)(pvContent,
+               instruction, length, &address, targetAddress,
+               reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
+               decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+      }
+      ++uInterpretedInstructions;
+      Statistics::local().addDecodedBytes(address-old_address);
+      if (pvcVerificationCache)
+         addInterpretedSpan(old_address, (address > old_address && address-old_address <= 16)
+               ? address : old_address+16);
       if (hasFound)
-         return;
+         return true;
+      if (postState && !checkFinalRegisters(address, memoryState, *postState))
+         return false;
       instruction += (address-old_address);
       AssumeCondition(instruction >= instructionBuffer && instruction < instructionBuffer+1000)
       length -= (address-old_address);
@@ -231,13 +530,795 @@ Processor::interpret(uint64_t address, MemoryState& memoryState,
          if ((uint64_t) fBinaryFile.tellg() != address-uLoaderAllocShift) {
             fBinaryFile.seekg(address-uLoaderAllocShift);
             if (!fBinaryFile.good())
-               return;
+               return true;
          }
          length = fBinaryFile.readsome(instructionBuffer, BufferSize);
+         Statistics::local().addRead(length);
          if (length <= 0)
-            return;
+            return true;
          instruction = instructionBuffer;
       }
    }
+   return true;
+}
+
+bool
+Processor::interpretRanges(uint64_t address, MemoryState& memoryState,
+      uint64_t targetAddress, DecisionVector& decisionVector,
+      MemoryInterpretParameters& parameters, char* instructionBuffer, int bufferSize,
+      int length, const MemoryState* postState) {
+   char* instruction = instructionBuffer;
+   // the ranges stop where a register becomes final
+   const uint64_t* stopAddresses = (postState && !vFinalAddresses.empty()) ? &vFinalAddresses[0] : nullptr;
+   int stopAddressesLength = stopAddresses ? (int) vFinalAddresses.size() : 0;
+   while (length > 0) {
+      uint64_t old_address = address;
+      int interpretedInstructions = 0;
+      size_t decodedBytes = 0;
+      bool hasFound;
+      {  Statistics::Timer timer(Statistics::CInterpret);
+         Trace::Scope trace("processor_interpret_range", Trace::currentContract(), address, targetAddress);
+         hasFound = (*architectureFunctions.processor_interpret_range)(pvContent,
+               instruction, length, &address, targetAddress, stopAddresses, stopAddressesLength,
+               reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
+               decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters),
+               &interpretedInstructions, &decodedBytes);
+      }
+      uInterpretedInstructions += interpretedInstructions;
+      Statistics::local().addDecodedRange(decodedBytes);
+      if (pvcVerificationCache && decodedBytes > 0)
+         addInterpretedSpan(old_address, old_address+decodedBytes);
+      if (hasFound || interpretedInstructions == 0)
+         return true;
+      if (postState && !checkFinalRegisters(address, memoryState, *postState))
+         return false;
+      // the range ends on a jump, on a final address or at the end of the buffer
+      if (address > old_address && address-old_address < (uint64_t) length
+            && length-(int) (address-old_address) > 20) {
+         instruction += (address-old_address);
+         length -= (address-old_address);
+      }
+      else {
+         if ((uint64_t) fBinaryFile.tellg() != address-uLoaderAllocShift) {
+            fBinaryFile.seekg(address-uLoaderAllocShift);
+            if (!fBinaryFile.good())
+               return true;
+         }
+         length = fBinaryFile.readsome(instructionBuffer, bufferSize);
+         Statistics::local().addRead(length);
+         if (length <= 0)
+            return true;
+         instruction = instructionBuffer;
+      }
+   }
+   return true;
+}
+
+/* The prefix of single successors from address is followed in the partition,
+ * then the region reachable from its end without crossing targetAddress nor
+ * the stop addresses, since the paths between two contracts do not cross the
+ * other contracts. A register of postState written in the region is never
+ * final. Otherwise it is final after its last writer in the prefix, or at
+ * address when the prefix does not write it. A call, an address out of the
+ * partition or a region that comes back into the prefix disable the checks.
+ */
+bool
+Processor::retrieveFinalRegisters(uint64_t address, uint64_t targetAddress,
+      const std::vector<uint64_t>& stopAddresses, const MemoryState& postState) {
+   vFinalRegisters.clear();
+   vFinalAddresses.clear();
+   std::vector<int> registers;
+   postState.retrieveRegisters(registers);
+   if (registers.empty() || !loadCode())
+      return false;
+   auto locate = [this](uint64_t instructionAddress)
+      {  int result = bpPartition.locate(instructionAddress);
+         if (result < 0) {
+            exploreBlocks(instructionAddress);
+            result = bpPartition.locate(instructionAddress);
+         }
+         return result;
+      };
+   static const int WrittenCapacity = 16;
+   int written[WrittenCapacity];
+   auto retrieveWritten = [this, &written](const BlockPartition::Instruction& instruction, int& writtenLength)
+      {  size_t size = 0;
+         char* code = bpPartition.getCode(instruction.address, size);
+         return code && (*architectureFunctions.processor_get_written_registers)(pvContent,
+               code, size, instruction.address, written, &writtenLength, WrittenCapacity);
+      };
+
+   int registersNumber = getRegistersNumber();
+   std::vector<uint64_t> lastWriters(registersNumber, 0), finalAddresses(registersNumber, address);
+   std::unordered_set<int> prefix;
+   int index = locate(address);
+   uint64_t current = address;
+   while (current != targetAddress && index >= 0 && bpPartition[index].isLinear()) {
+      const BlockPartition::Instruction& instruction = bpPartition[index];
+      int writtenLength = 0;
+      if (instruction.callReturn || !prefix.insert(index).second
+            || !retrieveWritten(instruction, writtenLength))
+         return false;
+      for (int writtenIndex = 0; writtenIndex < writtenLength; ++writtenIndex)
+         if (written[writtenIndex] >= 0 && written[writtenIndex] < registersNumber) {
+            lastWriters[written[writtenIndex]] = instruction.address;
+            finalAddresses[written[writtenIndex]] = instruction.next;
+         }
+      current = instruction.next;
+      if (std::find(stopAddresses.begin(), stopAddresses.end(), current) != stopAddresses.end())
+         return false;
+      index = instruction.nextIndex >= 0 ? instruction.nextIndex : locate(current);
+   }
+
+   std::vector<bool> isWrittenInRegion(registersNumber, false);
+   if (current != targetAddress) {
+      if (index < 0)
+         return false;
+      std::unordered_set<int> visited;
+      std::vector<int> toExplore{ index };
+      while (!toExplore.empty()) {
+         int exploreIndex = toExplore.back();
+         toExplore.pop_back();
+         if (!visited.insert(exploreIndex).second)
+            continue;
+         if (prefix.count(exploreIndex))
+            return false;
+         const BlockPartition::Instruction& instruction = bpPartition[exploreIndex];
+         int writtenLength = 0;
+         if (instruction.callReturn || !retrieveWritten(instruction, writtenLength))
+            return false;
+         for (int writtenIndex = 0; writtenIndex < writtenLength; ++writtenIndex)
+            if (written[writtenIndex] >= 0 && written[writtenIndex] < registersNumber)
+               isWrittenInRegion[written[writtenIndex]] = true;
+         const uint64_t* successors = instruction.isLinear() ? &instruction.next
+            : bpPartition.getSuccessors(instruction);
+         int successorsCount = instruction.isLinear() ? 1 : instruction.successorsCount;
+         for (int successor = 0; successor < successorsCount; ++successor) {
+            uint64_t next = successors[successor];
+            if (next == targetAddress
+                  || std::find(stopAddresses.begin(), stopAddresses.end(), next) != stopAddresses.end())
+               continue;
+            int nextIndex = locate(next);
+            if (nextIndex < 0)
+               return false;
+            toExplore.push_back(nextIndex);
+         }
+      }
+   }
+
+   for (int registerIndex : registers)
+      if (registerIndex >= 0 && registerIndex < registersNumber
+            && !isWrittenInRegion[registerIndex] && finalAddresses[registerIndex] != targetAddress) {
+         vFinalRegisters.emplace_back();
+         FinalRegister& finalRegister = vFinalRegisters.back();
+         finalRegister.address = finalAddresses[registerIndex];
+         finalRegister.writer = lastWriters[registerIndex] ? lastWriters[registerIndex] : address;
+         finalRegister.registerIndex = registerIndex;
+      }
+   std::sort(vFinalRegisters.begin(), vFinalRegisters.end());
+   for (const auto& finalRegister : vFinalRegisters)
+      if (vFinalAddresses.empty() || vFinalAddresses.back() != finalRegister.address)
+         vFinalAddresses.push_back(finalRegister.address);
+   return !vFinalRegisters.empty();
+}
+
+bool
+Processor::checkFinalRegisters(uint64_t address, const MemoryState& memoryState,
+      const MemoryState& postState) {
+   FinalRegister key{ address, 0, 0 };
+   auto found = std::lower_bound(vFinalRegisters.begin(), vFinalRegisters.end(), key);
+   for (; found != vFinalRegisters.end() && found->address == address; ++found)
+      if (!postState.containRegister(found->registerIndex, memoryState)) {
+         uFailureAddress = found->writer;
+         return false;
+      }
+   return true;
+}
+
+struct Processor::BranchPath {
+   uint64_t address;
+   uint64_t destination = 0; // branch taken by a fork on its first instruction
+   MemoryState state;
+   DecisionVector decisionVector;
+   std::vector<uint64_t> decisionPoints;
+
+   BranchPath(uint64_t aaddress, const MemoryState& astate, const DecisionVector& adecisionVector)
+      :  address(aaddress), state(astate), decisionVector(adecisionVector) {}
+};
+
+struct Processor::BranchResults {
+   uint64_t targetAddress;
+   const std::vector<uint64_t>& stopAddresses;
+   int64_t maxSteps;
+   std::mutex mutex;
+   std::vector<std::unique_ptr<MemoryState> > states; // of the paths that reach targetAddress
+   Statistics statistics;
+   uint64_t instructions = 0;
+   std::vector<VerificationCache::Span> spans;
+   std::exception_ptr error;
+   bool isAbandoned = false; // a path has ended before targetAddress and the stop addresses
+   int contractId = Trace::currentContract(); // of the thread that forks
+
+   BranchResults(uint64_t atargetAddress, const std::vector<uint64_t>& astopAddresses,
+         int64_t amaxSteps)
+      :  targetAddress(atargetAddress), stopAddresses(astopAddresses), maxSteps(amaxSteps) {}
+};
+
+/* Follows path until targetAddress and forks a new task at each instruction
+ * with several targets. The counters of the task are given back to the
+ * results, since Statistics are local to the threads.
+ */
+void
+Processor::exploreBranchPath(BranchPath& path, BranchResults& results) {
+   Statistics saved(Statistics::local());
+   Statistics::local().clear();
+   Trace::ContractScope contractScope(results.contractId);
+   uint64_t instructions = 0;
+   std::vector<VerificationCache::Span> spans;
+   bool hasReachedTarget = false, hasStopped = false;
+   try {
+      MemoryInterpretParameters parameters;
+      std::vector<uint64_t> targets(2);
+      TargetAddresses targetAddresses;
+      targetAddresses.addresses = &targets[0];
+      targetAddresses.addresses_array_size = 2;
+      targetAddresses.realloc_addresses = &reallocAddresses;
+      targetAddresses.address_container = &targets;
+      for (int64_t remainingSteps = results.maxSteps; --remainingSteps >= 0; ) {
+         size_t size = 0;
+         char* code = bpPartition.getCode(path.address, size);
+         if (!code)
+            break;
+         uint64_t destination = path.destination;
+         path.destination = 0;
+         if (!destination) {
+            targetAddresses.addresses_length = 0;
+            bool isValid;
+            {  Statistics::Timer timer(Statistics::CNextTargets);
+               Trace::Scope trace("processor_next_targets", Trace::currentContract(), path.address);
+               isValid = (*architectureFunctions.processor_next_targets)(pvContent,
+                     code, size, path.address, &targetAddresses,
+                     reinterpret_cast<MemoryModel*>(&path.state), path.state.getFunctions(),
+                     path.decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+            }
+            if (!isValid)
+               break;
+            int targetsNumber = targetAddresses.addresses_length;
+            if (targetsNumber == 0)
+               // the decoder decides whether the path reaches targetAddress
+               destination = results.targetAddress;
+            else {
+               if (targetsNumber > 1) {
+                  // the loops are left to the fixpoint
+                  if (std::find(path.decisionPoints.begin(), path.decisionPoints.end(), path.address)
+                        != path.decisionPoints.end())
+                     break;
+                  path.decisionPoints.push_back(path.address);
+               }
+               for (int target = 0; target < targetsNumber-1; ++target) {
+                  std::shared_ptr<BranchPath> fork = std::make_shared<BranchPath>(path.address,
+                        path.state, path.decisionVector);
+                  fork->destination = targetAddresses.addresses[target];
+                  fork->decisionPoints = path.decisionPoints;
+                  ptpBranchPool->submit([this, fork, &results]() { exploreBranchPath(*fork, results); });
+               }
+               destination = targetAddresses.addresses[targetsNumber-1];
+            }
+         }
+
+         uint64_t nextAddress = path.address;
+         {  Statistics::Timer timer(Statistics::CInterpret);
+            Trace::Scope trace("processor_interpret", Trace::currentContract(), path.address, destination);
+            (*architectureFunctions.processor_interpret)(pvContent,
+                  code, size, &nextAddress, destination,
+                  reinterpret_cast<MemoryModel*>(&path.state), path.state.getFunctions(),
+                  path.decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+         }
+         ++instructions;
+         Statistics::local().addDecodedBytes(nextAddress-path.address);
+         if (pvcVerificationCache) {
+            uint64_t end = (nextAddress > path.address && nextAddress-path.address <= 16)
+               ? nextAddress : path.address+16;
+            if (!spans.empty() && spans.back().end == path.address)
+               spans.back().end = end;
+            else {
+               spans.emplace_back();
+               spans.back().start = path.address;
+               spans.back().end = end;
+            }
+         }
+         if (nextAddress == results.targetAddress) {
+            hasReachedTarget = true;
+            break;
+         }
+         if (std::find(results.stopAddresses.begin(), results.stopAddresses.end(), nextAddress)
+               != results.stopAddresses.end()) {
+            // checked from the contract at nextAddress
+            hasStopped = true;
+            break;
+         }
+         if (nextAddress != destination)
+            break;
+         path.address = nextAddress;
+      }
+   }
+   catch (...) {
+      std::lock_guard<std::mutex> lock(results.mutex);
+      if (!results.error)
+         results.error = std::current_exception();
+      hasReachedTarget = false;
+   }
+   {  std::lock_guard<std::mutex> lock(results.mutex);
+      results.statistics.add(Statistics::local());
+      results.instructions += instructions;
+      results.spans.insert(results.spans.end(), spans.begin(), spans.end());
+      if (hasReachedTarget)
+         results.states.emplace_back(new MemoryState(std::move(path.state)));
+      else if (!hasStopped)
+         results.isAbandoned = true;
+   }
+   Statistics::local() = saved;
+}
+
+/* Exploration of all the branches between address and targetAddress. The
+ * memory state and the decision vector are forked at each instruction with
+ * several targets, the forks run on ptpBranchPool and the states that reach
+ * targetAddress are joined with MemoryState::mergeWith. A path ends when it
+ * comes back on one of its decision points or after as many instructions as
+ * bytes of code. Returns false, with memoryState unchanged, when no path
+ * reaches targetAddress or when a path has been abandoned elsewhere than on
+ * targetAddress or a stop address (loop, divergence, decoder failure): the
+ * join would miss its states, hence interpret falls back on the single path.
+ */
+bool
+Processor::interpretBranches(uint64_t address, MemoryState& memoryState,
+      uint64_t targetAddress, const std::vector<uint64_t>& stopAddresses,
+      DecisionVector& decisionVector) {
+   if (!loadCode())
+      return false;
+   MemoryState entries(getRegistersNumber(), getDomainFunctions());
+   MemoryState::DetachedZones zones;
+   memoryState.copyEntriesTo(entries, zones);
+   BranchResults results(targetAddress, stopAddresses, (int64_t) bpPartition.getCodeSize());
+   {  BranchPath path(address, entries, decisionVector);
+      exploreBranchPath(path, results);
+   }
+   ptpBranchPool->wait();
+
+   Statistics::local().add(results.statistics);
+   uInterpretedInstructions += results.instructions;
+   for (const auto& span : results.spans)
+      addInterpretedSpan(span.start, span.end);
+   if (results.error)
+      std::rethrow_exception(results.error);
+   if (results.states.empty() || results.isAbandoned)
+      return false;
+   MemoryState& joined = *results.states[0];
+   for (size_t index = 1; index < results.states.size(); ++index)
+      joined.mergeWith(*results.states[index]);
+   memoryState.moveEntriesFrom(joined, zones);
+   return true;
+}
+
+uint64_t
+Processor::interpretInstruction(int index, MemoryState& memoryState, uint64_t destination,
+      DecisionVector& decisionVector, MemoryInterpretParameters& parameters) {
+   uint64_t address = bpPartition[index].address;
+   size_t size = 0;
+   char* code = bpPartition.getCode(address, size);
+   AssumeCondition(code)
+   uint64_t nextAddress = address;
+   {  Statistics::Timer timer(Statistics::CInterpret);
+      Trace::Scope trace("processor_interpret", Trace::currentContract(), address, destination);
+      (*architectureFunctions.processor_interpret)(pvContent,
+            code, size, &nextAddress, destination,
+            reinterpret_cast<MemoryModel*>(&memoryState), memoryState.getFunctions(),
+            decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+   }
+   ++uInterpretedInstructions;
+   Statistics::local().addDecodedBytes(nextAddress-address);
+   if (pvcVerificationCache)
+      addInterpretedSpan(address, (nextAddress > address && nextAddress-address <= 16)
+            ? nextAddress : address+16);
+   return nextAddress;
+}
+
+Processor::StepResult
+Processor::applyCall(int index, MemoryState& memoryState, DecisionVector& decisionVector,
+      MemoryInterpretParameters& parameters) {
+   const BlockPartition::Instruction& instruction = bpPartition[index];
+   size_t size = 0;
+   char* code = bpPartition.getCode(instruction.address, size);
+   uint64_t callee = 0, returnAddress = 0;
+   const int* argumentRegisters = nullptr;
+   int argumentRegistersLength = 0;
+   bool isCall = (*architectureFunctions.processor_get_call)(pvContent, code, size,
+         instruction.address, &callee, &returnAddress, &argumentRegisters, &argumentRegistersLength);
+   AssumeCondition(isCall && returnAddress == instruction.callReturn)
+   std::vector<DomainValue> arguments;
+   arguments.reserve(argumentRegistersLength);
+   for (int argument = 0; argument < argumentRegistersLength; ++argument)
+      arguments.push_back(memoryState.getRegisterValue(argumentRegisters[argument]));
+
+   const FunctionSummaries::Summary* summary = fsSummaries.find(callee, returnAddress, arguments);
+   if (summary)
+      Statistics::local().addCall(Statistics::CSummaryHit);
+   else if (fsSummaries.isComputing(callee)) {
+      // recursive call, without summary for its effect
+      memoryState.clearContent();
+      return SRNext;
+   }
+   else {
+      Statistics::local().addCall(Statistics::CSummaryMiss);
+      // the callee only knows its arguments
+      MemoryState entryState(getRegistersNumber(), getDomainFunctions());
+      entryState.setTopRegisters(32);
+      entryState.setRegistersFrom(memoryState, argumentRegisters, argumentRegistersLength);
+      if (interpretInstruction(index, entryState, callee, decisionVector, parameters) != callee)
+         return SRFailure;
+      size_t firstSpan = vInterpretedSpans.size();
+      MemoryState calleeState(entryState);
+      DecisionVector calleeDecisionVector = createDecisionVector();
+      calleeDecisionVector.filter(returnAddress);
+      bool hasReturned = false;
+      fsSummaries.setComputing(callee);
+      bool isComplete = interpretFixpoint(callee, calleeState, returnAddress,
+            std::vector<uint64_t>(), calleeDecisionVector, parameters, &hasReturned);
+      fsSummaries.clearComputing(callee);
+      if (!isComplete)
+         return SRFailure;
+      std::unique_ptr<FunctionSummaries::Summary> newSummary(new FunctionSummaries::Summary);
+      newSummary->returnAddress = returnAddress;
+      newSummary->arguments = std::move(arguments);
+      newSummary->written.reset(new MemoryState(getRegistersNumber(), getDomainFunctions()));
+      newSummary->removed.reset(new MemoryState(getRegistersNumber(), getDomainFunctions()));
+      if (hasReturned) {
+         calleeState.retrieveChangesSince(entryState, *newSummary->written, *newSummary->removed);
+         newSummary->hasClobberedMemory = calleeState.hasStoredMemory();
+      }
+      else
+         newSummary->hasNoReturn = true;
+      newSummary->spans.assign(vInterpretedSpans.begin() + firstSpan, vInterpretedSpans.end());
+      summary = newSummary.get();
+      fsSummaries.insert(callee, std::move(newSummary));
+   }
+
+   if (summary->hasNoReturn)
+      return SRNoSuccessor;
+   for (const auto& span : summary->spans)
+      addInterpretedSpan(span.start, span.end);
+   if (interpretInstruction(index, memoryState, callee, decisionVector, parameters) != callee)
+      return SRFailure;
+   memoryState.applyChanges(*summary->written, *summary->removed, summary->hasClobberedMemory);
+   return SRNext;
 }
 
+/* Fixpoint over the linear blocks of bpPartition between address and
+ * targetAddress. A block starts at address, at an instruction with several
+ * predecessors or at a successor of a terminator; the edges to targetAddress
+ * leave the graph and the edges to the other stop addresses are dropped, since
+ * they are checked from the contracts at these addresses. The blocks are ordered in reverse postorder from address:
+ * the worklist always takes the first block in this order, so that a loop is
+ * stabilized before its exits are propagated. The entry states of the blocks
+ * are joined with MemoryState::mergeWith, and the heads of the back edges are
+ * widened after uWideningDelay joins. The result is the join of the states
+ * that reach targetAddress. A call goes to its return address in the graph;
+ * its effect comes from the summary of the callee, computed on the first
+ * call with the same arguments by a fixpoint between the callee and the
+ * return address. Returns false when the code between address and
+ * targetAddress is not entirely in the partition, or when a state is lost on
+ * the way: an instruction that fails, a decoder error or a computed jump out
+ * of the graph. When no state reaches
+ * targetAddress, memoryState is left unchanged and *hasReachedTarget is false.
+ */
+bool
+Processor::interpretFixpoint(uint64_t address, MemoryState& memoryState,
+      uint64_t targetAddress, const std::vector<uint64_t>& stopAddresses,
+      DecisionVector& decisionVector, MemoryInterpretParameters& parameters,
+      bool* hasReachedTarget) {
+   static const int Exit = -2, Stop = -3;
+   if (bpPartition.locate(address) < 0)
+      exploreBlocks(address);
+   int entry = bpPartition.locate(address);
+   if (entry < 0)
+      return false;
+
+   // reachable instructions and their number of predecessors
+   auto successorIndex = [this, targetAddress, &stopAddresses](uint64_t successor)
+      {  if (successor == targetAddress)
+            return Exit;
+         for (const auto& stopAddress : stopAddresses)
+            if (successor == stopAddress)
+               return Stop;
+         return bpPartition.locate(successor);
+      };
+   std::unordered_map<int, int> predecessors;
+   std::vector<int> toExplore{ entry };
+   predecessors[entry] = 1;
+   while (!toExplore.empty()) {
+      int index = toExplore.back();
+      toExplore.pop_back();
+      const BlockPartition::Instruction& instruction = bpPartition[index];
+      int successorsCount = instruction.isLinear() ? 1 : instruction.successorsCount;
+      const uint64_t* successors = !instruction.isLinear() ? bpPartition.getSuccessors(instruction)
+         : (instruction.callReturn ? &instruction.callReturn : &instruction.next);
+      for (int successor = 0; successor < successorsCount; ++successor) {
+         int next = successorIndex(successors[successor]);
+         if (next == Exit || next == Stop)
+            continue;
+         if (next < 0)
+            return false;
+         if (++predecessors[next] == 1)
+            toExplore.push_back(next);
+      }
+   }
+
+   struct Block {
+      std::vector<int> instructions;
+      std::vector<int> successors; // blocks, or Exit
+      int order = -1;
+      bool isLoopHead = false;
+      bool reachesExit = false;
+      int joins = 0;
+      std::unique_ptr<MemoryState> state;
+   };
+   std::vector<Block> blocks;
+   std::unordered_map<int, int> blockStarts;
+   auto isBlockStart = [&](int index)
+      {  return index == entry || predecessors[index] >= 2
+            || blockStarts.find(index) != blockStarts.end();
+      };
+   for (const auto& reachable : predecessors) {
+      const BlockPartition::Instruction& instruction = bpPartition[reachable.first];
+      if (!instruction.isLinear())
+         for (int successor = 0; successor < instruction.successorsCount; ++successor) {
+            int next = successorIndex(bpPartition.getSuccessors(instruction)[successor]);
+            if (next >= 0)
+               blockStarts.insert(std::make_pair(next, -1));
+         }
+   }
+   for (const auto& reachable : predecessors)
+      if (isBlockStart(reachable.first))
+         blockStarts[reachable.first] = -1;
+   for (auto& start : blockStarts) {
+      start.second = (int) blocks.size();
+      blocks.emplace_back();
+   }
+   for (const auto& start : blockStarts) {
+      Block& block = blocks[start.second];
+      int index = start.first;
+      while (true) {
+         block.instructions.push_back(index);
+         const BlockPartition::Instruction& instruction = bpPartition[index];
+         if (!instruction.isLinear()) {
+            for (int successor = 0; successor < instruction.successorsCount; ++successor) {
+               int next = successorIndex(bpPartition.getSuccessors(instruction)[successor]);
+               block.successors.push_back(next < 0 ? next : blockStarts[next]);
+            }
+            // without successor, the decoder may end the path on targetAddress
+            if (instruction.successorsCount == 0)
+               block.successors.push_back(Exit);
+            break;
+         }
+         int next = successorIndex(instruction.callReturn ? instruction.callReturn : instruction.next);
+         if (next < 0 || blockStarts.find(next) != blockStarts.end()) {
+            block.successors.push_back(next < 0 ? next : blockStarts[next]);
+            break;
+         }
+         index = next;
+      }
+   }
+
+   // reverse postorder, the targets of the back edges are the loop heads
+   std::vector<int> blocksByOrder(blocks.size());
+   {  std::vector<int> postOrder;
+      std::vector<std::pair<int, int> > stack;
+      std::vector<char> isOnStack(blocks.size(), 0);
+      int first = blockStarts[entry];
+      stack.emplace_back(first, 0);
+      isOnStack[first] = 1;
+      blocks[first].order = 0;
+      while (!stack.empty()) {
+         auto& top = stack.back();
+         Block& block = blocks[top.first];
+         if (top.second < (int) block.successors.size()) {
+            int successor = block.successors[top.second++];
+            if (successor < 0)
+               continue;
+            if (isOnStack[successor])
+               blocks[successor].isLoopHead = true;
+            else if (blocks[successor].order < 0) {
+               blocks[successor].order = 0;
+               isOnStack[successor] = 1;
+               stack.emplace_back(successor, 0);
+            }
+         }
+         else {
+            isOnStack[top.first] = 0;
+            postOrder.push_back(top.first);
+            stack.pop_back();
+         }
+      }
+      int order = 0;
+      for (auto block = postOrder.rbegin(); block != postOrder.rend(); ++block) {
+         blocks[*block].order = order;
+         blocksByOrder[order++] = *block;
+      }
+   }
+
+   // the paths that only lead to the stop addresses are not interpreted
+   for (bool hasChanged = true; hasChanged; ) {
+      hasChanged = false;
+      for (auto block = blocksByOrder.rbegin(); block != blocksByOrder.rend(); ++block) {
+         Block& current = blocks[*block];
+         if (current.reachesExit)
+            continue;
+         for (int successor : current.successors)
+            if (successor == Exit || (successor >= 0 && blocks[successor].reachesExit)) {
+               current.reachesExit = hasChanged = true;
+               break;
+            }
+      }
+   }
+
+   std::unique_ptr<MemoryState> exitState;
+   std::set<int> worklist;
+   auto isUseful = [&blocks](int target)
+      {  return target == Exit || (target >= 0 && blocks[target].reachesExit); };
+   auto propagate = [&](int target, MemoryState&& state)
+      {  if (target == Exit) {
+            if (!exitState)
+               exitState.reset(new MemoryState(std::move(state)));
+            else
+               exitState->mergeWith(state);
+            return;
+         }
+         Block& block = blocks[target];
+         if (!block.state)
+            block.state.reset(new MemoryState(std::move(state)));
+         else if (block.state->contain(state, parameters))
+            return;
+         else
+            block.state->mergeWith(state, block.isLoopHead && ++block.joins > uWideningDelay);
+         worklist.insert(block.order);
+      };
+   if (isUseful(blockStarts[entry]))
+      propagate(blockStarts[entry], MemoryState(memoryState));
+   TargetAddresses targetAddresses;
+   std::vector<uint64_t> targets(2);
+   targetAddresses.addresses = &targets[0];
+   targetAddresses.addresses_array_size = 2;
+   targetAddresses.realloc_addresses = &reallocAddresses;
+   targetAddresses.address_container = &targets;
+   auto interpretLinear = [&](int index, MemoryState& state)
+      {  const BlockPartition::Instruction& instruction = bpPartition[index];
+         uint64_t callReturn = instruction.callReturn;
+         if (callReturn)
+            return applyCall(index, state, decisionVector, parameters);
+         return (interpretInstruction(index, state, instruction.next, decisionVector, parameters)
+            == instruction.next) ? SRNext : SRFailure;
+      };
+   while (!worklist.empty()) {
+      Block& block = blocks[blocksByOrder[*worklist.begin()]];
+      worklist.erase(worklist.begin());
+      MemoryState state(*block.state);
+      StepResult step = SRNext;
+      for (int index = 0; step == SRNext && index < (int) block.instructions.size()-1; ++index)
+         step = interpretLinear(block.instructions[index], state);
+      if (step == SRFailure)
+         // the state of the block would be missing from the result
+         return false;
+      if (step == SRNoSuccessor)
+         continue;
+      int last = block.instructions.back();
+      const BlockPartition::Instruction& instruction = bpPartition[last];
+      if (instruction.isLinear()) {
+         if (isUseful(block.successors[0])) {
+            step = interpretLinear(last, state);
+            if (step == SRFailure)
+               return false;
+            if (step == SRNext)
+               propagate(block.successors[0], std::move(state));
+         }
+         continue;
+      }
+
+      // the successors under the state of the block are a subset of the static ones
+      size_t size = 0;
+      char* code = bpPartition.getCode(instruction.address, size);
+      targetAddresses.addresses_length = 0;
+      bool isValid;
+      {  Statistics::Timer timer(Statistics::CNextTargets);
+         Trace::Scope trace("processor_next_targets", Trace::currentContract(), instruction.address);
+         isValid = (*architectureFunctions.processor_next_targets)(pvContent,
+               code, size, instruction.address, &targetAddresses,
+               reinterpret_cast<MemoryModel*>(&state), state.getFunctions(),
+               decisionVector.getContent(), reinterpret_cast<InterpretParameters*>(&parameters));
+      }
+      if (!isValid)
+         return false;
+      std::vector<uint64_t> nextTargets(targetAddresses.addresses,
+            targetAddresses.addresses + targetAddresses.addresses_length);
+      if (nextTargets.empty()) {
+         // the decoder decides whether the state reaches targetAddress
+         if (interpretInstruction(last, state, targetAddress, decisionVector, parameters)
+               == targetAddress)
+            propagate(Exit, std::move(state));
+         continue;
+      }
+      for (int target = 0; target < (int) nextTargets.size(); ++target) {
+         const uint64_t* successors = bpPartition.getSuccessors(instruction);
+         int successor = 0;
+         while (successor < instruction.successorsCount && successors[successor] != nextTargets[target])
+            ++successor;
+         int blockSuccessor;
+         if (successor < instruction.successorsCount)
+            blockSuccessor = block.successors[successor];
+         else if (nextTargets[target] == targetAddress)
+            // computed jump, like the return of a callee
+            blockSuccessor = Exit;
+         else
+            // computed jump out of the graph
+            return false;
+         if (!isUseful(blockSuccessor))
+            continue;
+         MemoryState targetState(target+1 < (int) nextTargets.size() ? MemoryState(state) : std::move(state));
+         if (interpretInstruction(last, targetState, nextTargets[target], decisionVector, parameters)
+               != nextTargets[target])
+            return false;
+         propagate(blockSuccessor, std::move(targetState));
+      }
+   }
+   if (hasReachedTarget)
+      *hasReachedTarget = (bool) exitState;
+   if (exitState)
+      memoryState.swap(*exitState);
+   return true;
+}
+
+bool
+Processor::setVerificationCache(const char* filename) {
+   uint64_t pluginsHash = VerificationCache::hashFile(sArchitectureFilename.c_str());
+   pluginsHash = VerificationCache::hashFile(sDomainFilename.c_str(), pluginsHash);
+   pvcVerificationCache.reset(new VerificationCache(filename, pluginsHash));
+   if (!pvcVerificationCache->load()) {
+      pvcVerificationCache.reset();
+      return false;
+   }
+   return true;
+}
+
+uint64_t
+Processor::hashModes(uint64_t seed) const {
+   uint64_t result = VerificationCache::hashValue(fUseFixpoint ? (uint64_t) uWideningDelay+1 : 0, seed);
+   result = VerificationCache::hashValue((uint64_t) useParallelBranches(), result);
+   result = VerificationCache::hashValue((uint64_t) fUseEarlyExit, result);
+   return VerificationCache::hashValue((uint64_t) fUseBlockPartition, result);
+}
+
+uint64_t
+Processor::hashCode(const VerificationCache::Span* spans, int spansCount) {
+   uint64_t result = VerificationCache::InitialHash;
+   char buffer[1024];
+   for (int index = 0; index < spansCount; ++index) {
+      uint64_t start = spans[index].start, end = spans[index].end;
+      result = VerificationCache::hashValue(start, result);
+      if (start < uLoaderAllocShift)
+         continue;
+      fBinaryFile.clear();
+      fBinaryFile.seekg(start-uLoaderAllocShift);
+      while (start < end && fBinaryFile.good()) {
+         size_t size = (size_t) std::min<uint64_t>(end-start, sizeof(buffer));
+         fBinaryFile.read(buffer, size);
+         size_t length = (size_t) fBinaryFile.gcount();
+         if (length == 0)
+            break;
+         result = VerificationCache::hash(buffer, length, result);
+         start += length;
+      }
+      // a span that goes beyond the end of the file has another hash than a full one
+      result = VerificationCache::hashValue(end-start, result);
+   }
+   fBinaryFile.clear();
+   return result;
+}
@@ -1,7 +1,14 @@
 #pragma once
 
 #include "Contract.h"
+#include "BlockPartition.h"
+#include "FunctionSummaries.h"
+#include "Statistics.h"
+#include "TaskPool.h"
+#include "VerificationCache.h"
 #include "Dll/dll.h"
+#include <memory>
+#include <string>
 #include <vector>
 #include "decsec_callback.h"
 
@@ -41,6 +48,32 @@ class Processor {
    // struct _DomainElementFunctions domainFunctions;
    std::ifstream fBinaryFile;
    uint64_t uLoaderAllocShift = 0;
+   uint64_t uInterpretedInstructions = 0;
+   BlockPartition bpPartition;
+   bool fUseBlockPartition = false;
+   bool fUseFixpoint = false;
+   int uWideningDelay = 3;
+   std::string sArchitectureFilename;
+   std::string sDomainFilename;
+   std::unique_ptr<VerificationCache> pvcVerificationCache;
+   std::vector<VerificationCache::Span> vInterpretedSpans;
+   FunctionSummaries fsSummaries;
+   std::unique_ptr<TaskPool> ptpBranchPool;
+   bool fUseEarlyExit = false;
+   uint64_t uFailureAddress = 0;
+   // counters of the C API calls on this processor
+   Statistics sStatistics;
+   std::mutex mStatisticsLock;
+   // register of the post-contract checked once the path reaches address
+   struct FinalRegister {
+      uint64_t address;
+      uint64_t writer; // last instruction that writes the register, or the start
+      int registerIndex;
+
+      bool operator<(const FinalRegister& source) const { return address < source.address; }
+   };
+   std::vector<FinalRegister> vFinalRegisters;
+   std::vector<uint64_t> vFinalAddresses;
 
    static uint64_t* reallocAddresses(uint64_t* old_addresses, int old_size,
          int* new_size, void* address_container)
@@ -54,6 +87,58 @@ class Processor {
          container->insert(container->end(), (*new_size-old_size), 0);
          return &(*container)[0];
       }
+   bool decodeNextTargets(uint64_t address, MemoryState& memoryState,
+         TargetAddresses& targetAddresses, DecisionVector& decisionVector,
+         MemoryInterpretParameters& parameters, const std::vector<uint64_t>& stopAddresses);
+   // reads the whole binary file in bpPartition
+   bool loadCode();
+   void exploreBlocks(uint64_t address);
+   bool retrieveNextTargetsFromPartition(uint64_t address, MemoryState& memoryState,
+         TargetAddresses& targetAddresses, DecisionVector& decisionVector,
+         MemoryInterpretParameters& parameters, const std::vector<uint64_t>& stopAddresses);
+   // the spans are only recorded for the verification cache
+   void addInterpretedSpan(uint64_t start, uint64_t end)
+      {  if (!vInterpretedSpans.empty() && vInterpretedSpans.back().end == start)
+            vInterpretedSpans.back().end = end;
+         else {
+            vInterpretedSpans.emplace_back();
+            vInterpretedSpans.back().start = start;
+            vInterpretedSpans.back().end = end;
+         }
+      }
+   bool interpretRanges(uint64_t address, MemoryState& memoryState,
+         uint64_t targetAddress, DecisionVector& decisionVector,
+         MemoryInterpretParameters& parameters, char* instructionBuffer, int bufferSize,
+         int length, const MemoryState* postState);
+   /* fills vFinalRegisters with the registers of postState that are no longer
+    * written on the paths from address to targetAddress, false if these paths
+    * cannot be described by the partition and the written registers
+    */
+   bool retrieveFinalRegisters(uint64_t address, uint64_t targetAddress,
+         const std::vector<uint64_t>& stopAddresses, const MemoryState& postState);
+   // false if a register that is final at address is not contained in postState
+   bool checkFinalRegisters(uint64_t address, const MemoryState& memoryState,
+         const MemoryState& postState);
+   // interprets the instruction of bpPartition at index towards destination
+   uint64_t interpretInstruction(int index, MemoryState& memoryState, uint64_t destination,
+         DecisionVector& decisionVector, MemoryInterpretParameters& parameters);
+   /* SRNoSuccessor ends the path without loss, SRFailure means that the
+    * interpretation is incomplete
+    */
+   enum StepResult { SRNext, SRNoSuccessor, SRFailure };
+   // applies the summary of the call at index of bpPartition, SRNoSuccessor if the callee never returns
+   StepResult applyCall(int index, MemoryState& memoryState, DecisionVector& decisionVector,
+         MemoryInterpretParameters& parameters);
+   bool interpretFixpoint(uint64_t address, MemoryState& memoryState,
+         uint64_t targetAddress, const std::vector<uint64_t>& stopAddresses,
+         DecisionVector& decisionVector, MemoryInterpretParameters& parameters,
+         bool* hasReachedTarget = nullptr);
+   struct BranchPath;
+   struct BranchResults;
+   void exploreBranchPath(BranchPath& path, BranchResults& results);
+   bool interpretBranches(uint64_t address, MemoryState& memoryState,
+         uint64_t targetAddress, const std::vector<uint64_t>& stopAddresses,
+         DecisionVector& decisionVector);
 
   public:
    Processor()
@@ -75,7 +160,45 @@ class Processor {
    void setFromFile(const char* filename);
    void setDomainFunctionsFromFile(const char* domainFilename);
    std::ifstream& binaryFile() { return fBinaryFile; }
-   void setLoaderAllocShift(uint64_t shift) { uLoaderAllocShift = shift; }
+   void setLoaderAllocShift(uint64_t shift)
+      {  uLoaderAllocShift = shift;
+         bpPartition.clear();
+         fsSummaries.clear();
+      }
+   void clearBlockPartition() { bpPartition.clear(); fsSummaries.clear(); }
+   void setUseBlockPartition() { fUseBlockPartition = true; }
+   void setUseFixpoint(int wideningDelay)
+      {  fUseFixpoint = true;
+         uWideningDelay = wideningDelay;
+      }
+   bool useFixpoint() const { return fUseFixpoint; }
+   void setParallelBranches(int threads) { ptpBranchPool.reset(new TaskPool(threads)); }
+   bool useParallelBranches() const { return (bool) ptpBranchPool; }
+   void setUseEarlyExit() { fUseEarlyExit = true; }
+   bool useEarlyExit() const { return fUseEarlyExit; }
+   // 0 if the last interpret has not exited early
+   uint64_t getFailureAddress() const { return uFailureAddress; }
+   void clearFailureAddress() { uFailureAddress = 0; }
+   const BlockPartition& getBlockPartition() const { return bpPartition; }
+   bool setVerificationCache(const char* filename);
+   bool saveVerificationCache()
+      {  return !pvcVerificationCache || pvcVerificationCache->save(); }
+   VerificationCache* getVerificationCache() const { return pvcVerificationCache.get(); }
+   // the modes change the verdicts, hence the keys of the verification cache
+   uint64_t hashModes(uint64_t seed) const;
+   const std::vector<VerificationCache::Span>& getInterpretedSpans() const { return vInterpretedSpans; }
+   uint64_t hashCode(const VerificationCache::Span* spans, int spansCount);
+   uint64_t getInterpretedInstructions() const { return uInterpretedInstructions; }
+   Statistics& statistics() { return sStatistics; }
+   std::mutex& statisticsLock() { return mStatisticsLock; }
+   void retrieveStatistics(struct _CheckerStats& stats)
+      {  std::lock_guard<std::mutex> lock(mStatisticsLock);
+         sStatistics.retrieve(stats);
+      }
+   void clearStatistics()
+      {  std::lock_guard<std::mutex> lock(mStatisticsLock);
+         sStatistics.clear();
+      }
    void setVerbose() { (*architectureFunctions.set_verbose)(pvContent); }
    int getRegistersNumber() const
       {  AssumeCondition(pvContent)
@@ -103,8 +226,16 @@ class Processor {
    bool retrieveNextTargets(uint64_t address, MemoryState& memoryState,
          TargetAddresses& targetAddresses, DecisionVector& decisionVector,
          MemoryInterpretParameters& parameters);
-   void interpret(uint64_t address, MemoryState& memoryState,
+   /* the paths of the fixpoint and of the forks end on the stop addresses, other than targetAddress.
+    * With the early exit and a postState, the single path stops as soon as a
+    * register that it no longer writes is not contained in postState: the
+    * result is then false and getFailureAddress gives the writer. The result
+    * is also false when the fixpoint finds no path to targetAddress.
+    */
+   bool interpret(uint64_t address, MemoryState& memoryState,
          uint64_t targetAddress, DecisionVector& decisionVector, Warnings& warnings,
-         MemoryInterpretParameters& parameters);
+         MemoryInterpretParameters& parameters,
+         const std::vector<uint64_t>& stopAddresses = std::vector<uint64_t>(),
+         const MemoryState* postState = nullptr);
 };
 
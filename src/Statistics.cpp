@@ -0,0 +1,37 @@
+#include "Statistics.h"
+#include "contract_checker.h"
+
+thread_local Statistics Statistics::sCurrent;
+
+void
+Statistics::retrieve(struct _CheckerStats& stats) const {
+   stats.contract_application_calls = auCalls[CContractApplication];
+   stats.contract_application_ns = auNanoseconds[CContractApplication];
+   stats.expression_evaluation_calls = auCalls[CExpressionEvaluation];
+   stats.expression_evaluation_ns = auNanoseconds[CExpressionEvaluation];
+   stats.next_targets_calls = auCalls[CNextTargets];
+   stats.next_targets_ns = auNanoseconds[CNextTargets];
+   stats.interpret_calls = auCalls[CInterpret];
+   stats.interpret_ns = auNanoseconds[CInterpret];
+   stats.contain_calls = auCalls[CContain];
+   stats.contain_ns = auNanoseconds[CContain];
+   stats.domain_clone_calls = auCalls[CDomainClone];
+   stats.domain_clone_ns = auNanoseconds[CDomainClone];
+   stats.domain_free_calls = auCalls[CDomainFree];
+   stats.domain_free_ns = auNanoseconds[CDomainFree];
+   stats.domain_merge_calls = auCalls[CDomainMerge];
+   stats.domain_merge_ns = auNanoseconds[CDomainMerge];
+   stats.file_reads = auCalls[CFileRead];
+   stats.file_read_bytes = uReadBytes;
+   stats.decoded_bytes = uDecodedBytes;
+   stats.verification_cache_hits = auCalls[CCacheHit];
+   stats.verification_cache_misses = auCalls[CCacheMiss];
+   stats.function_summary_hits = auCalls[CSummaryHit];
+   stats.function_summary_misses = auCalls[CSummaryMiss];
+   stats.domain_compare_calls = auCalls[CDomainCompare];
+   stats.domain_compare_ns = auNanoseconds[CDomainCompare];
+   stats.proven_post_state_hits = auCalls[CPostStateHit];
+   stats.proven_post_state_misses = auCalls[CPostStateMiss];
+   stats.inline_contain_calls = auCalls[CInlineContain];
+}
+
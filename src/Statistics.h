@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+struct _CheckerStats;
+
+/* Counters of the checker, cumulated per thread without any lock so that
+ * they can stay on in production. The C API entry points move them into the
+ * counters of their processor with a Collector.
+ */
+class Statistics {
+  public:
+   enum Counter
+      {  CContractApplication, CExpressionEvaluation, CNextTargets, CInterpret,
+         CContain, CDomainClone, CDomainFree, CDomainMerge, CFileRead, CCacheHit, CCacheMiss,
+         CSummaryHit, CSummaryMiss, CDomainCompare, CPostStateHit, CPostStateMiss,
+         CInlineContain,
+         CNumberOfCounters
+      };
+
+  private:
+   uint64_t auCalls[CNumberOfCounters] = {};
+   uint64_t auNanoseconds[CNumberOfCounters] = {};
+   uint64_t uReadBytes = 0;
+   uint64_t uDecodedBytes = 0;
+
+   static thread_local Statistics sCurrent;
+
+  public:
+   Statistics() = default;
+
+   static Statistics& local() { return sCurrent; }
+
+   void addCall(Counter counter) { ++auCalls[counter]; }
+   void addTime(Counter counter, uint64_t nanoseconds)
+      {  ++auCalls[counter];
+         auNanoseconds[counter] += nanoseconds;
+      }
+   void addRead(int length)
+      {  ++auCalls[CFileRead];
+         if (length > 0)
+            uReadBytes += length;
+      }
+   // a step larger than any instruction is a jump whose instruction size is unknown
+   void addDecodedBytes(uint64_t step) { if (step <= 16) uDecodedBytes += step; }
+   void addDecodedRange(uint64_t bytes) { uDecodedBytes += bytes; }
+   void clear() { *this = Statistics(); }
+   // cumulates the counters of a task run on another thread
+   void add(const Statistics& source)
+      {  for (int counter = 0; counter < CNumberOfCounters; ++counter) {
+            auCalls[counter] += source.auCalls[counter];
+            auNanoseconds[counter] += source.auNanoseconds[counter];
+         }
+         uReadBytes += source.uReadBytes;
+         uDecodedBytes += source.uDecodedBytes;
+      }
+   void retrieve(struct _CheckerStats& stats) const;
+
+   // moves the counters of a C API call into target, whatever the calling thread
+   class Collector;
+
+   // scoped measure of one call, to be placed on non recursive entry points
+   class Timer {
+     private:
+      Counter cCounter;
+      std::chrono::steady_clock::time_point tpStart;
+
+     public:
+      Timer(Counter counter) : cCounter(counter), tpStart(std::chrono::steady_clock::now()) {}
+      Timer(const Timer&) = delete;
+      ~Timer()
+         {  Statistics::local().addTime(cCounter, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>
+               (std::chrono::steady_clock::now() - tpStart).count());
+         }
+   };
+};
+
+class Statistics::Collector {
+  private:
+   Statistics& sTarget;
+   std::mutex& mTargetLock;
+   Statistics sSaved;
+
+  public:
+   Collector(Statistics& target, std::mutex& targetLock)
+      :  sTarget(target), mTargetLock(targetLock), sSaved(sCurrent)
+      {  sCurrent.clear(); }
+   Collector(const Collector&) = delete;
+   ~Collector()
+      {  {  std::lock_guard<std::mutex> lock(mTargetLock);
+            sTarget.add(sCurrent);
+         }
+         sCurrent = sSaved;
+      }
+};
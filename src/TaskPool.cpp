@@ -0,0 +1,57 @@
+#include "TaskPool.h"
+
+TaskPool::TaskPool(int threads) {
+   for (int index = 0; index < threads; ++index)
+      vThreads.emplace_back([this]()
+         {  std::unique_lock<std::mutex> lock(mMutex);
+            while (true) {
+               cvTasks.wait(lock, [this]() { return fIsStopped || !dTasks.empty(); });
+               if (fIsStopped)
+                  return;
+               runTask(lock);
+            }
+         });
+}
+
+TaskPool::~TaskPool() {
+   {  std::lock_guard<std::mutex> lock(mMutex);
+      fIsStopped = true;
+   }
+   cvTasks.notify_all();
+   for (auto& thread : vThreads)
+      thread.join();
+}
+
+bool
+TaskPool::runTask(std::unique_lock<std::mutex>& lock) {
+   if (dTasks.empty())
+      return false;
+   std::function<void()> task = std::move(dTasks.front());
+   dTasks.pop_front();
+   lock.unlock();
+   task();
+   lock.lock();
+   if (--uPending == 0)
+      cvDone.notify_all();
+   return true;
+}
+
+void
+TaskPool::submit(std::function<void()>&& task) {
+   {  std::lock_guard<std::mutex> lock(mMutex);
+      dTasks.push_back(std::move(task));
+      ++uPending;
+   }
+   cvTasks.notify_one();
+   // a thread blocked in wait also runs the tasks
+   cvDone.notify_one();
+}
+
+void
+TaskPool::wait() {
+   std::unique_lock<std::mutex> lock(mMutex);
+   while (uPending > 0)
+      if (!runTask(lock))
+         cvDone.wait(lock, [this]() { return uPending == 0 || !dTasks.empty(); });
+}
+
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed pool of threads for the forks of Processor::interpret. The thread
+ * that waits for the tasks runs them too: a pool of n threads gives n+1
+ * workers, and a task may submit other tasks without any deadlock.
+ */
+class TaskPool {
+  private:
+   std::vector<std::thread> vThreads;
+   std::deque<std::function<void()> > dTasks;
+   std::mutex mMutex;
+   std::condition_variable cvTasks;
+   std::condition_variable cvDone;
+   int uPending = 0;
+   bool fIsStopped = false;
+
+   // runs the first task with the lock released, false if there is none
+   bool runTask(std::unique_lock<std::mutex>& lock);
+
+  public:
+   explicit TaskPool(int threads);
+   TaskPool(const TaskPool&) = delete;
+   ~TaskPool();
+
+   int getThreadsNumber() const { return (int) vThreads.size(); }
+   void submit(std::function<void()>&& task);
+   // returns when all the submitted tasks have been run
+   void wait();
+};
+
@@ -0,0 +1,136 @@
+#include "Trace.h"
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+class RingBuffer {
+  private:
+   std::vector<Trace::Event> veEvents;
+   std::atomic<uint64_t> uWritten;
+   int uThreadId;
+
+  public:
+   RingBuffer(size_t size, int threadId) : veEvents(size ? size : 1), uWritten(0), uThreadId(threadId) {}
+
+   void push(const Trace::Event& event)
+      {  uint64_t written = uWritten.load(std::memory_order_relaxed);
+         veEvents[written % veEvents.size()] = event;
+         uWritten.store(written+1, std::memory_order_release);
+      }
+   void clear() { uWritten.store(0, std::memory_order_release); }
+   int getThreadId() const { return uThreadId; }
+   template <class Function> void foreach(Function function) const
+      {  uint64_t written = uWritten.load(std::memory_order_acquire);
+         uint64_t first = written > veEvents.size() ? written - veEvents.size() : 0;
+         for (uint64_t index = first; index < written; ++index)
+            function(veEvents[index % veEvents.size()]);
+      }
+};
+
+class Registry {
+  private:
+   std::mutex mMutex;
+   std::vector<std::unique_ptr<RingBuffer>> vBuffers;
+   size_t uEventsPerThread = 0;
+   uint64_t uGeneration = 0;
+
+  public:
+   // buffers are never freed before the end of the process: the threads keep raw pointers
+   RingBuffer* registerThread(uint64_t& generation)
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         vBuffers.emplace_back(new RingBuffer(uEventsPerThread, (int) vBuffers.size()+1));
+         generation = uGeneration;
+         return vBuffers.back().get();
+      }
+   void setEventsPerThread(size_t eventsPerThread)
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         if (eventsPerThread != uEventsPerThread) {
+            uEventsPerThread = eventsPerThread;
+            ++uGeneration;
+         }
+      }
+   uint64_t getGeneration()
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         return uGeneration;
+      }
+   void clear()
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         for (auto& buffer : vBuffers)
+            buffer->clear();
+      }
+   template <class Function> void foreach(Function function)
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         for (const auto& buffer : vBuffers)
+            function(*buffer);
+      }
+};
+
+Registry& registry() {
+   static Registry* result = new Registry();
+   return *result;
+}
+
+std::atomic<uint64_t> currentGeneration(0);
+
+struct LocalBuffer {
+   RingBuffer* buffer = nullptr;
+   uint64_t generation = 0;
+};
+
+thread_local LocalBuffer localBuffer;
+
+}
+
+std::atomic<bool> Trace::fEnabled(false);
+thread_local int Trace::uCurrentContract = 0;
+
+void
+Trace::start(size_t eventsPerThread) {
+   registry().setEventsPerThread(eventsPerThread);
+   registry().clear();
+   currentGeneration.store(registry().getGeneration(), std::memory_order_relaxed);
+   fEnabled.store(true, std::memory_order_relaxed);
+}
+
+void
+Trace::clear() {
+   registry().clear();
+}
+
+void
+Trace::record(const Event& event) {
+   LocalBuffer& local = localBuffer;
+   if (!local.buffer || local.generation != currentGeneration.load(std::memory_order_relaxed))
+      local.buffer = registry().registerThread(local.generation);
+   local.buffer->push(event);
+}
+
+void
+Trace::writeJSon(std::ostream& out) {
+   // the Chrome trace format expects microseconds
+   auto writeMicroseconds = [&out](uint64_t nanoseconds)
+      {  out << nanoseconds/1000 << '.' << (char) ('0' + (nanoseconds/100) % 10)
+            << (char) ('0' + (nanoseconds/10) % 10) << (char) ('0' + nanoseconds % 10);
+      };
+   out << "{ \"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+   bool isFirst = true;
+   registry().foreach([&out, &isFirst, &writeMicroseconds](const RingBuffer& buffer)
+      {  buffer.foreach([&out, &isFirst, &writeMicroseconds, &buffer](const Event& event)
+            {  out << (isFirst ? "\n" : ",\n")
+                  << "  { \"name\": \"" << event.name << "\", \"cat\": \"checker\", \"ph\": \"X\", \"ts\": ";
+               writeMicroseconds(event.startNs);
+               out << ", \"dur\": ";
+               writeMicroseconds(event.durationNs);
+               out << ", \"pid\": 1, \"tid\": " << buffer.getThreadId()
+                  << ", \"args\": { \"contract\": " << event.contractId
+                  << ", \"address\": \"0x" << std::hex << event.address
+                  << "\", \"target\": \"0x" << event.target << std::dec << "\" } }";
+               isFirst = false;
+            });
+      });
+   out << "\n] }\n";
+}
+
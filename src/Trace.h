@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
+
+/* Optional timeline of the checker in the Chrome trace format (also read by
+ * Perfetto). Each thread records its events in its own ring buffer without
+ * any lock, the oldest events being overwritten when the buffer is full.
+ * The buffers are only registered (under a lock) on the first event of a
+ * thread and they are dumped when no check is running.
+ */
+class Trace {
+  public:
+   struct Event {
+      const char* name = nullptr;
+      uint64_t startNs = 0;
+      uint64_t durationNs = 0;
+      int contractId = 0;
+      uint64_t address = 0;
+      uint64_t target = 0;
+   };
+
+  private:
+   static std::atomic<bool> fEnabled;
+   static thread_local int uCurrentContract;
+
+   static uint64_t now()
+      {  return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>
+            (std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+   static void record(const Event& event);
+
+  public:
+   static bool isEnabled() { return fEnabled.load(std::memory_order_relaxed); }
+   static void start(size_t eventsPerThread);
+   static void stop() { fEnabled.store(false, std::memory_order_relaxed); }
+   static void clear();
+   static void writeJSon(std::ostream& out);
+
+   // contract of the decoder events of the thread, set by ContractScope
+   static int currentContract() { return uCurrentContract; }
+   class ContractScope {
+     private:
+      int uPrevious;
+
+     public:
+      explicit ContractScope(int contractId) : uPrevious(uCurrentContract)
+         {  uCurrentContract = contractId; }
+      ContractScope(const ContractScope&) = delete;
+      ~ContractScope() { uCurrentContract = uPrevious; }
+   };
+
+   // begin and end of a traced call, recorded as one complete event
+   class Scope {
+     private:
+      Event eEvent;
+      bool fIsActive;
+
+     public:
+      Scope(const char* name, int contractId = 0, uint64_t address = 0, uint64_t target = 0)
+         :  fIsActive(isEnabled())
+         {  if (fIsActive) {
+               eEvent.name = name;
+               eEvent.contractId = contractId;
+               eEvent.address = address;
+               eEvent.target = target;
+               eEvent.startNs = now();
+            }
+         }
+      Scope(const Scope&) = delete;
+      ~Scope()
+         {  if (fIsActive) {
+               eEvent.durationNs = now() - eEvent.startNs;
+               record(eEvent);
+            }
+         }
+   };
+};
+
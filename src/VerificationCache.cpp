@@ -0,0 +1,115 @@
+#include "VerificationCache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+const char* VerificationCache::szMagic = "FCCVC01";
+
+uint64_t
+VerificationCache::hashFile(const char* filename, uint64_t seed) {
+   std::ifstream in(filename, std::ifstream::binary);
+   if (!in.good())
+      // the library is found through the search path of the loader
+      return hash(filename, strlen(filename), seed);
+   uint64_t result = seed;
+   char buffer[4096];
+   while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+      result = hash(buffer, (size_t) in.gcount(), result);
+   return result;
+}
+
+bool
+VerificationCache::load() {
+   std::ifstream in(sFilename.c_str(), std::ifstream::binary);
+   if (!in.good())
+      return true;
+   Header header;
+   if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+      return false;
+   if (memcmp(header.magic, szMagic, sizeof(header.magic)) != 0)
+      return false;
+   if (header.pluginsHash != uPluginsHash) {
+      fIsModified = true;
+      return true;
+   }
+   std::vector<Entry> entries((size_t) header.entriesCount);
+   std::vector<Span> spans((size_t) header.spansCount);
+   if ((!entries.empty() && !in.read(reinterpret_cast<char*>(&entries[0]), entries.size()*sizeof(Entry)))
+         || (!spans.empty() && !in.read(reinterpret_cast<char*>(&spans[0]), spans.size()*sizeof(Span))))
+      return false;
+   for (const auto& entry : entries)
+      if ((uint64_t) entry.spansStart + entry.spansCount > spans.size())
+         return false;
+   vEntries.swap(entries);
+   vSpans.swap(spans);
+   return true;
+}
+
+bool
+VerificationCache::save() {
+   if (!fIsModified)
+      return true;
+   std::vector<Entry> entries;
+   entries.reserve(vEntries.size() + mNewEntries.size());
+   for (const auto& entry : vEntries)
+      if (mNewEntries.find(entry.key) == mNewEntries.end())
+         entries.push_back(entry);
+   for (const auto& entry : mNewEntries)
+      entries.push_back(entry.second);
+   std::sort(entries.begin(), entries.end());
+
+   // the spans of the replaced entries are dropped
+   std::vector<Span> spans;
+   spans.reserve(vSpans.size());
+   for (auto& entry : entries) {
+      uint32_t start = (uint32_t) spans.size();
+      spans.insert(spans.end(), vSpans.begin() + entry.spansStart,
+            vSpans.begin() + entry.spansStart + entry.spansCount);
+      entry.spansStart = start;
+   }
+
+   std::ofstream out(sFilename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+   if (!out.good())
+      return false;
+   Header header;
+   memcpy(header.magic, szMagic, sizeof(header.magic));
+   header.pluginsHash = uPluginsHash;
+   header.entriesCount = entries.size();
+   header.spansCount = spans.size();
+   out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+   if (!entries.empty())
+      out.write(reinterpret_cast<const char*>(&entries[0]), entries.size()*sizeof(Entry));
+   if (!spans.empty())
+      out.write(reinterpret_cast<const char*>(&spans[0]), spans.size()*sizeof(Span));
+   if (!out.good())
+      return false;
+   fIsModified = false;
+   return true;
+}
+
+const VerificationCache::Entry*
+VerificationCache::find(uint64_t key) const {
+   auto found = mNewEntries.find(key);
+   if (found != mNewEntries.end())
+      return &found->second;
+   Entry entry;
+   entry.key = key;
+   auto localize = std::lower_bound(vEntries.begin(), vEntries.end(), entry);
+   if (localize == vEntries.end() || localize->key != key)
+      return nullptr;
+   return &*localize;
+}
+
+void
+VerificationCache::insert(uint64_t key, const std::vector<Span>& spans, uint64_t codeHash,
+      bool verdict) {
+   Entry& entry = mNewEntries[key];
+   entry.key = key;
+   entry.codeHash = codeHash;
+   entry.spansStart = (uint32_t) vSpans.size();
+   entry.spansCount = (uint32_t) spans.size();
+   entry.verdict = verdict ? 1 : 0;
+   vSpans.insert(vSpans.end(), spans.begin(), spans.end());
+   fIsModified = true;
+}
+
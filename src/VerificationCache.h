@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* Opt-in cache of the verdicts of processor_check_block, kept between two
+ * runs in a local file. An entry is found by a key that hashes the block
+ * edge (start and target addresses) with the serialization of the pre and
+ * post contracts and of their dominators, and with the checking modes of
+ * the processor (fixpoint, parallel branches, early exit, block partition)
+ * since they change the verdicts; it records the spans of code interpreted
+ * by the check and the hash of their bytes, checked again before the verdict
+ * is reused. The hash of the architecture and domain libraries is stored in the header: the
+ * whole file is ignored when a plugin has changed.
+ *
+ * File layout (native endianness): a header, then the entries sorted by key,
+ * then the code spans, so that the file can be mapped and searched as is.
+ */
+class VerificationCache {
+  public:
+   struct Span {
+      uint64_t start = 0, end = 0;
+   };
+   struct Entry {
+      uint64_t key = 0;
+      uint64_t codeHash = 0;
+      uint32_t spansStart = 0;
+      uint32_t spansCount = 0;
+      uint32_t verdict = 0;
+      uint32_t reserved = 0;
+
+      bool operator<(const Entry& source) const { return key < source.key; }
+   };
+
+  private:
+   struct Header {
+      char magic[8];
+      uint64_t pluginsHash;
+      uint64_t entriesCount;
+      uint64_t spansCount;
+   };
+   static const char* szMagic;
+
+   std::string sFilename;
+   uint64_t uPluginsHash = 0;
+   std::vector<Entry> vEntries;   // read from the file, sorted by key
+   std::vector<Span> vSpans;
+   std::unordered_map<uint64_t, Entry> mNewEntries;
+   bool fIsModified = false;
+
+  public:
+   VerificationCache(const char* filename, uint64_t pluginsHash)
+      :  sFilename(filename), uPluginsHash(pluginsHash) {}
+
+   static const uint64_t InitialHash = 14695981039346656037ULL;
+   // FNV-1a, enough to detect the changes between two builds
+   static uint64_t hash(const void* content, size_t size, uint64_t seed = InitialHash)
+      {  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(content);
+         uint64_t result = seed;
+         for (size_t index = 0; index < size; ++index) {
+            result ^= bytes[index];
+            result *= 1099511628211ULL;
+         }
+         return result;
+      }
+   static uint64_t hashValue(uint64_t value, uint64_t seed = InitialHash)
+      {  return hash(&value, sizeof(value), seed); }
+   static uint64_t hashFile(const char* filename, uint64_t seed = InitialHash);
+
+   // false if the file exists but cannot be read; a stale file is ignored
+   bool load();
+   bool save();
+
+   const Entry* find(uint64_t key) const;
+   const Span* getSpans(const Entry& entry) const
+      {  return entry.spansCount > 0 ? &vSpans[entry.spansStart] : nullptr; }
+   void insert(uint64_t key, const std::vector<Span>& spans, uint64_t codeHash, bool verdict);
+};
+
@@ -11,10 +11,13 @@
 
 #include "contract_checker.h"
 #include "Processor.h"
+#include "Statistics.h"
+#include "Trace.h"
 #include <memory>
 #include <cassert>
 #include <vector>
 #include <iostream>
+#include <fstream>
 
 extern "C" {
 
@@ -42,6 +45,9 @@ void
 free_processor(struct _PProcessor* processor)
 {  try {
    delete reinterpret_cast<Processor*>(processor);
+#ifdef DefineAllocationTracking
+   AllocationTracking::writeSummary(std::cerr);
+#endif
    }
    catch (ESPreconditionError& error) {
      std::cerr << "unable to free the processor!\n";
@@ -72,6 +78,7 @@ bool
 processor_load_code(struct _PProcessor* aprocessor, const char* filename)
 {  try {
    Processor* processor = reinterpret_cast<Processor*>(aprocessor);
+   processor->clearBlockPartition();
    processor->binaryFile().open(filename, std::ifstream::binary);
    if (!processor->binaryFile().good())
       return false;
@@ -105,6 +112,108 @@ processor_set_loader_alloc_shift(struct _PProcessor* aprocessor, uint64_t shift)
    }
 }
 
+void
+processor_use_block_partition(struct _PProcessor* aprocessor)
+{  reinterpret_cast<Processor*>(aprocessor)->setUseBlockPartition(); }
+
+int
+processor_get_partition_blocks(struct _PProcessor* aprocessor)
+{  return reinterpret_cast<Processor*>(aprocessor)->getBlockPartition().getBlocksNumber(); }
+
+void
+processor_use_fixpoint(struct _PProcessor* aprocessor, int widening_delay)
+{  reinterpret_cast<Processor*>(aprocessor)->setUseFixpoint(widening_delay); }
+
+void
+processor_use_parallel_branches(struct _PProcessor* aprocessor, int threads)
+{  reinterpret_cast<Processor*>(aprocessor)->setParallelBranches(threads); }
+
+void
+processor_use_early_exit(struct _PProcessor* aprocessor)
+{  reinterpret_cast<Processor*>(aprocessor)->setUseEarlyExit(); }
+
+uint64_t
+processor_get_failure_address(struct _PProcessor* aprocessor)
+{  return reinterpret_cast<Processor*>(aprocessor)->getFailureAddress(); }
+
+bool
+processor_set_verification_cache(struct _PProcessor* aprocessor, const char* filename)
+{  try {
+   Processor* processor = reinterpret_cast<Processor*>(aprocessor);
+   Statistics::Collector statistics(processor->statistics(), processor->statisticsLock());
+   return processor->setVerificationCache(filename);
+   }
+   catch (ESPreconditionError& error) {
+     std::cerr << "unable to set the verification cache!\n";
+     error.print(std::cerr);
+     std::cerr.flush();
+     return false;
+   }
+   catch (...) {
+     std::cerr << "unable to set the verification cache!" << std::endl;
+     return false;
+   }
+}
+
+bool
+processor_save_verification_cache(struct _PProcessor* aprocessor)
+{  try {
+   Processor* processor = reinterpret_cast<Processor*>(aprocessor);
+   return processor->saveVerificationCache();
+   }
+   catch (ESPreconditionError& error) {
+     std::cerr << "unable to save the verification cache!\n";
+     error.print(std::cerr);
+     std::cerr.flush();
+     return false;
+   }
+   catch (...) {
+     std::cerr << "unable to save the verification cache!" << std::endl;
+     return false;
+   }
+}
+
+uint64_t
+processor_get_interpreted_instructions(struct _PProcessor* aprocessor)
+{  return reinterpret_cast<Processor*>(aprocessor)->getInterpretedInstructions(); }
+
+void
+processor_get_stats(struct _PProcessor* aprocessor, struct _CheckerStats* stats)
+{  reinterpret_cast<Processor*>(aprocessor)->retrieveStatistics(*stats); }
+
+void
+processor_reset_stats(struct _PProcessor* aprocessor)
+{  reinterpret_cast<Processor*>(aprocessor)->clearStatistics(); }
+
+void
+trace_start(size_t events_per_thread)
+{  try {
+   Trace::start(events_per_thread);
+   }
+   catch (...) {
+     std::cerr << "unable to start the trace!" << std::endl;
+   }
+}
+
+void
+trace_stop()
+{  Trace::stop(); }
+
+bool
+trace_write(const char* outputFilename)
+{  try {
+   std::ofstream out(outputFilename);
+   if (!out)
+      return false;
+   Trace::writeJSon(out);
+   return (bool) out;
+   }
+   catch (...) {
+     std::cerr << "unable to write the trace!" << std::endl;
+     return false;
+   }
+}
+
 struct _PDecisionVector*
 processor_create_decision_vector(struct _PProcessor* aprocessor)
 {  try {
@@ -179,6 +288,9 @@ processor_get_targets(struct _PProcessor* aprocessor, uint64_t address,
    Processor& processor = *reinterpret_cast<Processor*>(aprocessor);
    Contract& startContract = *reinterpret_cast<Contract*>(contract);
    DecisionVector& decision = *reinterpret_cast<DecisionVector*>(adecision);
+   Statistics::Collector statistics(processor.statistics(), processor.statisticsLock());
+   Trace::ContractScope contractScope(startContract.getId());
+   Trace::Scope trace("processor_get_targets", startContract.getId(), address);
    MemoryState memoryState(processor.getRegistersNumber(), processor.getDomainFunctions());
    MemoryInterpretParameters parameters;
    if (startContract.isInitial())
@@ -208,18 +320,73 @@ bool processor_check_block(struct _PProcessor* aprocessor, uint64_t address,
    Contract& lastContract = *reinterpret_cast<Contract*>(alastContract);
    DecisionVector& decision = *reinterpret_cast<DecisionVector*>(adecision);
    Warnings& warnings = *reinterpret_cast<Warnings*>(awarnings);
+   Statistics::Collector statistics(processor.statistics(), processor.statisticsLock());
+   Trace::ContractScope contractScope(firstContract.getId());
+   Trace::Scope trace("processor_check_block", firstContract.getId(), address, target);
+   ContractCoverage& coverage = *reinterpret_cast<ContractCoverage*>(acoverage);
+   VerificationCache* cache = processor.getVerificationCache();
+   uint64_t key = 0;
+   if (cache) {
+      key = VerificationCache::hashValue(address);
+      key = VerificationCache::hashValue(target, key);
+      key = VerificationCache::hashValue(firstContract.getAppliedContentHash(processor.getContent(),
+            &processor.getArchitectureFunctions()), key);
+      key = VerificationCache::hashValue(lastContract.getAppliedContentHash(processor.getContent(),
+            &processor.getArchitectureFunctions()), key);
+      key = processor.hashModes(key);
+      const VerificationCache::Entry* entry = cache->find(key);
+      if (entry && entry->codeHash == processor.hashCode(cache->getSpans(*entry), entry->spansCount)) {
+         Statistics::local().addCall(Statistics::CCacheHit);
+         // an early exit returns before the insertion: the entry has no failure
+         processor.clearFailureAddress();
+         coverage.add(firstContract, lastContract);
+         return entry->verdict != 0;
+      }
+      Statistics::local().addCall(Statistics::CCacheMiss);
+   }
    MemoryState memoryState(processor.getRegistersNumber(), processor.getDomainFunctions());
    MemoryInterpretParameters parameters;
-   if (firstContract.isInitial())
+   if (firstContract.isInitial()) {
       processor.initializeMemory(memoryState, parameters);
-   firstContract.applyTo(memoryState, processor.getContent(), &processor.getArchitectureFunctions());
-   processor.interpret(address, memoryState, target, decision, warnings, parameters);
-   MemoryState lastMemoryState(processor.getRegistersNumber(), processor.getDomainFunctions());
+      firstContract.applyTo(memoryState, processor.getContent(), &processor.getArchitectureFunctions());
+   }
+   else
+      // same state as the post state of the edges that reach firstContract
+      memoryState = firstContract.getAppliedState(processor.getRegistersNumber(),
+            processor.getDomainFunctions(), processor.getContent(), &processor.getArchitectureFunctions());
+   std::vector<uint64_t> stopAddresses;
+   if (processor.useFixpoint() || processor.useParallelBranches() || processor.useEarlyExit())
+      firstContract.retrieveNextAddresses(stopAddresses);
    // processor.initializeMemory(lastMemoryState, parameters);
-   lastContract.applyTo(lastMemoryState, processor.getContent(), &processor.getArchitectureFunctions());
-   ContractCoverage& coverage = *reinterpret_cast<ContractCoverage*>(acoverage);
+   const MemoryState& lastMemoryState = lastContract.getAppliedState(processor.getRegistersNumber(),
+         processor.getDomainFunctions(), processor.getContent(), &processor.getArchitectureFunctions());
    coverage.add(firstContract, lastContract);
-   return lastMemoryState.contain(memoryState, parameters);
+   if (!processor.interpret(address, memoryState, target, decision, warnings, parameters,
+         stopAddresses, processor.useEarlyExit() ? &lastMemoryState : nullptr))
+      // the interpretation has stopped: the verdict does not cover the whole block
+      return false;
+   // the edges that reach lastContract often end on the same state
+   std::vector<uint64_t> fingerprint;
+   bool hasFingerprint = lastContract.hasSeveralPreviouses()
+      && memoryState.retrieveFingerprint(fingerprint);
+   bool result;
+   if (hasFingerprint && lastContract.isProvenState(fingerprint)) {
+      Statistics::local().addCall(Statistics::CPostStateHit);
+      result = true;
+   }
+   else {
+      if (hasFingerprint)
+         Statistics::local().addCall(Statistics::CPostStateMiss);
+      result = lastMemoryState.contain(memoryState, parameters);
+      if (result && hasFingerprint)
+         lastContract.addProvenState(std::move(fingerprint));
+   }
+   if (cache) {
+      const auto& spans = processor.getInterpretedSpans();
+      cache->insert(key, spans, processor.hashCode(spans.empty() ? nullptr : &spans[0],
+            (int) spans.size()), result);
+   }
+   return result;
    }
    catch (ESPreconditionError& error) {
      std::cerr << "unable to check block!\n";
@@ -237,6 +404,8 @@ struct _ContractGraphContent* load_contracts(const char* inputFilename,
       struct _PProcessor* aprocessor, struct _WarningsContent* awarnings)
 {  try {
    Processor& processor = *reinterpret_cast<Processor*>(aprocessor);
+   Statistics::Collector statistics(processor.statistics(), processor.statisticsLock());
+   Trace::Scope trace("load_contracts");
    std::unique_ptr<ContractGraph> result(new ContractGraph());
    Warnings& warnings = *reinterpret_cast<Warnings*>(awarnings);
    result->loadFromFile(inputFilename, processor.getDomainFunctions(),
@@ -255,6 +424,27 @@ struct _ContractGraphContent* load_contracts(const char* inputFilename,
    }
 }
 
+bool
+save_contracts(struct _ContractGraphContent* acontracts, const char* outputFilename,
+      struct _PProcessor* aprocessor)
+{  try {
+   ContractGraph& contracts = *reinterpret_cast<ContractGraph*>(acontracts);
+   Processor& processor = *reinterpret_cast<Processor*>(aprocessor);
+   return contracts.saveFromFile(outputFilename, processor.getContent(),
+         &processor.getArchitectureFunctions());
+   }
+   catch (ESPreconditionError& error) {
+     std::cerr << "unable to save contracts!\n";
+     error.print(std::cerr);
+     std::cerr.flush();
+     return false;
+   }
+   catch (...) {
+     std::cerr << "unable to save contracts!" << std::endl;
+     return false;
+   }
+}
+
 bool contracts_has_alloc_shift(struct _ContractGraphContent* acontracts)
 {  return reinterpret_cast<ContractGraph*>(acontracts)->hasAllocShift(); }
 
@@ -620,11 +810,12 @@ warning_set_to_next(struct _WarningCursorContent* warning_cursor)
 void
 warning_retrieve_message(struct _WarningCursorContent* warning_cursor, struct _Warning* warning)
 {  try {
-   const auto& error = reinterpret_cast<Warnings::Cursor*>(warning_cursor)->elementAt();
-   warning->filepos = error.filepos().getChunk().string;
+   const auto& cursor = *reinterpret_cast<Warnings::Cursor*>(warning_cursor);
+   const auto& error = cursor.elementAt();
+   warning->filepos = cursor.filepos();
    warning->linepos = error.linepos();
    warning->columnpos = error.columnpos();
-   warning->message = error.getMessage().getChunk().string;
+   warning->message = cursor.getMessage();
    }
    catch (ESPreconditionError& error) {
      std::cerr << "unable to retrieve the warning message!\n";
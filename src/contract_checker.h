@@ -61,6 +61,57 @@ void free_processor(struct _PProcessor*);
 void processor_set_verbose(struct _PProcessor*);
 bool processor_load_code(struct _PProcessor* processor, const char* filename);
 void processor_set_loader_alloc_shift(struct _PProcessor* processor, uint64_t shift);
+/* processor_get_targets answers from a partition of the code in linear blocks,
+ * built once from the explored addresses with an unconstrained memory state */
+void processor_use_block_partition(struct _PProcessor* processor);
+int processor_get_partition_blocks(struct _PProcessor* processor);
+/* processor_check_block computes a fixpoint over the blocks between the two
+ * contracts, the loop heads being widened after widening_delay joins */
+void processor_use_fixpoint(struct _PProcessor* processor, int widening_delay);
+/* processor_check_block explores every branch between the two contracts and
+ * joins the states at the target, the forks running on a pool of threads;
+ * the decoder and the domain libraries must then accept concurrent calls */
+void processor_use_parallel_branches(struct _PProcessor* processor, int threads);
+/* processor_check_block applies the post contract before the interpretation
+ * and stops the single path as soon as a register of the post contract that
+ * is no longer written does not satisfy it; it then returns false and
+ * processor_get_failure_address gives the last instruction that wrote the
+ * register (or the start address). Requires the optional
+ * processor_get_written_registers of the decoder */
+void processor_use_early_exit(struct _PProcessor* processor);
+uint64_t processor_get_failure_address(struct _PProcessor* processor);
+/* opt-in cache of the processor_check_block verdicts in a local file, keyed by
+ * the hashes of the contracts, of the interpreted code and of the plugins */
+bool processor_set_verification_cache(struct _PProcessor* processor, const char* filename);
+bool processor_save_verification_cache(struct _PProcessor* processor);
+uint64_t processor_get_interpreted_instructions(struct _PProcessor* processor);
+
+struct _CheckerStats {
+   uint64_t contract_application_calls, contract_application_ns;
+   uint64_t expression_evaluation_calls, expression_evaluation_ns;
+   uint64_t next_targets_calls, next_targets_ns; /* processor_next_targets of the decoder */
+   uint64_t interpret_calls, interpret_ns;       /* processor_interpret of the decoder */
+   uint64_t contain_calls, contain_ns;           /* MemoryState::contain */
+   uint64_t domain_clone_calls, domain_free_calls, domain_merge_calls;
+   uint64_t file_reads, file_read_bytes, decoded_bytes;
+   uint64_t verification_cache_hits, verification_cache_misses;
+   uint64_t function_summary_hits, function_summary_misses;
+   uint64_t domain_compare_calls;
+   uint64_t proven_post_state_hits, proven_post_state_misses;
+   uint64_t inline_contain_calls; /* containments decided without the domain library */
+   uint64_t domain_clone_ns, domain_free_ns, domain_merge_ns, domain_compare_ns;
+};
+/* the counters are cumulated per processor, whatever the calling threads, over
+ * load_contracts, processor_set_verification_cache, processor_get_targets and
+ * processor_check_block */
+void processor_get_stats(struct _PProcessor* processor, struct _CheckerStats* stats);
+void processor_reset_stats(struct _PProcessor* processor);
+
+/* timeline of load_contracts, processor_get_targets, processor_check_block and
+ * of the decoder calls in per-thread ring buffers, written in Chrome trace JSON */
+void trace_start(size_t events_per_thread);
+void trace_stop();
+bool trace_write(const char* outputFilename);
 struct _PDecisionVector* processor_create_decision_vector(struct _PProcessor* processor);
 struct _PDecisionVector* processor_clone_decision_vector(struct _PDecisionVector* decision_vector);
 void processor_free_decision_vector(struct _PDecisionVector* decision_vector);
@@ -81,6 +132,8 @@ struct _ContractGraphContent;
 
 struct _ContractGraphContent* load_contracts(const char* inputFilename,
       struct _PProcessor* processor, struct _WarningsContent* awarnings);
+bool save_contracts(struct _ContractGraphContent* contracts, const char* outputFilename,
+      struct _PProcessor* processor);
 enum ContractConditionLocalization { CCLPreCondition, CCLPostCondition };
 bool contracts_has_alloc_shift(struct _ContractGraphContent* contracts);
 uint64_t contracts_get_alloc_shift(struct _ContractGraphContent* contracts);
@@ -88,6 +88,42 @@ typedef struct _ProcessorFunctions {
          MemoryModel* memory, MemoryModelFunctions* memory_functions,
          struct _DecisionVector* decision_vector, InterpretParameters* parameters);
 
+   /* Optional bulk version of processor_interpret, left null by the decoders that
+    * do not provide it. instruction_buffer starts at *address. The straight-line
+    * instructions are interpreted until target_address is reached (result true),
+    * until the next address is one of the stop_addresses, is not the sequential
+    * successor or leaves the buffer (result false). *address is then the next
+    * address, *interpreted_instructions and *decoded_bytes what has been done.
+    */
+   bool (*processor_interpret_range)(struct _Processor* processor, char* instruction_buffer,
+         size_t buffer_size, uint64_t* address, uint64_t target_address,
+         const uint64_t* stop_addresses, int stop_addresses_length,
+         MemoryModel* memory, MemoryModelFunctions* memory_functions,
+         struct _DecisionVector* decision_vector, InterpretParameters* parameters,
+         int* interpreted_instructions, size_t* decoded_bytes);
+
+   /* Optional recognition of the call instructions, left null by the decoders
+    * that do not provide it. Returns true if the instruction at address is a
+    * call, with the entry of the callee, the address where the callee returns
+    * and the registers that carry the arguments. The contract checker then
+    * interprets the callee once per abstraction of its arguments.
+    */
+   bool (*processor_get_call)(struct _Processor* processor, char* instruction_buffer,
+         size_t buffer_size, uint64_t address, uint64_t* callee_address,
+         uint64_t* return_address, const int** argument_registers,
+         int* argument_registers_length);
+
+   /* Optional description of the registers written by the instruction at
+    * address, left null by the decoders that do not provide it. Returns false
+    * if they are unknown or more than registers_capacity. A register narrowed
+    * by the instruction counts as written. The contract checker then checks
+    * the registers of the post-contract as soon as the path no longer writes
+    * them (see processor_use_early_exit).
+    */
+   bool (*processor_get_written_registers)(struct _Processor* processor,
+         char* instruction_buffer, size_t buffer_size, uint64_t address,
+         int* registers, int* registers_length, int registers_capacity);
+
 } ProcessorFunctions;
 
 #ifdef __cplusplus
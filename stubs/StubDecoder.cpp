@@ -0,0 +1,432 @@
+/////////////////////////////////
+//
+// Library   : Static Analysis
+// Unit      : stubs
+// File      : StubDecoder.cpp
+// Copyright : CEA LIST - 2020
+//
+// Description :
+//   Reference implementation of init_processor_functions for a tiny
+//   32-bit instruction set. Every instruction is 4 bytes long and costs a
+//   fixed number of domain calls, so that the contract checker can be
+//   benchmarked and profiled without the external decoder library.
+//
+// Encoding (little endian) : opcode | rd | rs | imm8
+//   0x00 nop
+//   0x01 movi  rd, imm8           rd := imm8
+//   0x02 addi  rd, rs, imm8       rd := rs + imm8
+//   0x03 add   rd, rs, rt         rd := rs + rt (rt in the imm8 field)
+//   0x04 subi  rd, rs, imm8       rd := rs - imm8
+//   0x05 ldr   rd, [rs + imm8]    rd := mem32[rs + imm8]
+//   0x06 str   rd, [rs + imm8]    mem32[rs + imm8] := rd
+//   0x07 b     off16              pc := pc + 4*off16 (off16 in rs|imm8)
+//   0x08 beqz  rd, off16          if rd == 0 then pc := pc + 4*off16
+//   0x09 bl    off16              lr := pc + 4; pc := pc + 4*off16
+//   0x0a halt                     no successor
+//   0x0b ret                      pc := lr
+//
+// The arguments of a call are in r0-r3.
+//
+
+#include <cstdio>
+#include <cstring>
+#include "decsec_callback.h"
+#include "target_address_decoder.h"
+
+namespace {
+
+enum Opcode
+{  ONop = 0x00, OMovi = 0x01, OAddi = 0x02, OAdd = 0x03, OSubi = 0x04, OLdr = 0x05,
+   OStr = 0x06, OBranch = 0x07, OBranchZero = 0x08, OCall = 0x09, OHalt = 0x0a,
+   OReturn = 0x0b
+};
+
+const int RegistersNumber = 16;
+const int InstructionSize = 4;
+const int StackPointerIndex = 13;
+const int LinkRegisterIndex = 14;
+const int ArgumentRegisters[] = { 0, 1, 2, 3 };
+const uint64_t StackPointerInitialValue = 0x80000;
+
+struct StubProcessor {
+   struct _DomainElementFunctions domainFunctions;
+   bool hasDomainFunctions = false;
+   bool isVerbose = false;
+};
+
+struct StubDecisionVector {
+   uint64_t lastFilter = 0;
+};
+
+struct Instruction {
+   int opcode = 0, rd = 0, rs = 0, imm = 0;
+   int64_t offset = 0;
+
+   bool setFromBuffer(const char* buffer, size_t size)
+      {  if (size < (size_t) InstructionSize)
+            return false;
+         const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer);
+         opcode = bytes[0];
+         rd = bytes[1] % RegistersNumber;
+         rs = bytes[2] % RegistersNumber;
+         imm = bytes[3];
+         offset = (int64_t) (int16_t) (bytes[2] | (bytes[3] << 8)) * InstructionSize;
+         return true;
+      }
+};
+
+const char* registerNames[RegistersNumber] = {
+   "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r11", "r12",
+   "sp", "lr", "pc"
+};
+
+DomainElement
+newConstant(StubProcessor& processor, uint64_t value) {
+   DomainIntegerConstant constant{ 32, false, value };
+   return (*processor.domainFunctions.multibit_create_constant)(constant);
+}
+
+DomainElement
+getRegister(StubProcessor& processor, int index, MemoryModel* memory,
+      MemoryModelFunctions* memoryFunctions, InterpretParameters* parameters) {
+   unsigned error = 0;
+   return (*memoryFunctions->get_register_value)(memory, index, parameters, &error, nullptr);
+}
+
+void
+setRegister(int index, DomainElement& value, MemoryModel* memory,
+      MemoryModelFunctions* memoryFunctions, InterpretParameters* parameters) {
+   unsigned error = 0;
+   (*memoryFunctions->set_register_value)(memory, index, &value, parameters, &error);
+   value.content = nullptr;
+}
+
+void
+applyPlus(StubProcessor& processor, DomainElement& value, DomainElement& source, bool isMinus=false) {
+   DomainEvaluationEnvironment env{};
+   (*processor.domainFunctions.multibit_binary_apply_assign)(&value,
+         isMinus ? DMBBOMinusUnsigned : DMBBOPlusUnsigned, source, &env);
+   (*processor.domainFunctions.free)(&source);
+}
+
+DomainElement
+computeAddress(StubProcessor& processor, const Instruction& instruction, MemoryModel* memory,
+      MemoryModelFunctions* memoryFunctions, InterpretParameters* parameters) {
+   DomainElement address = getRegister(processor, instruction.rs, memory, memoryFunctions, parameters);
+   DomainElement shift = newConstant(processor, instruction.imm);
+   applyPlus(processor, address, shift);
+   return address;
+}
+
+ZeroResult
+queryRegisterZero(StubProcessor& processor, int index, MemoryModel* memory,
+      MemoryModelFunctions* memoryFunctions, InterpretParameters* parameters) {
+   DomainElement value = getRegister(processor, index, memory, memoryFunctions, parameters);
+   ZeroResult result = (*processor.domainFunctions.query_zero_result)(value);
+   (*processor.domainFunctions.free)(&value);
+   return result;
+}
+
+// constant value of lr, false if it is unknown
+bool
+queryReturnAddress(StubProcessor& processor, MemoryModel* memory,
+      MemoryModelFunctions* memoryFunctions, InterpretParameters* parameters, uint64_t& address) {
+   DomainElement value = getRegister(processor, LinkRegisterIndex, memory, memoryFunctions, parameters);
+   DomainIntegerConstant constant{};
+   bool result = (*processor.domainFunctions.multibit_is_constant_value)(value, &constant);
+   (*processor.domainFunctions.free)(&value);
+   if (result)
+      address = constant.integerValue;
+   return result;
+}
+
+void
+addTarget(TargetAddresses* targets, uint64_t address) {
+   if (targets->addresses_length >= targets->addresses_array_size)
+      targets->addresses = (*targets->realloc_addresses)(targets->addresses,
+            targets->addresses_array_size, &targets->addresses_array_size, targets->address_container);
+   targets->addresses[targets->addresses_length++] = address;
+}
+
+}
+
+extern "C" {
+
+static struct _Processor*
+stub_create_processor()
+   {  return reinterpret_cast<struct _Processor*>(new StubProcessor()); }
+
+static void
+stub_set_domain_functions(struct _Processor* aprocessor, struct _DomainElementFunctions* functionTable) {
+   StubProcessor* processor = reinterpret_cast<StubProcessor*>(aprocessor);
+   processor->domainFunctions = *functionTable;
+   processor->hasDomainFunctions = true;
+}
+
+static struct _DomainElementFunctions*
+stub_get_domain_functions(struct _Processor* aprocessor) {
+   StubProcessor* processor = reinterpret_cast<StubProcessor*>(aprocessor);
+   return processor->hasDomainFunctions ? &processor->domainFunctions : nullptr;
+}
+
+static void
+stub_initialize_memory(struct _Processor* aprocessor, MemoryModel* memory,
+      MemoryModelFunctions* memoryFunctions, InterpretParameters* parameters) {
+   StubProcessor& processor = *reinterpret_cast<StubProcessor*>(aprocessor);
+   (*memoryFunctions->set_number_of_registers)(memory, RegistersNumber);
+   DomainElement stackPointer = newConstant(processor, StackPointerInitialValue);
+   setRegister(StackPointerIndex, stackPointer, memory, memoryFunctions, parameters);
+}
+
+static void
+stub_set_verbose(struct _Processor* aprocessor)
+   {  reinterpret_cast<StubProcessor*>(aprocessor)->isVerbose = true; }
+
+static void
+stub_free_processor(struct _Processor* aprocessor)
+   {  delete reinterpret_cast<StubProcessor*>(aprocessor); }
+
+static int
+stub_get_registers_number(struct _Processor*)
+   {  return RegistersNumber; }
+
+static int
+stub_get_register_index(struct _Processor*, const char* name) {
+   for (int index = 0; index < RegistersNumber; ++index)
+      if (std::strcmp(registerNames[index], name) == 0)
+         return index;
+   return -1;
+}
+
+static const char*
+stub_get_register_name(struct _Processor*, int registerIndex)
+   {  return (registerIndex >= 0 && registerIndex < RegistersNumber) ? registerNames[registerIndex] : nullptr; }
+
+static struct _DecisionVector*
+stub_create_decision_vector(struct _Processor*)
+   {  return reinterpret_cast<struct _DecisionVector*>(new StubDecisionVector()); }
+
+static struct _DecisionVector*
+stub_clone_decision_vector(struct _DecisionVector* decisionVector) {
+   return reinterpret_cast<struct _DecisionVector*>(new StubDecisionVector(
+         *reinterpret_cast<StubDecisionVector*>(decisionVector)));
+}
+
+static void
+stub_free_decision_vector(struct _DecisionVector* decisionVector)
+   {  delete reinterpret_cast<StubDecisionVector*>(decisionVector); }
+
+static void
+stub_filter_decision_vector(struct _DecisionVector* decisionVector, uint64_t address)
+   {  reinterpret_cast<StubDecisionVector*>(decisionVector)->lastFilter = address; }
+
+static bool
+stub_processor_next_targets(struct _Processor* aprocessor, char* instructionBuffer,
+      size_t bufferSize, uint64_t address, struct _TargetAddresses* targetAddresses,
+      MemoryModel* memory, MemoryModelFunctions* memoryFunctions,
+      struct _DecisionVector* decisionVector, InterpretParameters* parameters) {
+   StubProcessor& processor = *reinterpret_cast<StubProcessor*>(aprocessor);
+   Instruction instruction;
+   if (!instruction.setFromBuffer(instructionBuffer, bufferSize))
+      return false;
+   targetAddresses->addresses_length = 0;
+   switch (instruction.opcode) {
+      case OHalt:
+         break;
+      case OBranch: case OCall:
+         addTarget(targetAddresses, address + instruction.offset);
+         break;
+      case OBranchZero:
+         {  ZeroResult test = queryRegisterZero(processor, instruction.rd, memory,
+                  memoryFunctions, parameters);
+            if (test != ZRDifferentZero)
+               addTarget(targetAddresses, address + instruction.offset);
+            if (test != ZRZero)
+               addTarget(targetAddresses, address + InstructionSize);
+         }
+         break;
+      case OReturn:
+         {  uint64_t returnAddress = 0;
+            if (queryReturnAddress(processor, memory, memoryFunctions, parameters, returnAddress))
+               addTarget(targetAddresses, returnAddress);
+         }
+         break;
+      default:
+         addTarget(targetAddresses, address + InstructionSize);
+         break;
+   }
+   return true;
+}
+
+static bool
+stub_processor_interpret(struct _Processor* aprocessor, char* instructionBuffer,
+      size_t bufferSize, uint64_t* address, uint64_t targetAddress,
+      MemoryModel* memory, MemoryModelFunctions* memoryFunctions,
+      struct _DecisionVector* decisionVector, InterpretParameters* parameters) {
+   StubProcessor& processor = *reinterpret_cast<StubProcessor*>(aprocessor);
+   Instruction instruction;
+   if (!instruction.setFromBuffer(instructionBuffer, bufferSize))
+      return true;
+   if (processor.isVerbose)
+      std::printf("%llx: %02x %d %d %d\n", (unsigned long long) *address,
+            instruction.opcode, instruction.rd, instruction.rs, instruction.imm);
+   uint64_t nextAddress = *address + InstructionSize;
+   switch (instruction.opcode) {
+      case OMovi:
+         {  DomainElement value = newConstant(processor, instruction.imm);
+            setRegister(instruction.rd, value, memory, memoryFunctions, parameters);
+         }
+         break;
+      case OAddi: case OSubi:
+         {  DomainElement value = getRegister(processor, instruction.rs, memory, memoryFunctions, parameters);
+            DomainElement source = newConstant(processor, instruction.imm);
+            applyPlus(processor, value, source, instruction.opcode == OSubi);
+            setRegister(instruction.rd, value, memory, memoryFunctions, parameters);
+         }
+         break;
+      case OAdd:
+         {  DomainElement value = getRegister(processor, instruction.rs, memory, memoryFunctions, parameters);
+            DomainElement source = getRegister(processor, instruction.imm % RegistersNumber,
+                  memory, memoryFunctions, parameters);
+            applyPlus(processor, value, source);
+            setRegister(instruction.rd, value, memory, memoryFunctions, parameters);
+         }
+         break;
+      case OLdr:
+         {  DomainElement address = computeAddress(processor, instruction, memory, memoryFunctions, parameters);
+            unsigned error = 0;
+            DomainElement value = (*memoryFunctions->load_multibit_value)(memory, address, 32,
+                  parameters, &error, nullptr);
+            (*processor.domainFunctions.free)(&address);
+            setRegister(instruction.rd, value, memory, memoryFunctions, parameters);
+         }
+         break;
+      case OStr:
+         {  DomainElement address = computeAddress(processor, instruction, memory, memoryFunctions, parameters);
+            DomainElement value = getRegister(processor, instruction.rd, memory, memoryFunctions, parameters);
+            unsigned error = 0;
+            (*memoryFunctions->store_value)(memory, address, value, parameters, &error);
+            (*processor.domainFunctions.free)(&address);
+            (*processor.domainFunctions.free)(&value);
+         }
+         break;
+      case OBranch:
+         nextAddress = *address + instruction.offset;
+         break;
+      case OCall:
+         {  DomainElement returnAddress = newConstant(processor, *address + InstructionSize);
+            setRegister(LinkRegisterIndex, returnAddress, memory, memoryFunctions, parameters);
+            nextAddress = *address + instruction.offset;
+         }
+         break;
+      case OReturn:
+         if (!queryReturnAddress(processor, memory, memoryFunctions, parameters, nextAddress)) {
+            *address = targetAddress;
+            return true;
+         }
+         break;
+      case OBranchZero:
+         {  uint64_t branchAddress = *address + instruction.offset;
+            ZeroResult test = queryRegisterZero(processor, instruction.rd, memory,
+                  memoryFunctions, parameters);
+            if (test == ZRZero || (test == ZRUndefined && branchAddress == targetAddress))
+               nextAddress = branchAddress;
+         }
+         break;
+      case OHalt:
+         *address = targetAddress;
+         return true;
+      default:
+         break;
+   }
+   *address = nextAddress;
+   return nextAddress == targetAddress;
+}
+
+static bool
+stub_processor_interpret_range(struct _Processor* aprocessor, char* instructionBuffer,
+      size_t bufferSize, uint64_t* address, uint64_t targetAddress,
+      const uint64_t* stopAddresses, int stopAddressesLength,
+      MemoryModel* memory, MemoryModelFunctions* memoryFunctions,
+      struct _DecisionVector* decisionVector, InterpretParameters* parameters,
+      int* interpretedInstructions, size_t* decodedBytes) {
+   *interpretedInstructions = 0;
+   *decodedBytes = 0;
+   size_t position = 0;
+   while (position + InstructionSize <= bufferSize) {
+      uint64_t instructionAddress = *address;
+      bool hasFound = stub_processor_interpret(aprocessor, instructionBuffer + position,
+            bufferSize - position, address, targetAddress, memory, memoryFunctions,
+            decisionVector, parameters);
+      ++*interpretedInstructions;
+      *decodedBytes += InstructionSize;
+      if (hasFound)
+         return true;
+      if (*address != instructionAddress + InstructionSize)
+         return false;
+      for (int index = 0; index < stopAddressesLength; ++index)
+         if (*address == stopAddresses[index])
+            return false;
+      position += InstructionSize;
+   }
+   return false;
+}
+
+static bool
+stub_processor_get_call(struct _Processor*, char* instructionBuffer, size_t bufferSize,
+      uint64_t address, uint64_t* calleeAddress, uint64_t* returnAddress,
+      const int** argumentRegisters, int* argumentRegistersLength) {
+   Instruction instruction;
+   if (!instruction.setFromBuffer(instructionBuffer, bufferSize) || instruction.opcode != OCall)
+      return false;
+   *calleeAddress = address + instruction.offset;
+   *returnAddress = address + InstructionSize;
+   *argumentRegisters = ArgumentRegisters;
+   *argumentRegistersLength = sizeof(ArgumentRegisters)/sizeof(ArgumentRegisters[0]);
+   return true;
+}
+
+static bool
+stub_processor_get_written_registers(struct _Processor*, char* instructionBuffer,
+      size_t bufferSize, uint64_t, int* registers, int* registersLength, int registersCapacity) {
+   Instruction instruction;
+   if (!instruction.setFromBuffer(instructionBuffer, bufferSize) || registersCapacity < 1)
+      return false;
+   *registersLength = 0;
+   switch (instruction.opcode) {
+      case OMovi: case OAddi: case OAdd: case OSubi: case OLdr:
+         registers[(*registersLength)++] = instruction.rd;
+         break;
+      case OCall:
+         registers[(*registersLength)++] = LinkRegisterIndex;
+         break;
+      default:
+         break;
+   }
+   return true;
+}
+
+uint64_t
+init_processor_functions(struct _ProcessorFunctions* functions) {
+   functions->create_processor = &stub_create_processor;
+   functions->set_domain_functions = &stub_set_domain_functions;
+   functions->get_domain_functions = &stub_get_domain_functions;
+   functions->initialize_memory = &stub_initialize_memory;
+   functions->set_verbose = &stub_set_verbose;
+   functions->free_processor = &stub_free_processor;
+   functions->get_registers_number = &stub_get_registers_number;
+   functions->get_register_index = &stub_get_register_index;
+   functions->get_register_name = &stub_get_register_name;
+   functions->create_decision_vector = &stub_create_decision_vector;
+   functions->clone_decision_vector = &stub_clone_decision_vector;
+   functions->free_decision_vector = &stub_free_decision_vector;
+   functions->filter_decision_vector = &stub_filter_decision_vector;
+   functions->processor_next_targets = &stub_processor_next_targets;
+   functions->processor_interpret = &stub_processor_interpret;
+   functions->processor_interpret_range = &stub_processor_interpret_range;
+   functions->processor_get_call = &stub_processor_get_call;
+   functions->processor_get_written_registers = &stub_processor_get_written_registers;
+   return 1;
+}
+
+}
@@ -0,0 +1,1052 @@
+/////////////////////////////////
+//
+// Library   : Static Analysis
+// Unit      : stubs
+// File      : StubDomain.cpp
+// Copyright : CEA LIST - 2020
+//
+// Description :
+//   Reference implementation of the domain_* symbols with a constant/interval
+//   domain. Every operation has a constant cost, so that the contract checker
+//   can be benchmarked and profiled without the external domain library.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+extern "C" {
+
+#define DLL_API
+#define DefineStartGenericFunctions
+#define DefineEndGenericFunctions
+#define DefineDomainPrefix(x) domain_##x
+#include "AbstractDomain.inch"
+#undef DefineDomainPrefix
+#undef DefineEndGenericFunctions
+#undef DefineStartGenericFunctions
+#undef DLL_API
+
+}
+
+namespace {
+
+/* A value is an unsigned interval [uMin, uMax] of sizeInBits bits. Signed
+ * intervals that cross 0 cannot be represented and become top. Floating
+ * point values are either top or a constant.
+ */
+struct StubValue {
+   DomainType type = DTUndefined;
+   int sizeInBits = 0;
+   bool isTop = true;
+   uint64_t uMin = 0, uMax = 0;
+   long double floatValue = 0;
+
+   StubValue() = default;
+   StubValue(DomainType atype, int size) : type(atype), sizeInBits(size) {}
+   StubValue(const StubValue&) = default;
+
+   static uint64_t mask(int size)
+      {  return (size >= 64 || size <= 0) ? ~(uint64_t) 0 : ((((uint64_t) 1) << size) - 1); }
+   static int64_t signedValue(uint64_t value, int size)
+      {  if (size >= 64 || size <= 0)
+            return (int64_t) value;
+         uint64_t sign = ((uint64_t) 1) << (size-1);
+         return (int64_t) ((value ^ sign) - sign);
+      }
+
+   bool isConstant() const { return !isTop && (type == DTFloating || uMin == uMax); }
+   bool isFullRange() const { return isTop || (type != DTFloating && uMin == 0 && uMax == mask(sizeInBits)); }
+   StubValue& setTop() { isTop = true; uMin = 0; uMax = mask(sizeInBits); floatValue = 0; return *this; }
+   StubValue& setInterval(uint64_t min, uint64_t max)
+      {  if (min > max)
+            return setTop();
+         isTop = false;
+         uMin = min & mask(sizeInBits);
+         uMax = max & mask(sizeInBits);
+         if (uMin > uMax)
+            return setTop();
+         if (uMin == 0 && uMax == mask(sizeInBits))
+            isTop = true;
+         return *this;
+      }
+   StubValue& setConstant(uint64_t value) { return setInterval(value & mask(sizeInBits), value & mask(sizeInBits)); }
+   StubValue& setFloatConstant(long double value) { isTop = false; floatValue = value; return *this; }
+   /* retrieve the bounds as signed integers, false if the interval crosses 0 */
+   bool getSignedBounds(int64_t& min, int64_t& max) const
+      {  if (isFullRange())
+            return false;
+         min = signedValue(uMin, sizeInBits);
+         max = signedValue(uMax, sizeInBits);
+         return min <= max;
+      }
+   StubValue& setSignedInterval(int64_t min, int64_t max)
+      {  if (min > max)
+            return setTop();
+         if ((min < 0) != (max < 0))
+            return setTop();
+         return setInterval((uint64_t) min, (uint64_t) max);
+      }
+};
+
+StubValue& value(DomainElement element) { return *reinterpret_cast<StubValue*>(element.content); }
+DomainElement wrap(StubValue* avalue) { return DomainElement{ avalue }; }
+DomainElement newValue(const StubValue& source) { return wrap(new StubValue(source)); }
+DomainElement newTop(DomainType type, int size) { return wrap(&(new StubValue(type, size))->setTop()); }
+DomainElement newConstant(DomainType type, int size, uint64_t val)
+   {  return wrap(&(new StubValue(type, size))->setConstant(val)); }
+void freeValue(DomainElement& element)
+   {  delete reinterpret_cast<StubValue*>(element.content); element.content = nullptr; }
+
+ZeroResult zeroResult(const StubValue& source) {
+   if (source.isTop)
+      return ZRUndefined;
+   if (source.type == DTFloating)
+      return source.floatValue == 0 ? ZRZero : ZRDifferentZero;
+   if (source.uMax == 0)
+      return ZRZero;
+   if (source.uMin > 0)
+      return ZRDifferentZero;
+   return ZRUndefined;
+}
+
+StubValue bitFromZeroResult(ZeroResult result, bool isNegated=false) {
+   StubValue bit(DTBit, 1);
+   if (result == ZRZero)
+      bit.setConstant(isNegated ? 1 : 0);
+   else if (result == ZRDifferentZero)
+      bit.setConstant(isNegated ? 0 : 1);
+   else
+      bit.setTop();
+   return bit;
+}
+
+ZeroResult fromBool(bool value) { return value ? ZRDifferentZero : ZRZero; }
+
+void applyMultiBitBinary(StubValue& target, DomainMultiBitBinaryOperation operation,
+      const StubValue& source) {
+   int size = target.sizeInBits;
+   uint64_t mask = StubValue::mask(size);
+   if (operation == DMBBOConcat) {
+      int newSize = target.sizeInBits + source.sizeInBits;
+      StubValue result(DTInteger, newSize);
+      if (target.isConstant() && source.isConstant() && newSize <= 64)
+         result.setConstant((target.uMin << source.sizeInBits) | source.uMin);
+      else
+         result.setTop();
+      target = result;
+      return;
+   }
+   if (target.isTop || source.isTop) {
+      target.setTop();
+      return;
+   }
+   if (target.isConstant() && source.isConstant()) {
+      uint64_t first = target.uMin, second = source.uMin;
+      int64_t sfirst = StubValue::signedValue(first, size), ssecond = StubValue::signedValue(second, size);
+      uint64_t result = 0;
+      switch (operation) {
+         case DMBBOPlusSigned: case DMBBOPlusUnsigned: case DMBBOPlusUnsignedWithSigned:
+            result = first + second; break;
+         case DMBBOMinusSigned: case DMBBOMinusUnsigned:
+            result = first - second; break;
+         case DMBBOMinSigned: result = (uint64_t) (sfirst < ssecond ? sfirst : ssecond); break;
+         case DMBBOMinUnsigned: result = first < second ? first : second; break;
+         case DMBBOMaxSigned: result = (uint64_t) (sfirst > ssecond ? sfirst : ssecond); break;
+         case DMBBOMaxUnsigned: result = first > second ? first : second; break;
+         case DMBBOTimesSigned: case DMBBOTimesUnsigned:
+            result = first * second; break;
+         case DMBBODivideSigned:
+            if (ssecond == 0) { target.setTop(); return; }
+            result = (uint64_t) (sfirst / ssecond); break;
+         case DMBBODivideUnsigned:
+            if (second == 0) { target.setTop(); return; }
+            result = first / second; break;
+         case DMBBOModuloSigned:
+            if (ssecond == 0) { target.setTop(); return; }
+            result = (uint64_t) (sfirst % ssecond); break;
+         case DMBBOModuloUnsigned:
+            if (second == 0) { target.setTop(); return; }
+            result = first % second; break;
+         case DMBBOBitOr: result = first | second; break;
+         case DMBBOBitAnd: result = first & second; break;
+         case DMBBOBitExclusiveOr: result = first ^ second; break;
+         case DMBBOLeftShift: result = second >= 64 ? 0 : first << second; break;
+         case DMBBOLogicalRightShift: result = second >= 64 ? 0 : first >> second; break;
+         case DMBBOArithmeticRightShift:
+            result = (uint64_t) (second >= 64 ? (sfirst < 0 ? -1 : 0) : (sfirst >> second)); break;
+         case DMBBOLeftRotate:
+            second %= size;
+            result = second ? ((first << second) | (first >> (size - second))) : first; break;
+         case DMBBORightRotate:
+            second %= size;
+            result = second ? ((first >> second) | (first << (size - second))) : first; break;
+         default:
+            target.setTop();
+            return;
+      }
+      target.setConstant(result & mask);
+      return;
+   }
+   switch (operation) {
+      case DMBBOPlusUnsigned: case DMBBOPlusSigned: case DMBBOPlusUnsignedWithSigned:
+         if (target.uMax <= mask - source.uMax)
+            target.setInterval(target.uMin + source.uMin, target.uMax + source.uMax);
+         else
+            target.setTop();
+         return;
+      case DMBBOMinusUnsigned: case DMBBOMinusSigned:
+         if (target.uMin >= source.uMax)
+            target.setInterval(target.uMin - source.uMax, target.uMax - source.uMin);
+         else
+            target.setTop();
+         return;
+      case DMBBOBitAnd:
+         target.setInterval(0, target.uMax < source.uMax ? target.uMax : source.uMax);
+         return;
+      case DMBBOMinUnsigned:
+         target.setInterval(target.uMin < source.uMin ? target.uMin : source.uMin,
+               target.uMax < source.uMax ? target.uMax : source.uMax);
+         return;
+      case DMBBOMaxUnsigned:
+         target.setInterval(target.uMin > source.uMin ? target.uMin : source.uMin,
+               target.uMax > source.uMax ? target.uMax : source.uMax);
+         return;
+      case DMBBOLogicalRightShift:
+         if (source.isConstant() && source.uMin < 64)
+            target.setInterval(target.uMin >> source.uMin, target.uMax >> source.uMin);
+         else
+            target.setTop();
+         return;
+      default:
+         target.setTop();
+         return;
+   }
+}
+
+ZeroResult compareMultiBit(const StubValue& first, DomainMultiBitCompareOperation operation,
+      const StubValue& second) {
+   if (first.isTop || second.isTop)
+      return ZRUndefined;
+   bool isSigned = false;
+   switch (operation) {
+      case DMBCOCompareLessSigned: case DMBCOCompareLessOrEqualSigned:
+      case DMBCOCompareGreaterOrEqualSigned: case DMBCOCompareGreaterSigned:
+         isSigned = true;
+         break;
+      default:
+         break;
+   }
+   int64_t fmin = 0, fmax = 0, smin = 0, smax = 0;
+   if (isSigned) {
+      if (!first.getSignedBounds(fmin, fmax) || !second.getSignedBounds(smin, smax))
+         return ZRUndefined;
+   }
+   auto lessThan = [&](bool isStrict) -> ZeroResult
+      {  if (isSigned) {
+            if (isStrict ? (fmax < smin) : (fmax <= smin)) return ZRDifferentZero;
+            if (isStrict ? (fmin >= smax) : (fmin > smax)) return ZRZero;
+         }
+         else {
+            if (isStrict ? (first.uMax < second.uMin) : (first.uMax <= second.uMin)) return ZRDifferentZero;
+            if (isStrict ? (first.uMin >= second.uMax) : (first.uMin > second.uMax)) return ZRZero;
+         }
+         return ZRUndefined;
+      };
+   auto negate = [](ZeroResult result)
+      {  return result == ZRZero ? ZRDifferentZero : (result == ZRDifferentZero ? ZRZero : ZRUndefined); };
+   switch (operation) {
+      case DMBCOCompareLessSigned: case DMBCOCompareLessUnsigned:
+         return lessThan(true);
+      case DMBCOCompareLessOrEqualSigned: case DMBCOCompareLessOrEqualUnsigned:
+         return lessThan(false);
+      case DMBCOCompareGreaterOrEqualSigned: case DMBCOCompareGreaterOrEqualUnsigned:
+         return negate(lessThan(true));
+      case DMBCOCompareGreaterSigned: case DMBCOCompareGreaterUnsigned:
+         return negate(lessThan(false));
+      case DMBCOCompareEqual:
+         if (first.isConstant() && second.isConstant())
+            return fromBool(first.uMin == second.uMin);
+         if (first.uMax < second.uMin || second.uMax < first.uMin)
+            return ZRZero;
+         return ZRUndefined;
+      case DMBCOCompareDifferent:
+         if (first.isConstant() && second.isConstant())
+            return fromBool(first.uMin != second.uMin);
+         if (first.uMax < second.uMin || second.uMax < first.uMin)
+            return ZRDifferentZero;
+         return ZRUndefined;
+      default:
+         return ZRUndefined;
+   }
+}
+
+ZeroResult compareFloat(const StubValue& first, DomainMultiFloatCompareOperation operation,
+      const StubValue& second) {
+   if (first.isTop || second.isTop)
+      return ZRUndefined;
+   switch (operation) {
+      case DMFCOCompareLess: return fromBool(first.floatValue < second.floatValue);
+      case DMFCOCompareLessOrEqual: return fromBool(first.floatValue <= second.floatValue);
+      case DMFCOCompareEqual: return fromBool(first.floatValue == second.floatValue);
+      case DMFCOCompareDifferent: return fromBool(first.floatValue != second.floatValue);
+      case DMFCOCompareGreaterOrEqual: return fromBool(first.floatValue >= second.floatValue);
+      case DMFCOCompareGreater: return fromBool(first.floatValue > second.floatValue);
+      default: return ZRUndefined;
+   }
+}
+
+int compareValues(const StubValue& first, const StubValue& second) {
+   if (first.type != second.type)
+      return first.type < second.type ? -1 : 1;
+   if (first.sizeInBits != second.sizeInBits)
+      return first.sizeInBits < second.sizeInBits ? -1 : 1;
+   if (first.isTop != second.isTop)
+      return first.isTop ? 1 : -1;
+   if (first.isTop)
+      return 0;
+   if (first.type == DTFloating)
+      return (first.floatValue < second.floatValue) ? -1 : ((first.floatValue > second.floatValue) ? 1 : 0);
+   if (first.uMin != second.uMin)
+      return first.uMin < second.uMin ? -1 : 1;
+   if (first.uMax != second.uMax)
+      return first.uMax < second.uMax ? -1 : 1;
+   return 0;
+}
+
+}
+
+extern "C" {
+
+DomainType domain_get_type(DomainElement domain) { return value(domain).type; }
+ZeroResult domain_query_zero_result(DomainElement domain) { return zeroResult(value(domain)); }
+int domain_get_size_in_bits(DomainElement domain) { return value(domain).sizeInBits; }
+bool domain_is_top(DomainElement domain) { return value(domain).isFullRange(); }
+void domain_free(DomainElement* element) { freeValue(*element); }
+DomainElement domain_clone(DomainElement element) { return newValue(value(element)); }
+
+DomainBitElement domain_bit_create_constant(bool val) { return newConstant(DTBit, 1, val ? 1 : 0); }
+DomainBitElement domain_bit_create_top(bool isSymbolic) { return newTop(DTBit, 1); }
+
+DomainMultiBitElement
+domain_bit_create_cast_multibit(DomainBitElement bitDomain, int sizeInBits, DomainEvaluationEnvironment* env) {
+   const StubValue& source = value(bitDomain);
+   StubValue result(DTInteger, sizeInBits);
+   if (source.isTop)
+      result.setInterval(0, 1);
+   else
+      result.setInterval(source.uMin, source.uMax);
+   return newValue(result);
+}
+
+bool
+domain_bit_unary_apply_assign(DomainBitElement* element, DomainBitUnaryOperation operation,
+      DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   if (!target.isConstant())
+      target.setTop();
+   else if (operation == DBUONegate)
+      target.setConstant(1 - target.uMin);
+   else if (operation == DBUOPrev || operation == DBUONext)
+      target.setConstant(target.uMin ^ 1);
+   return true;
+}
+
+DomainBitElement
+domain_bit_create_unary_apply(DomainBitElement element, DomainBitUnaryOperation operation,
+      DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_bit_unary_apply_assign(&result, operation, env);
+   return result;
+}
+
+bool
+domain_bit_binary_apply_assign(DomainBitElement* element, DomainBitBinaryOperation operation,
+      DomainBitElement asource, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   const StubValue& source = value(asource);
+   if (!target.isConstant() || !source.isConstant()) {
+      if (operation == DBBOAnd && ((target.isConstant() && target.uMin == 0)
+               || (source.isConstant() && source.uMin == 0)))
+         target.setConstant(0);
+      else if (operation == DBBOOr && ((target.isConstant() && target.uMin == 1)
+               || (source.isConstant() && source.uMin == 1)))
+         target.setConstant(1);
+      else
+         target.setTop();
+      return true;
+   }
+   uint64_t first = target.uMin, second = source.uMin;
+   switch (operation) {
+      case DBBOPlus: case DBBOExclusiveOr: case DBBOMinus: target.setConstant(first ^ second); break;
+      case DBBOMin: case DBBOAnd: target.setConstant(first & second); break;
+      case DBBOMax: case DBBOOr: target.setConstant(first | second); break;
+      default: target.setTop(); break;
+   }
+   return true;
+}
+
+DomainBitElement
+domain_bit_create_binary_apply(DomainBitElement element, DomainBitBinaryOperation operation,
+      DomainBitElement source, DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_bit_binary_apply_assign(&result, operation, source, env);
+   return result;
+}
+
+ZeroResult
+domain_bit_binary_compare(DomainBitElement element, DomainBitCompareOperation operation,
+      DomainBitElement asource, DomainEvaluationEnvironment* env) {
+   const StubValue& first = value(element);
+   const StubValue& second = value(asource);
+   if (!first.isConstant() || !second.isConstant())
+      return ZRUndefined;
+   switch (operation) {
+      case DBCOCompareLess: return fromBool(first.uMin < second.uMin);
+      case DBCOCompareLessOrEqual: return fromBool(first.uMin <= second.uMin);
+      case DBCOCompareEqual: return fromBool(first.uMin == second.uMin);
+      case DBCOCompareDifferent: return fromBool(first.uMin != second.uMin);
+      case DBCOCompareGreaterOrEqual: return fromBool(first.uMin >= second.uMin);
+      case DBCOCompareGreater: return fromBool(first.uMin > second.uMin);
+      default: return ZRUndefined;
+   }
+}
+
+DomainBitElement
+domain_bit_binary_compare_domain(DomainBitElement element, DomainBitCompareOperation operation,
+      DomainBitElement source, DomainEvaluationEnvironment* env) {
+   return newValue(bitFromZeroResult(domain_bit_binary_compare(element, operation, source, env)));
+}
+
+DomainBitElement
+domain_bit_guard_assign(DomainBitElement* condition, DomainBitElement* first,
+      DomainBitElement* second, DomainEvaluationEnvironment* env) {
+   ZeroResult test = zeroResult(value(*condition));
+   if (test == ZRDifferentZero)
+      return newValue(value(*first));
+   if (test == ZRZero)
+      return newValue(value(*second));
+   DomainElement result = newValue(value(*first));
+   domain_merge(&result, *second, env);
+   return result;
+}
+
+ZeroResult domain_bit_query_boolean(DomainBitElement element) { return zeroResult(value(element)); }
+
+bool domain_bit_cast_multibit_constraint(DomainMultiBitElement result, int sizeInBits,
+      DomainBitElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_bit_unary_constraint(DomainBitElement result, DomainBitUnaryOperation operation,
+      DomainBitElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_bit_binary_constraint(DomainBitElement result, DomainBitBinaryOperation operation,
+      DomainBitElement* first, DomainBitElement* second, DomainEvaluationEnvironment* env) { return true; }
+bool domain_bit_compare_constraint(DomainBitElement result, DomainBitCompareOperation operation,
+      DomainBitElement* first, DomainBitElement* second, DomainEvaluationEnvironment* env) { return true; }
+
+bool
+domain_bit_is_constant_value(DomainBitElement domain, bool* val) {
+   const StubValue& source = value(domain);
+   if (!source.isConstant())
+      return false;
+   if (val)
+      *val = source.uMin != 0;
+   return true;
+}
+
+DomainMultiBitElement
+domain_multibit_create_constant(DomainIntegerConstant val) {
+   return newConstant(DTInteger, val.sizeInBits, val.integerValue);
+}
+
+DomainMultiBitElement
+domain_multibit_create_top(int sizeInBits, bool isSymbolic) { return newTop(DTInteger, sizeInBits); }
+
+DomainMultiBitElement
+domain_multibit_create_interval_and_absorb(DomainMultiBitElement* min, DomainMultiBitElement* max,
+      bool isSigned, bool isSymbolic) {
+   const StubValue& minValue = value(*min);
+   const StubValue& maxValue = value(*max);
+   StubValue result(DTInteger, minValue.sizeInBits);
+   if (minValue.isTop || maxValue.isTop)
+      result.setTop();
+   else if (isSigned)
+      result.setSignedInterval(StubValue::signedValue(minValue.uMin, minValue.sizeInBits),
+            StubValue::signedValue(maxValue.uMax, maxValue.sizeInBits));
+   else
+      result.setInterval(minValue.uMin, maxValue.uMax);
+   freeValue(*min);
+   freeValue(*max);
+   return newValue(result);
+}
+
+DomainBitElement
+domain_multibit_create_cast_bit(DomainMultiBitElement multibitDomain, DomainEvaluationEnvironment* env) {
+   return newValue(bitFromZeroResult(zeroResult(value(multibitDomain))));
+}
+
+DomainBitElement
+domain_multibit_create_cast_shift_bit(DomainMultiBitElement multibitDomain, int shift,
+      DomainEvaluationEnvironment* env) {
+   const StubValue& source = value(multibitDomain);
+   if (source.isConstant() && shift >= 0 && shift < 64)
+      return newConstant(DTBit, 1, (source.uMin >> shift) & 1);
+   return newTop(DTBit, 1);
+}
+
+DomainMultiBitElement
+domain_multibit_create_cast_multibit(DomainMultiBitElement multibitSource, int destinationSizeInBits,
+      bool isSigned, DomainEvaluationEnvironment* env) {
+   const StubValue& source = value(multibitSource);
+   StubValue result(DTInteger, destinationSizeInBits);
+   if (source.isTop)
+      result.setTop();
+   else if (destinationSizeInBits >= source.sizeInBits) {
+      int64_t min, max;
+      if (isSigned && source.getSignedBounds(min, max))
+         result.setSignedInterval(min, max);
+      else if (isSigned && source.isConstant())
+         result.setConstant((uint64_t) StubValue::signedValue(source.uMin, source.sizeInBits));
+      else
+         result.setInterval(source.uMin, source.uMax);
+   }
+   else if (source.uMax <= StubValue::mask(destinationSizeInBits))
+      result.setInterval(source.uMin, source.uMax);
+   else if (source.isConstant())
+      result.setConstant(source.uMin);
+   else
+      result.setTop();
+   return newValue(result);
+}
+
+DomainMultiFloatElement
+domain_multibit_create_cast_multifloat(DomainMultiBitElement multibitDomain, int sizeInBits,
+      bool isSigned, DomainEvaluationEnvironment* env) {
+   const StubValue& source = value(multibitDomain);
+   StubValue result(DTFloating, sizeInBits);
+   if (source.isConstant())
+      result.setFloatConstant(isSigned ? (long double) StubValue::signedValue(source.uMin, source.sizeInBits)
+            : (long double) source.uMin);
+   return newValue(result);
+}
+
+DomainMultiFloatElement
+domain_multibit_create_cast_multifloat_ptr(DomainMultiBitElement multibitDomain, int sizeInBits,
+      bool isSigned, DomainEvaluationEnvironment* env) {
+   return newTop(DTFloating, sizeInBits);
+}
+
+bool
+domain_multibit_unary_apply_assign(DomainMultiBitElement* element,
+      DomainMultiBitUnaryOperation operation, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   if (target.isTop)
+      return true;
+   uint64_t mask = StubValue::mask(target.sizeInBits);
+   switch (operation) {
+      case DMBUOPrevSigned: case DMBUOPrevUnsigned:
+         if (target.uMin > 0)
+            target.setInterval(target.uMin-1, target.uMax-1);
+         else
+            target.setTop();
+         break;
+      case DMBUONextSigned: case DMBUONextUnsigned:
+         if (target.uMax < mask)
+            target.setInterval(target.uMin+1, target.uMax+1);
+         else
+            target.setTop();
+         break;
+      case DMBUOBitNegate:
+         target.setInterval(~target.uMax & mask, ~target.uMin & mask);
+         break;
+      case DMBUOOppositeSigned:
+         if (target.isConstant())
+            target.setConstant((~target.uMin + 1) & mask);
+         else
+            target.setTop();
+         break;
+      default:
+         target.setTop();
+         break;
+   }
+   return true;
+}
+
+DomainMultiBitElement
+domain_multibit_create_unary_apply(DomainMultiBitElement element,
+      DomainMultiBitUnaryOperation operation, DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_multibit_unary_apply_assign(&result, operation, env);
+   return result;
+}
+
+bool
+domain_multibit_extend_apply_assign(DomainMultiBitElement* element,
+      DomainMultiBitExtendOperation operation, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   StubValue result(DTInteger, operation.new_size);
+   if (target.isTop)
+      result.setTop();
+   else if (operation.type == DMBEOExtendWithSign) {
+      int64_t min, max;
+      if (target.getSignedBounds(min, max))
+         result.setSignedInterval(min, max);
+      else
+         result.setTop();
+   }
+   else
+      result.setInterval(target.uMin, target.uMax);
+   target = result;
+   return true;
+}
+
+DomainMultiBitElement
+domain_multibit_create_extend_apply(DomainMultiBitElement element,
+      DomainMultiBitExtendOperation operation, DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_multibit_extend_apply_assign(&result, operation, env);
+   return result;
+}
+
+bool
+domain_multibit_reduce_apply_assign(DomainMultiBitElement* element,
+      DomainMultiBitReduceOperation operation, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   StubValue result(DTInteger, operation.last_bit - operation.first_bit + 1);
+   if (target.isConstant() && operation.first_bit >= 0 && operation.first_bit < 64)
+      result.setConstant(target.uMin >> operation.first_bit);
+   else if (!target.isTop && operation.first_bit == 0 && target.uMax <= StubValue::mask(result.sizeInBits))
+      result.setInterval(target.uMin, target.uMax);
+   else
+      result.setTop();
+   target = result;
+   return true;
+}
+
+DomainMultiBitElement
+domain_multibit_create_reduce_apply(DomainMultiBitElement element,
+      DomainMultiBitReduceOperation operation, DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_multibit_reduce_apply_assign(&result, operation, env);
+   return result;
+}
+
+bool
+domain_multibit_bitset_apply_assign(DomainMultiBitElement* element,
+      DomainMultiBitSetOperation operation, DomainMultiBitElement asource,
+      DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   const StubValue& source = value(asource);
+   int width = operation.last_bit - operation.first_bit + 1;
+   if (target.isConstant() && source.isConstant() && operation.first_bit >= 0 && width > 0
+         && operation.last_bit < 64) {
+      uint64_t fieldMask = StubValue::mask(width) << operation.first_bit;
+      target.setConstant((target.uMin & ~fieldMask) | ((source.uMin << operation.first_bit) & fieldMask));
+   }
+   else
+      target.setTop();
+   return true;
+}
+
+DomainMultiBitElement
+domain_multibit_create_bitset_apply(DomainMultiBitElement element,
+      DomainMultiBitSetOperation operation, DomainMultiBitElement source,
+      DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_multibit_bitset_apply_assign(&result, operation, source, env);
+   return result;
+}
+
+bool
+domain_multibit_binary_apply_assign(DomainMultiBitElement* element,
+      DomainMultiBitBinaryOperation operation, DomainMultiBitElement source,
+      DomainEvaluationEnvironment* env) {
+   applyMultiBitBinary(value(*element), operation, value(source));
+   return true;
+}
+
+DomainMultiBitElement
+domain_multibit_create_binary_apply(DomainMultiBitElement element,
+      DomainMultiBitBinaryOperation operation, DomainMultiBitElement source,
+      DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   applyMultiBitBinary(value(result), operation, value(source));
+   return result;
+}
+
+ZeroResult
+domain_multibit_binary_compare(DomainMultiBitElement element,
+      DomainMultiBitCompareOperation operation, DomainMultiBitElement source,
+      DomainEvaluationEnvironment* env) {
+   return compareMultiBit(value(element), operation, value(source));
+}
+
+DomainBitElement
+domain_multibit_binary_compare_domain(DomainMultiBitElement element,
+      DomainMultiBitCompareOperation operation, DomainMultiBitElement source,
+      DomainEvaluationEnvironment* env) {
+   return newValue(bitFromZeroResult(compareMultiBit(value(element), operation, value(source))));
+}
+
+DomainMultiBitElement
+domain_multibit_guard_assign(DomainBitElement* condition, DomainMultiBitElement* first,
+      DomainMultiBitElement* second, DomainEvaluationEnvironment* env) {
+   return domain_bit_guard_assign(condition, first, second, env);
+}
+
+ZeroResult domain_multibit_query_boolean(DomainMultiBitElement element) { return zeroResult(value(element)); }
+
+bool domain_multibit_cast_bit_constraint(DomainBitElement result,
+      DomainMultiBitElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_cast_shift_bit_constraint(DomainBitElement result,
+      int shift, DomainMultiBitElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_cast_multifloat_constraint(DomainMultiFloatElement result,
+      int sizeInBits, bool isSigned, DomainMultiBitElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_cast_multifloat_ptr_constraint(DomainMultiFloatElement result,
+      int sizeInBits, bool isSigned, DomainMultiBitElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_unary_constraint(DomainMultiBitElement result,
+      DomainMultiBitUnaryOperation operation, DomainMultiBitElement* element,
+      DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_extend_constraint(DomainMultiBitElement result,
+      DomainMultiBitExtendOperation operation, DomainMultiBitElement* element,
+      DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_reduce_constraint(DomainMultiBitElement result,
+      DomainMultiBitReduceOperation operation, DomainMultiBitElement* element,
+      DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_bitset_constraint(DomainMultiBitElement result,
+      DomainMultiBitSetOperation operation, DomainMultiBitElement* first,
+      DomainMultiBitElement* second, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_binary_constraint(DomainMultiBitElement result,
+      DomainMultiBitBinaryOperation operation, DomainMultiBitElement* first,
+      DomainMultiBitElement* second, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multibit_compare_constraint(DomainBitElement result,
+      DomainMultiBitCompareOperation operation, DomainMultiBitElement* first,
+      DomainMultiBitElement* second, DomainEvaluationEnvironment* env) { return true; }
+
+bool
+domain_multibit_is_constant_value(DomainMultiBitElement domain, DomainIntegerConstant* val) {
+   const StubValue& source = value(domain);
+   if (!source.isConstant())
+      return false;
+   if (val) {
+      val->sizeInBits = source.sizeInBits;
+      val->isSigned = false;
+      val->integerValue = source.uMin;
+   }
+   return true;
+}
+
+bool
+domain_multibit_is_constant_disjunction(DomainMultiBitElement domain, int* number_of_elements) {
+   const StubValue& source = value(domain);
+   if (source.isTop || source.uMax - source.uMin >= 16)
+      return false;
+   if (number_of_elements)
+      *number_of_elements = (int) (source.uMax - source.uMin + 1);
+   return true;
+}
+
+bool
+domain_multibit_retrieve_constant_values(DomainMultiBitElement domain,
+      DomainIntegerConstant* values, int number_of_elements) {
+   const StubValue& source = value(domain);
+   if (source.isTop || (uint64_t) number_of_elements != source.uMax - source.uMin + 1)
+      return false;
+   for (int index = 0; index < number_of_elements; ++index) {
+      values[index].sizeInBits = source.sizeInBits;
+      values[index].isSigned = false;
+      values[index].integerValue = source.uMin + index;
+   }
+   return true;
+}
+
+DomainMultiFloatElement
+domain_multifloat_create_constant(DomainFloatingPointConstant val) {
+   StubValue result(DTFloating, val.sizeInBits);
+   return newValue(result.setFloatConstant(val.floatValue));
+}
+
+DomainMultiFloatElement
+domain_multifloat_create_top(int sizeInBits, bool isSymbolic) { return newTop(DTFloating, sizeInBits); }
+
+DomainMultiFloatElement
+domain_multifloat_create_interval_and_absorb(DomainMultiFloatElement* min,
+      DomainMultiFloatElement* max, bool isSymbolic) {
+   StubValue result(value(*min));
+   if (compareValues(value(*min), value(*max)) != 0)
+      result.setTop();
+   freeValue(*min);
+   freeValue(*max);
+   return newValue(result);
+}
+
+DomainMultiBitElement
+domain_multifloat_create_cast_multibit(DomainMultiFloatElement multibitDomain, int sizeInBits,
+      DomainEvaluationEnvironment* env) {
+   const StubValue& source = value(multibitDomain);
+   if (source.isConstant() && source.floatValue >= 0 && source.floatValue < 18446744073709551616.0L)
+      return newConstant(DTInteger, sizeInBits, (uint64_t) source.floatValue);
+   return newTop(DTInteger, sizeInBits);
+}
+
+DomainMultiBitElement
+domain_multifloat_query_to_multibit(DomainMultiFloatElement multifloatDomain,
+      DomainMultiFloatToIntOperation operation, DomainEvaluationEnvironment* env) {
+   return newTop(DTInteger, value(multifloatDomain).sizeInBits);
+}
+
+bool
+domain_multifloat_cast_multifloat_assign(DomainMultiFloatElement* element, int size_in_bits,
+      DomainEvaluationEnvironment* env) {
+   value(*element).sizeInBits = size_in_bits;
+   return true;
+}
+
+DomainMultiFloatElement
+domain_multifloat_cast_multifloat(DomainMultiFloatElement element, int size_in_bits,
+      DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   value(result).sizeInBits = size_in_bits;
+   return result;
+}
+
+bool
+domain_multifloat_unary_apply_assign(DomainMultiFloatElement* element,
+      DomainMultiFloatUnaryOperation operation, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   if (target.isTop)
+      return true;
+   switch (operation) {
+      case DMFUOCastFloat: case DMFUOCastDouble: break;
+      case DMFUOOpposite: target.floatValue = -target.floatValue; break;
+      case DMFUOAbs: case DMFUOFabs: target.floatValue = std::fabs(target.floatValue); break;
+      default: target.setTop(); break;
+   }
+   return true;
+}
+
+DomainMultiFloatElement
+domain_multifloat_create_unary_apply(DomainMultiFloatElement element,
+      DomainMultiFloatUnaryOperation operation, DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_multifloat_unary_apply_assign(&result, operation, env);
+   return result;
+}
+
+DomainBitElement
+domain_multifloat_flush_to_zero(DomainMultiFloatElement* element, DomainEvaluationEnvironment* env) {
+   return newConstant(DTBit, 1, 0);
+}
+
+bool
+domain_multifloat_binary_apply_assign(DomainMultiFloatElement* element,
+      DomainMultiFloatBinaryOperation operation, DomainMultiFloatElement asource,
+      DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   const StubValue& source = value(asource);
+   if (target.isTop || source.isTop) {
+      target.setTop();
+      return true;
+   }
+   switch (operation) {
+      case DMFBOPlus: target.floatValue += source.floatValue; break;
+      case DMFBOMinus: target.floatValue -= source.floatValue; break;
+      case DMFBOTimes: target.floatValue *= source.floatValue; break;
+      case DMFBODivide:
+         if (source.floatValue == 0)
+            target.setTop();
+         else
+            target.floatValue /= source.floatValue;
+         break;
+      case DMFBOMin: if (source.floatValue < target.floatValue) target.floatValue = source.floatValue; break;
+      case DMFBOMax: if (source.floatValue > target.floatValue) target.floatValue = source.floatValue; break;
+      default: target.setTop(); break;
+   }
+   return true;
+}
+
+DomainMultiFloatElement
+domain_multifloat_create_binary_apply(DomainMultiFloatElement element,
+      DomainMultiFloatBinaryOperation operation, DomainMultiFloatElement source,
+      DomainEvaluationEnvironment* env) {
+   DomainElement result = newValue(value(element));
+   domain_multifloat_binary_apply_assign(&result, operation, source, env);
+   return result;
+}
+
+ZeroResult
+domain_multifloat_binary_compare(DomainMultiFloatElement element,
+      DomainMultiFloatCompareOperation operation, DomainMultiFloatElement source,
+      DomainEvaluationEnvironment* env) {
+   return compareFloat(value(element), operation, value(source));
+}
+
+DomainBitElement
+domain_multifloat_binary_compare_domain(DomainMultiFloatElement element,
+      DomainMultiFloatCompareOperation operation, DomainMultiFloatElement source,
+      DomainEvaluationEnvironment* env) {
+   return newValue(bitFromZeroResult(compareFloat(value(element), operation, value(source))));
+}
+
+DomainMultiBitElement
+domain_multifloat_binary_full_compare_domain(DomainMultiFloatElement element,
+      DomainMultiFloatElement source, DomainEvaluationEnvironment* env) {
+   return newTop(DTInteger, 2);
+}
+
+DomainMultiFloatElement
+domain_multifloat_guard_assign(DomainBitElement* condition, DomainMultiFloatElement* first,
+      DomainMultiFloatElement* second, DomainEvaluationEnvironment* env) {
+   return domain_bit_guard_assign(condition, first, second, env);
+}
+
+bool
+domain_multifloat_ternary_apply_assign(DomainMultiFloatElement* element,
+      DomainMultiFloatTernaryOperation operation, DomainMultiFloatElement second,
+      DomainMultiFloatElement third, DomainEvaluationEnvironment* env) {
+   value(*element).setTop();
+   return true;
+}
+
+DomainBitElement
+domain_multifloat_ternary_query(DomainMultiFloatElement multifloatDomain,
+      DomainMultiFloatQueryOperation operation, DomainMultiFloatElement first,
+      DomainMultiFloatElement second, DomainEvaluationEnvironment* env) {
+   return newTop(DTBit, 1);
+}
+
+DomainMultiFloatElement
+domain_multifloat_create_ternary_apply(DomainMultiFloatElement element,
+      DomainMultiFloatTernaryOperation operation, DomainMultiFloatElement second,
+      DomainMultiFloatElement third, DomainEvaluationEnvironment* env) {
+   return newTop(DTFloating, value(element).sizeInBits);
+}
+
+bool domain_multifloat_cast_multibit_constraint(DomainMultiBitElement result,
+      int sizeInBits, DomainMultiFloatElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multifloat_query_to_multibit_constraint(DomainMultiBitElement result,
+      DomainMultiFloatToIntOperation operation, DomainMultiFloatElement* element,
+      DomainEvaluationEnvironment* env) { return true; }
+bool domain_multifloat_cast_multifloat_constraint(DomainMultiFloatElement result,
+      int size_in_bits, DomainMultiFloatElement* element, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multifloat_unary_constraint(DomainMultiFloatElement result,
+      DomainMultiFloatUnaryOperation operation, DomainMultiFloatElement* element,
+      DomainEvaluationEnvironment* env) { return true; }
+bool domain_multifloat_binary_constraint(DomainMultiFloatElement result,
+      DomainMultiFloatBinaryOperation operation, DomainMultiFloatElement* first,
+      DomainMultiFloatElement* second, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multifloat_compare_constraint(DomainBitElement result,
+      DomainMultiFloatCompareOperation operation, DomainMultiFloatElement* first,
+      DomainMultiFloatElement* second, DomainEvaluationEnvironment* env) { return true; }
+bool domain_multifloat_ternary_constraint(DomainMultiFloatElement result,
+      DomainMultiFloatTernaryOperation operation, DomainMultiFloatElement* first,
+      DomainMultiFloatElement* second, DomainMultiFloatElement* third,
+      DomainEvaluationEnvironment* env) { return true; }
+
+bool
+domain_multifloat_is_constant_value(DomainMultiFloatElement domain, DomainFloatingPointConstant* val) {
+   const StubValue& source = value(domain);
+   if (!source.isConstant())
+      return false;
+   if (val) {
+      val->sizeInBits = source.sizeInBits;
+      val->floatValue = source.floatValue;
+   }
+   return true;
+}
+
+char*
+domain_write(DomainElement domain, char* buffer, int buffer_size, int* length,
+      void* writer, char* (*increase_buffer_size)(char* buffer, int old_length, int new_length, void* writer)) {
+   const StubValue& source = value(domain);
+   char text[100];
+   int textLength;
+   if (source.isTop)
+      textLength = std::snprintf(text, sizeof(text), source.type == DTBit ? "Tb" : "T_%d", source.sizeInBits);
+   else if (source.type == DTFloating)
+      textLength = std::snprintf(text, sizeof(text), "%Lg_%d", source.floatValue, source.sizeInBits);
+   else if (source.uMin == source.uMax)
+      textLength = std::snprintf(text, sizeof(text), "0x%llx_%d",
+            (unsigned long long) source.uMin, source.sizeInBits);
+   else
+      textLength = std::snprintf(text, sizeof(text), "[0x%llx_%d, 0x%llx_%d]",
+            (unsigned long long) source.uMin, source.sizeInBits,
+            (unsigned long long) source.uMax, source.sizeInBits);
+   if (textLength >= buffer_size)
+      buffer = (*increase_buffer_size)(buffer, buffer_size, textLength+1, writer);
+   std::memcpy(buffer, text, textLength+1);
+   *length = textLength;
+   return buffer;
+}
+
+bool
+domain_merge(DomainElement* element, DomainElement asource, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   const StubValue& source = value(asource);
+   if (target.isTop)
+      return true;
+   if (source.isTop || target.type != source.type || target.sizeInBits != source.sizeInBits)
+      target.setTop();
+   else if (target.type == DTFloating) {
+      if (target.floatValue != source.floatValue)
+         target.setTop();
+   }
+   else
+      target.setInterval(target.uMin < source.uMin ? target.uMin : source.uMin,
+            target.uMax > source.uMax ? target.uMax : source.uMax);
+   return true;
+}
+
+bool
+domain_intersect(DomainElement* element, DomainElement asource, DomainEvaluationEnvironment* env) {
+   StubValue& target = value(*element);
+   const StubValue& source = value(asource);
+   if (source.isTop || target.type != source.type || target.sizeInBits != source.sizeInBits)
+      return true;
+   if (target.isTop || target.type == DTFloating) {
+      target = source;
+      return true;
+   }
+   uint64_t min = target.uMin > source.uMin ? target.uMin : source.uMin;
+   uint64_t max = target.uMax < source.uMax ? target.uMax : source.uMax;
+   if (min <= max)
+      target.setInterval(min, max);
+   else // no bottom element: keep the most recent information
+      target = source;
+   return true;
+}
+
+bool
+domain_contain(DomainElement element, DomainElement asource, DomainEvaluationEnvironment* env) {
+   const StubValue& target = value(element);
+   const StubValue& source = value(asource);
+   if (target.type != source.type)
+      return false;
+   if (target.isFullRange())
+      return true;
+   if (source.isTop || target.sizeInBits != source.sizeInBits)
+      return false;
+   if (target.type == DTFloating)
+      return target.floatValue == source.floatValue;
+   return target.uMin <= source.uMin && source.uMax <= target.uMax;
+}
+
+int
+domain_compare(DomainElement element, DomainElement source) {
+   return compareValues(value(element), value(source));
+}
+
+DomainElement
+domain_create_disjunction_and_absorb(DomainElement* element) {
+   DomainElement result = *element;
+   element->content = nullptr;
+   return result;
+}
+
+void
+domain_disjunction_absorb(DomainElement* disjunction, DomainElement* element) {
+   domain_merge(disjunction, *element, nullptr);
+   freeValue(*element);
+}
+
+void domain_specialize(DomainElement* element) {}
+
+}
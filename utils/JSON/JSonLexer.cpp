@@ -30,6 +30,9 @@
 #include "JSON/JSonLexer.h"
 // #include "JSON/JSonParser.h"
 
+#define DefineAllocationRegion
+#include "StandardClasses/DefineNew.h"
+
 namespace STG { namespace JSon {
 
 /***************************************************/
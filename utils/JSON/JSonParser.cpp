@@ -567,6 +567,9 @@ BasicWriter::State::writeEndArray(SubString& out, bool isPretty) {
 
 void
 BasicWriter::write(OSBase& out) {
+#ifdef DefineAllocationTracking
+   AllocationTracking::Scope allocationScope(AllocationTracking::SJSon);
+#endif
    SString buffer(5000);
    WriteResult result = WRNeedEvent;
    while (result != WRFinished) {
@@ -756,6 +759,9 @@ BasicParser::parseChunk(SubString& subString, unsigned& line, unsigned& column,
 
 void
 BasicParser::parse(ISBase& in) {
+#ifdef DefineAllocationTracking
+   AllocationTracking::Scope allocationScope(AllocationTracking::SJSon);
+#endif
    SubString buffer(SString(5000));
    unsigned line = 1;
    unsigned column = 1;
@@ -1085,7 +1091,7 @@ CommonParser::Arguments::convertReaderToInt(Event newEvent) {
       };
 
       if (isError) {
-         addErrorMessage(STG::SString("int value expected"));
+         addErrorMessage("int value expected");
          setIntValue(0);
          convertIntValue(newEvent);
          return RRContinue;
@@ -1099,7 +1105,7 @@ CommonParser::Arguments::convertReaderToInt(Event newEvent) {
       return result;
    fContinuedToken = false;
    if (res.isFloat()) {
-      addErrorMessage(STG::SString("int value expected (not float)"));
+      addErrorMessage("int value expected (not float)");
       setIntValue((int) res.getContent().queryFloat());
       convertIntValue(newEvent);
    }
@@ -34,6 +34,8 @@
 #include "Collection/Collection.hpp"
 #include "Pointer/DescentParse.h"
 #include <cstdint>
+#include <string>
+#include <vector>
 
 namespace STG { namespace JSon {
 
@@ -550,27 +552,77 @@ class CommonParser : public BasicParser {
 
       /* for inlining */
      public:
-      class ErrorMessage : public COL::List::Node {
+      class ErrorMessages;
+      class ErrorMessage {
         private:
-         STG::SubString ssMessage;
-         STG::SubString ssFilePos;
+         const char* szMessage;  // static text, nullptr if the text is stored in ErrorMessages
+         int uMessageIndex;
          unsigned uLinePos;
          unsigned uColumnPos;
+         friend class ErrorMessages;
 
         public:
-         ErrorMessage(const STG::SubString& message, const STG::SubString& filePos,
-               unsigned linePos, unsigned columnPos)
-            :  ssMessage(message), ssFilePos(filePos), uLinePos(linePos), uColumnPos(columnPos) {}
-         const STG::SubString& getMessage() const { return ssMessage; }
-         const STG::SubString& filepos() const { return ssFilePos; }
+         ErrorMessage(const char* message, int messageIndex, unsigned linePos, unsigned columnPos)
+            :  szMessage(message), uMessageIndex(messageIndex), uLinePos(linePos), uColumnPos(columnPos) {}
          unsigned linepos() const { return uLinePos; }
          unsigned columnpos() const { return uColumnPos; }
       };
 
+      // flat storage of compact error records; the texts are only retrieved on demand
+      class ErrorMessages {
+        private:
+         std::vector<ErrorMessage> vemErrors;
+         std::vector<SString> vssMessages;
+         std::string sFilename; // of all the records
+
+        public:
+         class Cursor {
+           private:
+            const ErrorMessages* pemSupport;
+            int uIndex = -1;
+
+           public:
+            Cursor(const ErrorMessages& support) : pemSupport(&support) {}
+            bool setToNext() { return ++uIndex < (int) pemSupport->vemErrors.size(); }
+            bool isValid() const { return uIndex >= 0 && uIndex < (int) pemSupport->vemErrors.size(); }
+            const ErrorMessage& elementAt() const { AssumeCondition(isValid()) return pemSupport->vemErrors[uIndex]; }
+            const char* getMessage() const { return pemSupport->getMessage(elementAt()); }
+            const char* filepos() const { return pemSupport->sFilename.c_str(); }
+         };
+
+         ErrorMessages() = default;
+         ErrorMessages(const ErrorMessages&) = default;
+         ErrorMessages& operator=(const ErrorMessages&) = default;
+
+         void setFilename(const char* filename) { sFilename = filename ? filename : ""; }
+         const std::string& getFilename() const { return sFilename; }
+         void add(const char* message, unsigned linePos, unsigned columnPos)
+            {  vemErrors.push_back(ErrorMessage(message, -1, linePos, columnPos)); }
+         void add(const SubString& message, unsigned linePos, unsigned columnPos)
+            {  vssMessages.push_back(SString(message));
+               vemErrors.push_back(ErrorMessage(nullptr, (int) vssMessages.size()-1, linePos, columnPos));
+            }
+         const char* getMessage(const ErrorMessage& error) const
+            {  return error.szMessage ? error.szMessage
+                  : vssMessages[error.uMessageIndex].getChunk().string;
+            }
+         bool isEmpty() const { return vemErrors.empty(); }
+         int count() const { return (int) vemErrors.size(); }
+         void swap(ErrorMessages& source)
+            {  vemErrors.swap(source.vemErrors);
+               vssMessages.swap(source.vssMessages);
+               sFilename.swap(source.sFilename);
+            }
+         void removeAll()
+            {  vemErrors.clear();
+               vssMessages.clear();
+            }
+      };
+
      private:
       CommonParser* pcpParser;
       int uLocalStackHeight = 0;
-      COL::TCopyCollection<COL::TList<ErrorMessage> >* plemErrorMessages = nullptr;
+      ErrorMessages* pemErrorMessages = nullptr;
       int uCountErrors = 0;
       bool fDoesStopOnError = false;
       unsigned *puLine = nullptr, *puColumn = nullptr;
@@ -835,21 +887,29 @@ class CommonParser : public BasicParser {
             return state.shiftResult(nullObject, parseMethod, std::move(result));
          }
 
+      void setErrorMessages(ErrorMessages& errors, bool doesStopOnError=false)
+         {  pemErrorMessages = &errors; fDoesStopOnError = doesStopOnError; }
       bool doesStopAfterTooManyErrors() const
-         {  return (fDoesStopOnError || !plemErrorMessages || uCountErrors >= 20); }
+         {  return (fDoesStopOnError || !pemErrorMessages || uCountErrors >= 20); }
+      bool addErrorMessage(const char* message)
+         {  ++uCountErrors;
+            if (pemErrorMessages)
+               pemErrorMessages->add(message, puLine ? *puLine : 0, puColumn ? *puColumn : 0);
+            return !doesStopAfterTooManyErrors();
+         }
       bool addErrorMessage(const STG::SubString& message)
          {  ++uCountErrors;
-            if (plemErrorMessages)
-               plemErrorMessages->insertNewAtEnd(new ErrorMessage(message, STG::SString(), puLine ? *puLine : 0, puColumn ? *puColumn : 0));
+            if (pemErrorMessages)
+               pemErrorMessages->add(message, puLine ? *puLine : 0, puColumn ? *puColumn : 0);
             return !doesStopAfterTooManyErrors();
          }
       bool isValidRange() const
          {  return (uLocalStackHeight >= 0 && uLocalStackHeight <= 7); }
       void clearRange() { uLocalStackHeight = 0; }
       bool hasErrors() const
-         {  return plemErrorMessages && !plemErrorMessages->isEmpty(); }
-      COL::TList<ErrorMessage>& errors() const
-         {  AssumeCondition(plemErrorMessages); return *plemErrorMessages; }
+         {  return pemErrorMessages && !pemErrorMessages->isEmpty(); }
+      ErrorMessages& errors() const
+         {  AssumeCondition(pemErrorMessages); return *pemErrorMessages; }
 
       // ReadResult readChars(SubString& buffer) { AssumeCondition(pcpParser) return pcpParser->lexer().readChars(buffer); }
       bool setToNextToken(ReadResult& result)
@@ -913,9 +973,14 @@ class CommonParser : public BasicParser {
 
    ReadResult parseArgument()
       {  STG::Lexer::Base::ReadResult parseResult;
+         size_t originalSize;
          do {
+            originalSize = sState.getTotalSize();
             parseResult = sState.parse(aArguments);
-         } while (parseResult == RRContinue);
+         } while (parseResult == RRContinue
+               // a rule has ended on the token of its parent rule
+               || (parseResult == RRHasToken && !sState.isEmpty()
+                  && sState.getTotalSize() < originalSize));
          return (parseResult == RRHasToken) ? RRContinue : parseResult;
       }
    void assumeCleared()
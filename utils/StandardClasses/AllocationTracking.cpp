@@ -0,0 +1,173 @@
+/**************************************************************************/
+/*                                                                        */
+/*  Copyright (C) 2020                                                    */
+/*    CEA (Commissariat a l'Energie Atomique et aux Energies              */
+/*         Alternatives)                                                  */
+/*                                                                        */
+/*  you can redistribute it and/or modify it under the terms of the GNU   */
+/*  Lesser General Public License as published by the Free Software       */
+/*  Foundation, version 2.1.                                              */
+/*                                                                        */
+/*  It is distributed in the hope that it will be useful,                 */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/*  GNU Lesser General Public License for more details.                   */
+/*                                                                        */
+/*  See the GNU Lesser General Public License version 2.1                 */
+/*  for more details (enclosed in the file LICENSE).                      */
+/*                                                                        */
+/**************************************************************************/
+
+/////////////////////////////////
+//
+// Library   : Standard classes
+// Unit      : Basic object
+// File      : AllocationTracking.cpp
+// Description :
+//   Implementation of the attribution of the allocations to the subsystems.
+//
+
+#include "StandardClasses/AllocationTracking.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+/* Counters of one thread: a single thread writes them, the summary may read
+ * them from another thread, hence the relaxed atomics without read-modify-write.
+ */
+struct ThreadCounters {
+   std::atomic<uint64_t> allocations[AllocationTracking::SNumberOfSubsystems];
+   std::atomic<uint64_t> bytes[AllocationTracking::SNumberOfSubsystems];
+   std::atomic<uint64_t> frees;
+   std::atomic<uint64_t> freedBytes;
+
+   ThreadCounters() { clear(); }
+   void clear()
+      {  for (int index = 0; index < AllocationTracking::SNumberOfSubsystems; ++index) {
+            allocations[index].store(0, std::memory_order_relaxed);
+            bytes[index].store(0, std::memory_order_relaxed);
+         }
+         frees.store(0, std::memory_order_relaxed);
+         freedBytes.store(0, std::memory_order_relaxed);
+      }
+   static void add(std::atomic<uint64_t>& counter, uint64_t value)
+      {  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+};
+
+class Registry {
+  private:
+   std::mutex mMutex;
+   std::vector<std::unique_ptr<ThreadCounters>> vCounters;
+
+  public:
+   // the counters survive their thread, to appear in the summary
+   ThreadCounters* registerThread()
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         vCounters.emplace_back(new ThreadCounters());
+         return vCounters.back().get();
+      }
+   template <class Function> void foreach(Function function)
+      {  std::lock_guard<std::mutex> lock(mMutex);
+         for (auto& counters : vCounters)
+            function(*counters);
+      }
+};
+
+Registry& registry() {
+   static Registry* result = new Registry();
+   return *result;
+}
+
+thread_local ThreadCounters* localCounters = nullptr;
+
+// last classified source files, the same file being often reused
+struct SourceCache {
+   static const int Size = 16;
+   const char* files[Size] = {};
+   AllocationTracking::Subsystem subsystems[Size] = {};
+};
+
+thread_local SourceCache sourceCache;
+
+const char* subsystemNames[AllocationTracking::SNumberOfSubsystems] =
+   {  "MemoryState", "Expression", "JSON", "Contract", "Other" };
+
+}
+
+thread_local const char* AllocationTracking::pcNextSource = nullptr;
+thread_local AllocationTracking::Subsystem AllocationTracking::sCurrentSubsystem = AllocationTracking::SOther;
+
+AllocationTracking::Subsystem
+AllocationTracking::querySubsystem(const char* file) {
+   if (!file)
+      return sCurrentSubsystem;
+   int index = (int) ((reinterpret_cast<uintptr_t>(file) >> 3) % SourceCache::Size);
+   if (sourceCache.files[index] == file)
+      return sourceCache.subsystems[index];
+   Subsystem result = SOther;
+   if (strstr(file, "MemoryState") || strstr(file, "MemoryZone"))
+      result = SMemoryState;
+   else if (strstr(file, "Expression"))
+      result = SExpression;
+   else if (strstr(file, "JSON") || strstr(file, "JSon"))
+      result = SJSon;
+   else if (strstr(file, "Contract") || strstr(file, "contract_checker"))
+      result = SContract;
+   sourceCache.files[index] = file;
+   sourceCache.subsystems[index] = result;
+   return result;
+}
+
+void*
+AllocationTracking::allocate(size_t size) {
+   Subsystem subsystem = querySubsystem(pcNextSource);
+   pcNextSource = nullptr;
+   if (!localCounters)
+      localCounters = registry().registerThread();
+   ThreadCounters::add(localCounters->allocations[subsystem], 1);
+   ThreadCounters::add(localCounters->bytes[subsystem], size);
+   return ::operator new(size);
+}
+
+void
+AllocationTracking::free(void* pointer, size_t size) {
+   if (!pointer)
+      return;
+   if (!localCounters)
+      localCounters = registry().registerThread();
+   ThreadCounters::add(localCounters->frees, 1);
+   ThreadCounters::add(localCounters->freedBytes, size);
+   ::operator delete(pointer);
+}
+
+void
+AllocationTracking::clear() {
+   registry().foreach([](ThreadCounters& counters) { counters.clear(); });
+}
+
+void
+AllocationTracking::writeSummary(std::ostream& out) {
+   uint64_t allocations[SNumberOfSubsystems] = {}, bytes[SNumberOfSubsystems] = {};
+   uint64_t frees = 0, freedBytes = 0;
+   registry().foreach([&](ThreadCounters& counters)
+      {  for (int index = 0; index < SNumberOfSubsystems; ++index) {
+            allocations[index] += counters.allocations[index].load(std::memory_order_relaxed);
+            bytes[index] += counters.bytes[index].load(std::memory_order_relaxed);
+         }
+         frees += counters.frees.load(std::memory_order_relaxed);
+         freedBytes += counters.freedBytes.load(std::memory_order_relaxed);
+      });
+   out << "allocations by subsystem:\n";
+   for (int index = 0; index < SNumberOfSubsystems; ++index)
+      out << "  " << subsystemNames[index] << ": " << allocations[index]
+         << " allocations, " << bytes[index] << " bytes\n";
+   out << "  freed: " << frees << " objects, " << freedBytes << " bytes" << std::endl;
+}
+
@@ -0,0 +1,80 @@
+/**************************************************************************/
+/*                                                                        */
+/*  Copyright (C) 2020                                                    */
+/*    CEA (Commissariat a l'Energie Atomique et aux Energies              */
+/*         Alternatives)                                                  */
+/*                                                                        */
+/*  you can redistribute it and/or modify it under the terms of the GNU   */
+/*  Lesser General Public License as published by the Free Software       */
+/*  Foundation, version 2.1.                                              */
+/*                                                                        */
+/*  It is distributed in the hope that it will be useful,                 */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/*  GNU Lesser General Public License for more details.                   */
+/*                                                                        */
+/*  See the GNU Lesser General Public License version 2.1                 */
+/*  for more details (enclosed in the file LICENSE).                      */
+/*                                                                        */
+/**************************************************************************/
+
+/////////////////////////////////
+//
+// Library   : Standard classes
+// Unit      : Basic object
+// File      : AllocationTracking.h
+// Description :
+//   Attribution of the allocations of EnhancedObject to the subsystems,
+//   active when DefineAllocationTracking is defined.
+//
+
+#ifndef AllocationTrackingH
+#define AllocationTrackingH
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+/* Inside the regions opened by "#define DefineAllocationRegion" followed by
+ * DefineNew.h and closed by UndefineNew.h, the macro new records the source
+ * file of the next allocation; the operator new of EnhancedObject then attributes its size to
+ * the subsystem of this file. The counters are thread-local (no lock after
+ * the first allocation of a thread) and the summary adds all the threads.
+ */
+class AllocationTracking {
+  public:
+   enum Subsystem
+      {  SMemoryState, SExpression, SJSon, SContract, SOther,
+         SNumberOfSubsystems
+      };
+
+  private:
+   static thread_local const char* pcNextSource;
+   static thread_local Subsystem sCurrentSubsystem;
+
+   static Subsystem querySubsystem(const char* file);
+
+  public:
+   static void setSource(const char* file) { pcNextSource = file; }
+   static void* allocate(size_t size);
+   static void free(void* pointer, size_t size);
+   static void clear();
+   static void writeSummary(std::ostream& out);
+
+   /* subsystem of the allocations without source file, like the strings
+    * built by the JSON parser and by the readers that it calls back
+    */
+   class Scope {
+     private:
+      Subsystem sPrevious;
+
+     public:
+      explicit Scope(Subsystem subsystem) : sPrevious(sCurrentSubsystem)
+         {  sCurrentSubsystem = subsystem; }
+      Scope(const Scope&) = delete;
+      ~Scope() { sCurrentSubsystem = sPrevious; }
+   };
+};
+
+#endif // AllocationTrackingH
+
@@ -31,4 +31,9 @@
 #define new (EnhancedObject::uReadLineSource = __LINE__, (EnhancedObject::pcReadFileSource = __FILE__) == nullptr) ? nullptr : DefNew 
 #endif
 
+// only in the regions opened by DefineAllocationRegion, since std headers cannot bear this macro
+#if defined(DefineAllocationTracking) && defined(DefineAllocationRegion) && !(DefineDebugLevel > 2)
+#define new (AllocationTracking::setSource(__FILE__), false) ? nullptr : new
+#endif
+
 
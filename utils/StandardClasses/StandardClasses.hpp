@@ -37,6 +37,9 @@
 
 #include "StandardMessage.h"
 #include "StandardClasses.macro"
+#ifdef DefineAllocationTracking
+#include "StandardClasses/AllocationTracking.h"
+#endif
 
 #ifdef __GNUC__
 #define GCC_VERSION (__GNUC__ * 10000 + __GNUC_MINOR__ * 100 + __GNUC_PATCHLEVEL__)
@@ -164,6 +167,14 @@ class EnhancedObject {
 
 #endif
 
+#ifdef DefineAllocationTracking
+  public:
+   static void* operator new(size_t size) { return AllocationTracking::allocate(size); }
+   static void* operator new(size_t, void* place) { return place; }
+   static void operator delete(void* pointer, size_t size) { AllocationTracking::free(pointer, size); }
+   static void operator delete(void*, void*) {}
+#endif
+
   protected:
    virtual ComparisonResult _compare(const EnhancedObject&) const { return CREqual; }
    virtual void _assign(const EnhancedObject&) {}
@@ -31,3 +31,7 @@
 #undef new
 #endif
 
+#if defined(DefineAllocationTracking) && !(DefineDebugLevel > 2)
+#undef new
+#endif
+